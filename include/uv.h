@@ -181,6 +181,7 @@ struct uv__queue {
   XX(TTY, tty)                                                                \
   XX(UDP, udp)                                                                \
   XX(SIGNAL, signal)                                                          \
+  XX(CHANNEL, channel)                                                        \
 
 #define UV_REQ_TYPE_MAP(XX)                                                   \
   XX(REQ, req)                                                                \
@@ -193,6 +194,7 @@ struct uv__queue {
   XX(GETADDRINFO, getaddrinfo)                                                \
   XX(GETNAMEINFO, getnameinfo)                                                \
   XX(RANDOM, random)                                                          \
+  XX(UDP_SEND_BATCH, udp_send_batch)                                          \
 
 typedef enum {
 #define XX(code, _) UV_ ## code = UV__ ## code,
@@ -239,6 +241,7 @@ typedef struct uv_process_s uv_process_t;
 typedef struct uv_fs_event_s uv_fs_event_t;
 typedef struct uv_fs_poll_s uv_fs_poll_t;
 typedef struct uv_signal_s uv_signal_t;
+typedef struct uv_channel_s uv_channel_t;
 
 /* Request types. */
 typedef struct uv_req_s uv_req_t;
@@ -248,6 +251,7 @@ typedef struct uv_shutdown_s uv_shutdown_t;
 typedef struct uv_write_s uv_write_t;
 typedef struct uv_connect_s uv_connect_t;
 typedef struct uv_udp_send_s uv_udp_send_t;
+typedef struct uv_udp_send_batch_s uv_udp_send_batch_t;
 typedef struct uv_fs_s uv_fs_t;
 typedef struct uv_work_s uv_work_t;
 typedef struct uv_random_s uv_random_t;
@@ -263,10 +267,22 @@ typedef struct uv_utsname_s uv_utsname_t;
 typedef struct uv_statfs_s uv_statfs_t;
 
 typedef struct uv_metrics_s uv_metrics_t;
+typedef struct uv_threadpool_s uv_threadpool_t;
+typedef struct uv_threadpool_stats_s uv_threadpool_stats_t;
+typedef struct uv_work_options_s uv_work_options_t;
 
 typedef enum {
   UV_LOOP_BLOCK_SIGNAL = 0,
-  UV_METRICS_IDLE_TIME
+  UV_METRICS_IDLE_TIME,
+  UV_LOOP_USE_THREADPOOL,
+  UV_LOOP_FS_PRIORITY,
+  UV_LOOP_TIMER_WHEEL,
+  UV_LOOP_TIMER_DHEAP,
+  UV_LOOP_IO_URING_STREAMS,
+  UV_LOOP_IO_URING_BUFFERS,
+  UV_LOOP_BUFFER_POOL,
+  UV_LOOP_EDGE_TRIGGERED,
+  UV_LOOP_READ_BUDGET
 } uv_loop_option;
 
 typedef enum {
@@ -330,6 +346,17 @@ typedef void (*uv_alloc_cb)(uv_handle_t* handle,
 typedef void (*uv_read_cb)(uv_stream_t* stream,
                            ssize_t nread,
                            const uv_buf_t* buf);
+/* Buffers that a uv_alloc_bufs_cb can hand out per read. */
+#define UV_READ_BUFS_MAX 16
+
+typedef void (*uv_alloc_bufs_cb)(uv_handle_t* handle,
+                                 size_t suggested_size,
+                                 uv_buf_t bufs[],
+                                 unsigned int* nbufs);
+typedef void (*uv_read_bufs_cb)(uv_stream_t* stream,
+                                ssize_t nread,
+                                const uv_buf_t bufs[],
+                                unsigned int nbufs);
 typedef void (*uv_write_cb)(uv_write_t* req, int status);
 typedef void (*uv_connect_cb)(uv_connect_t* req, int status);
 typedef void (*uv_shutdown_cb)(uv_shutdown_t* req, int status);
@@ -338,6 +365,9 @@ typedef void (*uv_close_cb)(uv_handle_t* handle);
 typedef void (*uv_poll_cb)(uv_poll_t* handle, int status, int events);
 typedef void (*uv_timer_cb)(uv_timer_t* handle);
 typedef void (*uv_async_cb)(uv_async_t* handle);
+typedef void (*uv_channel_cb)(uv_channel_t* channel,
+                              void** msgs,
+                              unsigned int nmsgs);
 typedef void (*uv_prepare_cb)(uv_prepare_t* handle);
 typedef void (*uv_check_cb)(uv_check_t* handle);
 typedef void (*uv_idle_cb)(uv_idle_t* handle);
@@ -549,7 +579,12 @@ UV_EXTERN int uv_accept(uv_stream_t* server, uv_stream_t* client);
 UV_EXTERN int uv_read_start(uv_stream_t*,
                             uv_alloc_cb alloc_cb,
                             uv_read_cb read_cb);
+UV_EXTERN int uv_read_start_pooled(uv_stream_t*, uv_read_cb read_cb);
+UV_EXTERN int uv_read_start_bufs(uv_stream_t*,
+                                 uv_alloc_bufs_cb alloc_cb,
+                                 uv_read_bufs_cb read_cb);
 UV_EXTERN int uv_read_stop(uv_stream_t*);
+UV_EXTERN void uv_buf_release(uv_loop_t*, const uv_buf_t* buf);
 
 UV_EXTERN int uv_write(uv_write_t* req,
                        uv_stream_t* handle,
@@ -584,6 +619,7 @@ UV_EXTERN int uv_is_readable(const uv_stream_t* handle);
 UV_EXTERN int uv_is_writable(const uv_stream_t* handle);
 
 UV_EXTERN int uv_stream_set_blocking(uv_stream_t* handle, int blocking);
+UV_EXTERN int uv_stream_set_cork(uv_stream_t* handle, int enable);
 
 UV_EXTERN int uv_is_closing(const uv_handle_t* handle);
 
@@ -603,6 +639,7 @@ UV_EXTERN int uv_tcp_init(uv_loop_t*, uv_tcp_t* handle);
 UV_EXTERN int uv_tcp_init_ex(uv_loop_t*, uv_tcp_t* handle, unsigned int flags);
 UV_EXTERN int uv_tcp_open(uv_tcp_t* handle, uv_os_sock_t sock);
 UV_EXTERN int uv_tcp_nodelay(uv_tcp_t* handle, int enable);
+UV_EXTERN int uv_tcp_zerocopy(uv_tcp_t* handle, size_t threshold);
 UV_EXTERN int uv_tcp_keepalive(uv_tcp_t* handle,
                                int enable,
                                unsigned int delay);
@@ -610,12 +647,36 @@ UV_EXTERN int uv_tcp_simultaneous_accepts(uv_tcp_t* handle, int enable);
 
 enum uv_tcp_flags {
   /* Used with uv_tcp_bind, when an IPv6 address is used. */
-  UV_TCP_IPV6ONLY = 1
+  UV_TCP_IPV6ONLY = 1,
+  /*
+   * Used with uv_tcp_bind, sets SO_REUSEPORT so that the sockets of several
+   * handles can listen on the same address and port. The kernel spreads the
+   * incoming connections over them. Linux only.
+   */
+  UV_TCP_REUSEPORT = 2,
+  /*
+   * Used with uv_tcp_listen_reuseport, hands a connection that was received
+   * on CPU n to handles[n % count]. That is the listener of the CPU that
+   * received it only when the thread running loops[i] is pinned to CPU i.
+   */
+  UV_TCP_REUSEPORT_CPU = 4
 };
 
 UV_EXTERN int uv_tcp_bind(uv_tcp_t* handle,
                           const struct sockaddr* addr,
                           unsigned int flags);
+/*
+ * Initializes, binds and starts listening on handles[i] with loops[i], and
+ * on error closes them again, all from the calling thread. Only call it
+ * before any of the loops runs.
+ */
+UV_EXTERN int uv_tcp_listen_reuseport(uv_loop_t* loops[],
+                                      uv_tcp_t handles[],
+                                      unsigned int count,
+                                      const struct sockaddr* addr,
+                                      unsigned int flags,
+                                      int backlog,
+                                      uv_connection_cb cb);
 UV_EXTERN int uv_tcp_getsockname(const uv_tcp_t* handle,
                                  struct sockaddr* name,
                                  int* namelen);
@@ -677,19 +738,73 @@ enum uv_udp_flags {
    * This flag is no-op on platforms other than Linux.
    */
   UV_UDP_LINUX_RECVERR = 32,
+  /*
+   * Indicates if SO_REUSEPORT will be set when binding the handle, so that
+   * the sockets of several handles can bind the same address and port and
+   * the kernel spreads the incoming datagrams over them. Unlike
+   * UV_UDP_REUSEADDR, this flag is only supported on Linux.
+   */
+  UV_UDP_REUSEPORT = 64,
   /*
    * Indicates that recvmmsg should be used, if available.
    */
-  UV_UDP_RECVMMSG = 256
+  UV_UDP_RECVMMSG = 256,
+  /*
+   * Indicates that the kernel coalesced datagrams of the same size, but for
+   * the last one, into the message. Used in uv_udp_recv_cb, see
+   * uv_udp_set_gro(). UV_UDP_GRO_SEGMENT_SIZE(flags) is their size.
+   */
+  UV_UDP_GRO = 512,
+  /*
+   * Indicates that addr points to a uv_udp_recv_meta_t. Used in
+   * uv_udp_recv_cb, see uv_udp_set_recv_meta().
+   */
+  UV_UDP_RECV_META = 1024
 };
 
+#define UV_UDP_GRO_SEGMENT_SIZE(flags) ((unsigned int) (flags) >> 16)
+
+/* Most datagrams a single recvmmsg() receives, see uv_udp_set_recvmmsg(). */
+#define UV_UDP_RECVMMSG_MAX 64
+
+enum uv_udp_meta_flags {
+  /* Kernel receive time, SO_TIMESTAMPNS. */
+  UV_UDP_META_TIMESTAMP = 1,
+  /* Destination address and interface, IP_PKTINFO / IPV6_RECVPKTINFO. */
+  UV_UDP_META_PKTINFO = 2,
+  /* TOS byte or traffic class, ECN bits included, IP_RECVTOS / IPV6_RECVTCLASS. */
+  UV_UDP_META_TOS = 4
+};
+
+typedef struct uv_udp_recv_meta_s {
+  /* Sender, recv_cb's addr points here. Must be the first member. */
+  struct sockaddr_storage addr;
+  /* UV_UDP_META_* flags of the members below that the kernel filled in. */
+  unsigned int flags;
+  uv_timespec64_t timestamp;
+  struct sockaddr_storage local;
+  unsigned int ifindex;
+  int tos;
+} uv_udp_recv_meta_t;
+
 typedef void (*uv_udp_send_cb)(uv_udp_send_t* req, int status);
+typedef void (*uv_udp_send_batch_cb)(uv_udp_send_batch_t* req, int status);
 typedef void (*uv_udp_recv_cb)(uv_udp_t* handle,
                                ssize_t nread,
                                const uv_buf_t* buf,
                                const struct sockaddr* addr,
                                unsigned flags);
 
+/* Counters of a uv_udp_t, see uv_udp_get_stats(). */
+typedef struct uv_udp_stats_s {
+  uint64_t sent_bytes;
+  uint64_t sent_datagrams;
+  /* Datagrams that failed to send or were canceled. */
+  uint64_t dropped_datagrams;
+  /* Times pacing held the send queue back. */
+  uint64_t paced;
+} uv_udp_stats_t;
+
 /* uv_udp_t is a subclass of uv_handle_t. */
 struct uv_udp_s {
   UV_HANDLE_FIELDS
@@ -714,6 +829,25 @@ struct uv_udp_send_s {
   UV_UDP_SEND_PRIVATE_FIELDS
 };
 
+/* One datagram of a uv_udp_send_batch_t. */
+typedef struct uv_udp_msg_s {
+  const struct sockaddr* addr;
+  const uv_buf_t* bufs;
+  unsigned int nbufs;
+  /* Number of bytes sent or error code, valid in the uv_udp_send_batch_cb. */
+  int status;
+} uv_udp_msg_t;
+
+/* uv_udp_send_batch_t is a subclass of uv_req_t. */
+struct uv_udp_send_batch_s {
+  UV_REQ_FIELDS
+  uv_udp_t* handle;
+  uv_udp_msg_t* msgs;
+  unsigned int nmsgs;
+  uv_udp_send_batch_cb cb;
+  UV_UDP_SEND_BATCH_PRIVATE_FIELDS
+};
+
 UV_EXTERN int uv_udp_init(uv_loop_t*, uv_udp_t* handle);
 UV_EXTERN int uv_udp_init_ex(uv_loop_t*, uv_udp_t* handle, unsigned int flags);
 UV_EXTERN int uv_udp_open(uv_udp_t* handle, uv_os_sock_t sock);
@@ -743,6 +877,14 @@ UV_EXTERN int uv_udp_set_multicast_interface(uv_udp_t* handle,
                                              const char* interface_addr);
 UV_EXTERN int uv_udp_set_broadcast(uv_udp_t* handle, int on);
 UV_EXTERN int uv_udp_set_ttl(uv_udp_t* handle, int ttl);
+UV_EXTERN int uv_udp_set_gso(uv_udp_t* handle, unsigned int segment_size);
+UV_EXTERN int uv_udp_set_gro(uv_udp_t* handle, int on);
+UV_EXTERN int uv_udp_set_recvmmsg(uv_udp_t* handle, unsigned int nmsgs);
+UV_EXTERN int uv_udp_set_recv_meta(uv_udp_t* handle, unsigned int flags);
+UV_EXTERN int uv_udp_set_pacing(uv_udp_t* handle,
+                                uint64_t rate,
+                                size_t burst);
+UV_EXTERN int uv_udp_get_stats(const uv_udp_t* handle, uv_udp_stats_t* stats);
 UV_EXTERN int uv_udp_send(uv_udp_send_t* req,
                           uv_udp_t* handle,
                           const uv_buf_t bufs[],
@@ -753,9 +895,16 @@ UV_EXTERN int uv_udp_try_send(uv_udp_t* handle,
                               const uv_buf_t bufs[],
                               unsigned int nbufs,
                               const struct sockaddr* addr);
+UV_EXTERN int uv_udp_send_batch(uv_udp_send_batch_t* req,
+                                uv_udp_t* handle,
+                                uv_udp_msg_t msgs[],
+                                unsigned int nmsgs,
+                                uv_udp_send_batch_cb cb);
 UV_EXTERN int uv_udp_recv_start(uv_udp_t* handle,
                                 uv_alloc_cb alloc_cb,
                                 uv_udp_recv_cb recv_cb);
+UV_EXTERN int uv_udp_recv_start_pooled(uv_udp_t* handle,
+                                       uv_udp_recv_cb recv_cb);
 UV_EXTERN int uv_udp_using_recvmmsg(const uv_udp_t* handle);
 UV_EXTERN int uv_udp_recv_stop(uv_udp_t* handle);
 UV_EXTERN size_t uv_udp_get_send_queue_size(const uv_udp_t* handle);
@@ -922,6 +1071,23 @@ UV_EXTERN int uv_async_init(uv_loop_t*,
 UV_EXTERN int uv_async_send(uv_async_t* async);
 
 
+/*
+ * Bounded multi-producer queue that hands messages to the loop thread.
+ */
+struct uv_channel_s {
+  UV_HANDLE_FIELDS
+  /* Private, don't touch. */
+  void* channel_ctx;
+};
+
+UV_EXTERN int uv_channel_init(uv_loop_t* loop,
+                              uv_channel_t* channel,
+                              unsigned int capacity,
+                              uv_channel_cb channel_cb);
+UV_EXTERN int uv_channel_try_send(uv_channel_t* channel, void* msg);
+UV_EXTERN unsigned int uv_channel_capacity(const uv_channel_t* channel);
+
+
 /*
  * uv_timer_t is a subclass of uv_handle_t.
  *
@@ -937,6 +1103,11 @@ UV_EXTERN int uv_timer_start(uv_timer_t* handle,
                              uv_timer_cb cb,
                              uint64_t timeout,
                              uint64_t repeat);
+UV_EXTERN int uv_timer_start_ex(uv_timer_t* handle,
+                                uv_timer_cb cb,
+                                uint64_t timeout,
+                                uint64_t repeat,
+                                uint64_t slack);
 UV_EXTERN int uv_timer_stop(uv_timer_t* handle);
 UV_EXTERN int uv_timer_again(uv_timer_t* handle);
 UV_EXTERN void uv_timer_set_repeat(uv_timer_t* handle, uint64_t repeat);
@@ -1149,6 +1320,64 @@ UV_EXTERN int uv_queue_work(uv_loop_t* loop,
                             uv_work_cb work_cb,
                             uv_after_work_cb after_work_cb);
 
+typedef enum {
+  UV_WORK_PRIORITY_NORMAL = 0,
+  UV_WORK_PRIORITY_HIGH,
+  UV_WORK_PRIORITY_BACKGROUND
+} uv_work_priority;
+
+struct uv_work_options_s {
+  uv_threadpool_t* pool;  /* NULL means the loop's pool for UV_WORK. */
+  uv_work_priority priority;
+};
+
+UV_EXTERN int uv_queue_work_ex(uv_loop_t* loop,
+                               uv_work_t* req,
+                               uv_work_cb work_cb,
+                               uv_after_work_cb after_work_cb,
+                               const uv_work_options_t* options);
+
+enum uv_threadpool_flags {
+  /* Give every thread its own queue and let idle threads steal work. */
+  UV_THREADPOOL_WORK_STEALING = 1
+};
+
+typedef enum {
+  UV_WORK_KIND_CPU = 0,
+  UV_WORK_KIND_FAST_IO,
+  UV_WORK_KIND_SLOW_IO,
+  UV_WORK_KIND_MAX
+} uv_work_kind;
+
+/* Bucket 0 counts durations under 1 us, bucket n counts durations from
+ * 2^(n-1) up to 2^n us. The last bucket counts everything longer as well.
+ */
+#define UV_THREADPOOL_HISTOGRAM_BUCKETS 32
+
+struct uv_threadpool_stats_s {
+  unsigned int size;
+  unsigned int idle_threads;
+  unsigned int busy_threads;
+  uint64_t queued;
+  uint64_t slow_io_queued;
+  uint64_t submitted;
+  uint64_t completed;
+  uint64_t cancelled;
+  uint64_t wait_time[UV_WORK_KIND_MAX][UV_THREADPOOL_HISTOGRAM_BUCKETS];
+  uint64_t run_time[UV_WORK_KIND_MAX][UV_THREADPOOL_HISTOGRAM_BUCKETS];
+};
+
+UV_EXTERN int uv_threadpool_new(uv_threadpool_t** pool,
+                                const char* name,
+                                unsigned int size,
+                                unsigned int flags);
+UV_EXTERN int uv_threadpool_delete(uv_threadpool_t* pool);
+UV_EXTERN uv_threadpool_t* uv_threadpool_get(const char* name);
+UV_EXTERN const char* uv_threadpool_get_name(const uv_threadpool_t* pool);
+UV_EXTERN int uv_threadpool_resize(uv_threadpool_t* pool, unsigned int size);
+UV_EXTERN int uv_threadpool_stats(uv_threadpool_t* pool,
+                                  uv_threadpool_stats_t* stats);
+
 UV_EXTERN int uv_cancel(uv_req_t* req);
 
 
@@ -1330,8 +1559,10 @@ struct uv_metrics_s {
   uint64_t loop_count;
   uint64_t events;
   uint64_t events_waiting;
+  uint64_t buf_pool_hits;
+  uint64_t buf_pool_misses;
   /* private */
-  uint64_t* reserved[13];
+  uint64_t* reserved[11];
 };
 
 UV_EXTERN int uv_metrics_info(uv_loop_t* loop, uv_metrics_t* metrics);
@@ -31,4 +31,15 @@
   struct uv__queue watchers;                                                  \
   int wd;                                                                     \
 
+#define UV_STREAM_PRIVATE_PLATFORM_FIELDS                                     \
+  char* iou_read_buf;                                                         \
+  unsigned int iou_read_off;                                                  \
+  unsigned int iou_read_len;                                                  \
+  unsigned int iou_flags;                                                     \
+  struct uv__queue iou_bufs_queue;                                            \
+  struct uv__queue zc_queue;                                                  \
+  size_t zc_threshold;                                                        \
+  unsigned int zc_sent;                                                       \
+  unsigned int zc_done;                                                       \
+
 #endif /* UV_LINUX_H */
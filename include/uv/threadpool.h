@@ -31,7 +31,10 @@ struct uv__work {
   void (*work)(struct uv__work *w);
   void (*done)(struct uv__work *w, int status);
   struct uv_loop_s* loop;
+  struct uv_threadpool_s* pool;
   struct uv__queue wq;
+  uint64_t queued;
+  int kind;
 };
 
 #endif /* UV_THREADPOOL_H_ */
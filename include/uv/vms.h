@@ -222,6 +222,12 @@ typedef struct {
   uv_udp_send_cb send_cb;                                                     \
   uv_buf_t bufsml[4];                                                         \
 
+#define UV_UDP_SEND_BATCH_PRIVATE_FIELDS                                      \
+  struct uv__queue queue;                                                     \
+  unsigned int nsent;                                                         \
+  int status;                                                                 \
+  unsigned int write_seq;                                                     \
+
 #define UV_HANDLE_PRIVATE_FIELDS                                              \
   uv_handle_t* next_closing;                                                  \
   unsigned int flags;                                                         \
@@ -236,6 +242,12 @@ typedef struct {
   int delayed_error;                                                          \
   int accepted_fd;                                                            \
   void* queued_fds;                                                           \
+  uv_alloc_bufs_cb alloc_bufs_cb;                                             \
+  uv_read_bufs_cb read_bufs_cb;                                               \
+  uv_buf_t* cork_bufs;                                                        \
+  unsigned int read_budget_tick;                                              \
+  size_t read_budget_bytes;                                                   \
+  uint64_t read_budget_time;                                                  \
   UV_STREAM_PRIVATE_PLATFORM_FIELDS                                           \
 
 #define UV_TCP_PRIVATE_FIELDS /* empty */
@@ -246,6 +258,15 @@ typedef struct {
   uv__io_t io_watcher;                                                        \
   struct uv__queue write_queue;                                               \
   struct uv__queue write_completed_queue;                                     \
+  struct uv__queue batch_queue;                                               \
+  unsigned int writes_queued;                                                 \
+  unsigned int writes_sent;                                                   \
+  unsigned int writes_reported;                                               \
+  unsigned int gso_size;                                                      \
+  unsigned int recvmmsg_nmsgs;                                                \
+  unsigned int recv_meta;                                                     \
+  void* pacing;                                                               \
+  uv_udp_stats_t stats;                                                       \
 
 #define UV_PIPE_PRIVATE_FIELDS                                                \
   const char* pipe_fname; /* NULL or strdup'ed */
@@ -275,7 +296,9 @@ typedef struct {
   void* heap_node[3];                                                         \
   uint64_t timeout;                                                           \
   uint64_t repeat;                                                            \
-  uint64_t start_id;
+  uint64_t start_id;                                                          \
+  uint64_t slack;                                                             \
+  void* deadline_node[3];
 
 #define UV_GETADDRINFO_PRIVATE_FIELDS                                         \
   struct uv__work work_req;                                                   \
@@ -404,6 +404,9 @@ typedef struct {
 #define UV_UDP_SEND_PRIVATE_FIELDS                                            \
   /* empty */
 
+#define UV_UDP_SEND_BATCH_PRIVATE_FIELDS                                      \
+  /* empty */
+
 #define UV_PRIVATE_REQ_TYPES                                                  \
   typedef struct uv_pipe_accept_s {                                           \
     UV_REQ_FIELDS                                                             \
@@ -555,7 +558,9 @@ typedef struct {
   uint64_t timeout;                                                           \
   uint64_t repeat;                                                            \
   uint64_t start_id;                                                          \
-  uv_timer_cb timer_cb;
+  uv_timer_cb timer_cb;                                                       \
+  uint64_t slack;                                                             \
+  void* deadline_node[3];
 
 #define UV_ASYNC_PRIVATE_FIELDS                                               \
   struct uv_req_s async_req;                                                  \
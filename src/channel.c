@@ -0,0 +1,237 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "uv-common.h"
+
+#ifdef _WIN32
+#include "win/internal.h"
+#include "win/handle-inl.h"
+#define uv__make_close_pending(h) uv__want_endgame((h)->loop, (h))
+#else
+#include "unix/internal.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+
+/* Largest capacity uv_channel_init() accepts. Keeps the slot sequence
+ * numbers well clear of wrapping into each other.
+ */
+#define UV__CHANNEL_MAX_CAPACITY (1u << 24)
+
+/* A bounded multi-producer queue in the style of Dmitry Vyukov's MPMC
+ * queue. Every slot carries a sequence number that tells producers and the
+ * consumer whose turn it is: a producer may fill slot `pos & mask` when its
+ * sequence equals `pos`, the consumer may empty it once it equals `pos + 1`.
+ * Producers claim positions with a CAS on `tail`; the loop thread is the
+ * only consumer and owns `head`.
+ */
+struct channel_slot {
+  int seq;
+  void* msg;
+};
+
+struct channel_ctx {
+  uv_channel_t* parent_handle;
+  uv_channel_cb channel_cb;
+  uv_async_t async_handle;
+  unsigned int mask;
+  unsigned int head;  /* Loop thread only. */
+  void** batch;       /* Scratch space handed to channel_cb. */
+  /* Keep the producers' counter off the consumer's cache line. */
+  char pad[64];
+  int tail;
+  int busy;  /* Number of uv_channel_try_send() calls in progress. */
+  char pad2[64 - 2 * sizeof(int)];
+  struct channel_slot slots[1];  /* Variable length. */
+};
+
+static void async_cb(uv_async_t* async);
+static void async_close_cb(uv_handle_t* handle);
+
+
+int uv_channel_init(uv_loop_t* loop,
+                    uv_channel_t* channel,
+                    unsigned int capacity,
+                    uv_channel_cb channel_cb) {
+  struct channel_ctx* ctx;
+  unsigned int size;
+  unsigned int i;
+  int err;
+
+  if (channel_cb == NULL || capacity == 0)
+    return UV_EINVAL;
+
+  if (capacity > UV__CHANNEL_MAX_CAPACITY)
+    return UV_EINVAL;
+
+  /* Round up to a power of two so positions map to slots with a mask. */
+  for (size = 1; size < capacity; size <<= 1);
+
+  ctx = (struct channel_ctx*) uv__malloc(sizeof(*ctx) +
+                                         (size - 1) * sizeof(ctx->slots[0]) +
+                                         size * sizeof(ctx->batch[0]));
+  if (ctx == NULL)
+    return UV_ENOMEM;
+
+  ctx->parent_handle = channel;
+  ctx->channel_cb = channel_cb;
+  ctx->mask = size - 1;
+  ctx->head = 0;
+  ctx->tail = 0;
+  ctx->busy = 0;
+  ctx->batch = (void**) &ctx->slots[size];
+
+  for (i = 0; i < size; i++) {
+    ctx->slots[i].seq = (int) i;
+    ctx->slots[i].msg = NULL;
+  }
+
+  err = uv_async_init(loop, &ctx->async_handle, async_cb);
+  if (err < 0) {
+    uv__free(ctx);
+    return err;
+  }
+
+  ctx->async_handle.flags |= UV_HANDLE_INTERNAL;
+  uv__handle_unref(&ctx->async_handle);
+
+  uv__handle_init(loop, (uv_handle_t*) channel, UV_CHANNEL);
+  channel->channel_ctx = ctx;
+  uv__handle_start(channel);
+
+  return 0;
+}
+
+
+int uv_channel_try_send(uv_channel_t* channel, void* msg) {
+  struct channel_ctx* ctx;
+  struct channel_slot* slot;
+  unsigned int pos;
+  int dif;
+
+  ctx = (struct channel_ctx*) channel->channel_ctx;
+  uv__fetch_add_int(&ctx->busy, 1);
+  pos = (unsigned int) uv__load_int(&ctx->tail);
+
+  for (;;) {
+    slot = &ctx->slots[pos & ctx->mask];
+    dif = (int) ((unsigned int) uv__load_int(&slot->seq) - pos);
+
+    if (dif == 0) {
+      if (uv__cas_int(&ctx->tail, (int) pos, (int) (pos + 1)))
+        break;
+    } else if (dif < 0) {
+      /* The consumer hasn't emptied this slot yet: the channel is full. */
+      uv__fetch_add_int(&ctx->busy, -1);
+      return UV_EAGAIN;
+    }
+
+    /* Another producer got there first. */
+    pos = (unsigned int) uv__load_int(&ctx->tail);
+  }
+
+  slot->msg = msg;
+  uv__store_int(&slot->seq, (int) (pos + 1));
+  uv_async_send(&ctx->async_handle);
+  uv__fetch_add_int(&ctx->busy, -1);
+
+  return 0;
+}
+
+
+unsigned int uv_channel_capacity(const uv_channel_t* channel) {
+  const struct channel_ctx* ctx;
+
+  ctx = (const struct channel_ctx*) channel->channel_ctx;
+  return ctx->mask + 1;
+}
+
+
+void uv__channel_close(uv_channel_t* channel) {
+  struct channel_ctx* ctx;
+
+  ctx = (struct channel_ctx*) channel->channel_ctx;
+
+  /* The loop thread may have received the last message while its producer
+   * is still inside uv_channel_try_send(). Wait for it to get out before
+   * the context is freed.
+   */
+  while (uv__load_int(&ctx->busy) != 0)
+    uv_sleep(0);
+
+  uv__handle_stop(channel);
+  uv_close((uv_handle_t*) &ctx->async_handle, async_close_cb);
+}
+
+
+static void async_cb(uv_async_t* async) {
+  struct channel_ctx* ctx;
+  struct channel_slot* slot;
+  unsigned int nmsgs;
+  unsigned int pos;
+
+  ctx = container_of(async, struct channel_ctx, async_handle);
+  if (uv__is_closing(ctx->parent_handle))
+    return;
+
+  /* Drain everything that has been published. A slot that has been claimed
+   * but not yet filled ends the batch; its producer signals the async handle
+   * again once it's done.
+   */
+  for (nmsgs = 0; nmsgs <= ctx->mask; nmsgs++) {
+    pos = ctx->head;
+    slot = &ctx->slots[pos & ctx->mask];
+
+    if ((unsigned int) uv__load_int(&slot->seq) != pos + 1)
+      break;
+
+    ctx->batch[nmsgs] = slot->msg;
+    uv__store_int(&slot->seq, (int) (pos + ctx->mask + 1));
+    ctx->head = pos + 1;
+  }
+
+  if (nmsgs > 0)
+    ctx->channel_cb(ctx->parent_handle, ctx->batch, nmsgs);
+}
+
+
+static void async_close_cb(uv_handle_t* handle) {
+  struct channel_ctx* ctx;
+  uv_channel_t* channel;
+
+  ctx = container_of(handle, struct channel_ctx, async_handle);
+  channel = ctx->parent_handle;
+  uv__free(ctx);
+  uv__make_close_pending((uv_handle_t*) channel);
+}
+
+
+#if defined(_WIN32)
+
+void uv__channel_endgame(uv_loop_t* loop, uv_channel_t* handle) {
+  assert(handle->flags & UV_HANDLE_CLOSING);
+  assert(!(handle->flags & UV_HANDLE_CLOSED));
+  uv__handle_close(handle);
+}
+
+#endif /* _WIN32 */
@@ -26,24 +26,120 @@
 #endif
 
 #include <stdlib.h>
+#include <string.h>
 
 #define MAX_THREADPOOL_SIZE 1024
+#define PRIORITY_CLASSES 3
+
+/* A work queue. By default all threads of a pool share a single queue.
+ * Pools created with UV_THREADPOOL_WORK_STEALING (the default pool when
+ * the UV_THREADPOOL_STEALING environment variable is set) give every
+ * thread a queue of its own instead. Each event loop then posts to a home
+ * queue that is assigned round-robin on first use, and threads that run
+ * out of work steal from the other queues before going to sleep.
+ *
+ * Work only ever sits in its home queue, so uv_cancel() knows which lock
+ * to take. To avoid deadlocks, a thread never holds two queue locks at the
+ * same time; forward_shard() is the exception, it takes two in address
+ * order.
+ *
+ * Shrinking the pool retires threads from queues that have more than one
+ * first. When every queue is down to a single thread, the last thread of a
+ * queue retires and the queue forwards its work, queued and future, to a
+ * queue that still has threads. That one is the home queue from then on.
+ * It keeps the work of every loop served under load, instead of waiting for
+ * a thread to go idle and steal it. Forwarding is permanent, threads that
+ * are started later go to the queues that still have threads of their own.
+ *
+ * Finished work is handed back to its event loop by pushing it onto a
+ * lock-free stack that uv__work_done() takes over in one go. The push
+ * happens with the home queue's lock held, which is what uv_cancel() and
+ * uv__work_loop_close() synchronize with. The loop is only woken up when
+ * the stack goes from empty to non-empty.
+ */
+struct wq_class {
+  struct uv__queue wq;
+  struct uv__queue run_slow_work_message;
+  struct uv__queue slow_io_pending_wq;
+  unsigned int turns;  /* Left in the current round. */
+};
+
+struct wq_shard {
+  uv_mutex_t mutex;
+  uv_cond_t cond;
+  unsigned int idle_threads;
+  unsigned int wakeups;  /* Idle threads that have been signalled. */
+  unsigned int nretire;  /* Number of threads that should exit. */
+  int exiting;
+  struct wq_shard* forward;  /* Where the work goes once the threads left. */
+  /* Only used with `pool->lock` held. */
+  unsigned int nthreads;  /* Serving this queue, minus those retiring. */
+  unsigned int nhomes;  /* Queues forwarding here, this one included. */
+  struct uv__queue exit_message;  /* Returned by dequeue() when exiting. */
+  struct wq_class classes[PRIORITY_CLASSES];  /* By uv_work_priority. */
+  /* Statistics, see uv_threadpool_stats(). They are updated together with
+   * the queue, so keeping them costs no extra locking.
+   */
+  uint64_t submitted;
+  uint64_t started;
+  uint64_t completed;
+  uint64_t cancelled;
+  unsigned int slow_io_queued;
+  uint64_t wait_time[UV_WORK_KIND_MAX][UV_THREADPOOL_HISTOGRAM_BUCKETS];
+  uint64_t run_time[UV_WORK_KIND_MAX][UV_THREADPOOL_HISTOGRAM_BUCKETS];
+};
+
+struct wq_thread {
+  struct uv__queue queue;  /* In uv_threadpool_t.threads. */
+  uv_thread_t thread;
+  uv_threadpool_t* pool;
+  struct wq_shard* shard;
+  uv_sem_t* started;
+  int exited;
+  uint64_t wait_time;  /* Of the work that was run last. */
+  uint64_t run_time;
+};
+
+struct uv_threadpool_s {
+  struct uv__queue queue;  /* In the list of all pools. */
+  char* name;
+  unsigned int flags;
+  uv_mutex_t lock;  /* Serializes resizing. */
+  int refs;  /* Unfinished work and configured loops, -1 once deleted. */
+  struct uv__queue threads;
+  int nthreads;
+  int idle_threads;  /* Sum of all shards' idle_threads. */
+  int slow_io_work_running;
+  int next_home_shard;
+  unsigned int nshards;
+  struct wq_shard* shards;
+};
 
 static uv_once_t once = UV_ONCE_INIT;
-static uv_cond_t cond;
-static uv_mutex_t mutex;
-static unsigned int idle_threads;
-static unsigned int slow_io_work_running;
-static unsigned int nthreads;
-static uv_thread_t* threads;
-static uv_thread_t default_threads[4];
-static struct uv__queue exit_message;
-static struct uv__queue wq;
-static struct uv__queue run_slow_work_message;
-static struct uv__queue slow_io_pending_wq;
-
-static unsigned int slow_work_thread_threshold(void) {
-  return (nthreads + 1) / 2;
+static uv_mutex_t pools_mutex;
+static struct uv__queue pools;
+static uv_threadpool_t default_pool;
+static char default_pool_name[] = "default";
+
+/* Every queue serves its priority classes in rounds. In each round a class
+ * gets up to this many turns, highest priority first, for as long as it has
+ * work. Every class with work gets at least one turn per round, so
+ * background work is delayed but never starved.
+ */
+static const unsigned int class_turns[PRIORITY_CLASSES] = {
+  4,   /* UV_WORK_PRIORITY_NORMAL */
+  16,  /* UV_WORK_PRIORITY_HIGH */
+  1    /* UV_WORK_PRIORITY_BACKGROUND */
+};
+
+static const uv_work_priority class_order[PRIORITY_CLASSES] = {
+  UV_WORK_PRIORITY_HIGH,
+  UV_WORK_PRIORITY_NORMAL,
+  UV_WORK_PRIORITY_BACKGROUND
+};
+
+static unsigned int slow_work_thread_threshold(uv_threadpool_t* pool) {
+  return (uv__load_int(&pool->nthreads) + 1) / 2;
 }
 
 static void uv__cancelled(struct uv__work* w) {
@@ -51,193 +147,801 @@ static void uv__cancelled(struct uv__work* w) {
 }
 
 
-/* To avoid deadlock with uv_cancel() it's crucial that the worker
- * never holds the global mutex and the loop-local mutex at the same time.
+static int slow_io_acquire(uv_threadpool_t* pool) {
+  int n;
+
+  do {
+    n = uv__load_int(&pool->slow_io_work_running);
+    if ((unsigned int) n >= slow_work_thread_threshold(pool))
+      return 0;
+  } while (!uv__cas_int(&pool->slow_io_work_running, n, n + 1));
+
+  return 1;
+}
+
+
+/* Wakes up an idle thread serving `s` that nobody has woken up yet.
+ * Returns 0 if there is none. Must be called with `s->mutex` held.
  */
-static void worker(void* arg) {
-  struct uv__work* w;
-  struct uv__queue* q;
-  int is_slow_work;
+static int wake_shard(struct wq_shard* s) {
+  if (s->idle_threads <= s->wakeups)
+    return 0;
 
-  uv_sem_post((uv_sem_t*) arg);
-  arg = NULL;
+  s->wakeups += 1;
+  uv_cond_signal(&s->cond);
+  return 1;
+}
 
-  uv_mutex_lock(&mutex);
-  for (;;) {
-    /* `mutex` should always be locked at this point. */
-
-    /* Keep waiting while either no work is present or only slow I/O
-       and we're at the threshold for that. */
-    while (uv__queue_empty(&wq) ||
-           (uv__queue_head(&wq) == &run_slow_work_message &&
-            uv__queue_next(&run_slow_work_message) == &wq &&
-            slow_io_work_running >= slow_work_thread_threshold())) {
-      idle_threads += 1;
-      uv_cond_wait(&cond, &mutex);
-      idle_threads -= 1;
-    }
 
-    q = uv__queue_head(&wq);
-    if (q == &exit_message) {
-      uv_cond_signal(&cond);
-      uv_mutex_unlock(&mutex);
-      break;
+/* Wakes up an idle thread, preferably one that isn't serving `skip`.
+ * Must be called without holding any queue lock.
+ */
+static void wake_idle_thread(uv_threadpool_t* pool, struct wq_shard* skip) {
+  struct wq_shard* s;
+  unsigned int i;
+
+  if (uv__load_int(&pool->idle_threads) == 0)
+    return;
+
+  for (i = 1; i <= pool->nshards; i++) {
+    s = pool->shards + ((skip - pool->shards) + i) % pool->nshards;
+    uv_mutex_lock(&s->mutex);
+    if (wake_shard(s)) {
+      uv_mutex_unlock(&s->mutex);
+      return;
     }
+    uv_mutex_unlock(&s->mutex);
+  }
+}
 
-    uv__queue_remove(q);
-    uv__queue_init(q);  /* Signal uv_cancel() that the work req is executing. */
-
-    is_slow_work = 0;
-    if (q == &run_slow_work_message) {
-      /* If we're at the slow I/O threshold, re-schedule until after all
-         other work in the queue is done. */
-      if (slow_io_work_running >= slow_work_thread_threshold()) {
-        uv__queue_insert_tail(&wq, q);
+
+static void slow_io_release(uv_threadpool_t* pool) {
+  uv__fetch_add_int(&pool->slow_io_work_running, -1);
+
+  /* Slow I/O may be waiting in a queue that no busy thread looks at. */
+  if (pool->nshards > 1)
+    wake_idle_thread(pool, pool->shards);
+}
+
+
+static int shard_empty(struct wq_shard* s) {
+  unsigned int i;
+
+  for (i = 0; i < PRIORITY_CLASSES; i++)
+    if (!uv__queue_empty(&s->classes[i].wq))
+      return 0;
+
+  return 1;
+}
+
+
+/* Returns the class that gets the next turn, skipping the classes in
+ * `skip`, or NULL if none of them has work.
+ */
+static struct wq_class* next_class(struct wq_shard* s, unsigned int skip) {
+  struct wq_class* c;
+  unsigned int round;
+  unsigned int i;
+  int pending;
+
+  for (round = 0; round < 2; round++) {
+    pending = 0;
+    for (i = 0; i < PRIORITY_CLASSES; i++) {
+      if (skip & (1u << class_order[i]))
         continue;
-      }
 
-      /* If we encountered a request to run slow I/O work but there is none
-         to run, that means it's cancelled => Start over. */
-      if (uv__queue_empty(&slow_io_pending_wq))
+      c = s->classes + class_order[i];
+      if (uv__queue_empty(&c->wq))
         continue;
 
-      is_slow_work = 1;
-      slow_io_work_running++;
+      if (c->turns > 0)
+        return c;
+
+      pending = 1;
+    }
+
+    if (!pending)
+      break;
+
+    /* Every class with work has used up its turns. Start a new round. */
+    for (i = 0; i < PRIORITY_CLASSES; i++)
+      s->classes[i].turns = class_turns[i];
+  }
+
+  return NULL;
+}
+
+
+/* Removes the next runnable work item from `s`. Returns NULL when there is
+ * none, or the exit message when the queue is empty and the threads should
+ * exit. Must be called with `s->mutex` held.
+ */
+static struct uv__queue* dequeue(uv_threadpool_t* pool,
+                                 struct wq_shard* s,
+                                 int* is_slow_work) {
+  struct wq_class* c;
+  struct uv__queue* q;
+  unsigned int skip;
+
+  skip = 0;
+  for (;;) {
+    c = next_class(s, skip);
+    if (c == NULL) {
+      if (s->exiting && shard_empty(s))
+        return &s->exit_message;
+      return NULL;
+    }
+
+    q = uv__queue_head(&c->wq);
+    if (q != &c->run_slow_work_message) {
+      uv__queue_remove(q);
+      uv__queue_init(q);  /* Signal uv_cancel() that the work req is
+                             executing. */
+      c->turns -= 1;
+      s->started += 1;
+      *is_slow_work = 0;
+      return q;
+    }
 
-      q = uv__queue_head(&slow_io_pending_wq);
+    /* If we encountered a request to run slow I/O work but there is none
+       to run, that means it's cancelled => Start over. */
+    if (uv__queue_empty(&c->slow_io_pending_wq)) {
       uv__queue_remove(q);
       uv__queue_init(q);
+      continue;
+    }
 
-      /* If there is more slow I/O work, schedule it to be run as well. */
-      if (!uv__queue_empty(&slow_io_pending_wq)) {
-        uv__queue_insert_tail(&wq, &run_slow_work_message);
-        if (idle_threads > 0)
-          uv_cond_signal(&cond);
+    /* If we're at the slow I/O threshold, re-schedule until after all
+       other work in the class is done. Only slow I/O left => Try the
+       other classes. */
+    if (!slow_io_acquire(pool)) {
+      if (uv__queue_next(q) == &c->wq) {
+        skip |= 1u << (c - s->classes);
+        continue;
       }
+      uv__queue_remove(q);
+      uv__queue_insert_tail(&c->wq, q);
+      continue;
     }
 
-    uv_mutex_unlock(&mutex);
+    uv__queue_remove(q);
+    uv__queue_init(q);
+
+    q = uv__queue_head(&c->slow_io_pending_wq);
+    uv__queue_remove(q);
+    uv__queue_init(q);
+
+    /* If there is more slow I/O work, schedule it to be run as well. */
+    if (!uv__queue_empty(&c->slow_io_pending_wq)) {
+      uv__queue_insert_tail(&c->wq, &c->run_slow_work_message);
+      wake_shard(s);
+    }
+
+    c->turns -= 1;
+    s->started += 1;
+    s->slow_io_queued -= 1;
+    *is_slow_work = 1;
+    return q;
+  }
+}
+
+
+static unsigned int histogram_bucket(uint64_t ns) {
+  unsigned int bucket;
+  uint64_t us;
+
+  bucket = 0;
+  for (us = ns / 1000; us != 0; us >>= 1)
+    if (++bucket == UV_THREADPOOL_HISTOGRAM_BUCKETS - 1)
+      break;
+
+  return bucket;
+}
+
+
+/* Accounts for finished work. Must be called with `s->mutex` held, where
+ * `s` is the queue that holds the work of `w->loop`.
+ */
+static void record(struct wq_shard* s,
+                   struct uv__work* w,
+                   uint64_t wait_time,
+                   uint64_t run_time) {
+  s->wait_time[w->kind][histogram_bucket(wait_time)] += 1;
+  s->run_time[w->kind][histogram_bucket(run_time)] += 1;
+}
+
+
+/* Hands `w` back to its event loop. `work` is what uv__work_done() checks
+ * to tell finished from cancelled work. Must be called with `s->mutex`
+ * held, where `s` is the queue that holds the work of `w->loop`, as
+ * returned by lock_home_shard(). uv__work_loop_close() takes that lock to
+ * know no thread is still touching the loop.
+ */
+static void complete(struct wq_shard* s,
+                     struct uv__work* w,
+                     void (*work)(struct uv__work* w)) {
+  uv__loop_internal_fields_t* lfields;
+  void* head;
+
+  if (work == uv__cancelled)
+    s->cancelled += 1;
+  else
+    s->completed += 1;
+
+  w->work = work;
+  lfields = uv__get_internal_fields(w->loop);
+  do {
+    head = uv__load_ptr(&lfields->wq_completed);
+    w->wq.next = (struct uv__queue*) head;
+  } while (!uv__cas_ptr(&lfields->wq_completed, head, &w->wq));
+
+  if (head == NULL)
+    uv_async_send(&w->loop->wq_async);
+}
+
+
+static struct wq_shard* home_shard(uv_threadpool_t* pool, uv_loop_t* loop) {
+  uv__loop_internal_fields_t* lfields;
+
+  lfields = uv__get_internal_fields(loop);
+  if (lfields->wq_shard == 0)
+    lfields->wq_shard =
+        1 + uv__fetch_add_int(&pool->next_home_shard, 1) % pool->nshards;
+
+  return pool->shards + (lfields->wq_shard - 1) % pool->nshards;
+}
+
+
+/* Locks and returns the queue that holds the work of `loop`, following the
+ * home queue's forwarding, see forward_shard().
+ */
+static struct wq_shard* lock_home_shard(uv_threadpool_t* pool,
+                                        uv_loop_t* loop) {
+  struct wq_shard* s;
+  struct wq_shard* to;
+
+  s = home_shard(pool, loop);
+  for (;;) {
+    while ((to = (struct wq_shard*) uv__load_ptr((void**) &s->forward)))
+      s = to;
+
+    uv_mutex_lock(&s->mutex);
+    if (s->forward == NULL)
+      return s;
+    uv_mutex_unlock(&s->mutex);
+  }
+}
+
+
+/* Records and completes work that thread `t` has run. Must be called without
+ * holding any queue lock.
+ */
+static void complete_home(struct wq_thread* t, struct uv__work* w) {
+  struct wq_shard* s;
+
+  s = lock_home_shard(t->pool, w->loop);
+  record(s, w, t->wait_time, t->run_time);
+  complete(s, w, NULL);
+  uv_mutex_unlock(&s->mutex);
+}
 
+
+/* Takes work from another thread's queue. Must be called without holding
+ * any queue lock.
+ */
+static struct uv__queue* steal(uv_threadpool_t* pool,
+                               struct wq_shard* self,
+                               struct wq_shard** owner,
+                               int* is_slow_work) {
+  struct wq_shard* s;
+  struct uv__queue* q;
+  unsigned int i;
+
+  for (i = 1; i < pool->nshards; i++) {
+    s = pool->shards + ((self - pool->shards) + i) % pool->nshards;
+    uv_mutex_lock(&s->mutex);
+    q = dequeue(pool, s, is_slow_work);
+    uv_mutex_unlock(&s->mutex);
+    if (q != NULL && q != &s->exit_message) {
+      *owner = s;
+      return q;
+    }
+  }
+
+  return NULL;
+}
+
+
+/* Completes `done`, if not NULL, and blocks until there is work for
+ * thread `t`. Returns NULL when the thread should exit. `owner` is set to
+ * the queue the work came from.
+ */
+static struct uv__queue* next_work(struct wq_thread* t,
+                                   struct uv__work* done,
+                                   struct wq_shard** owner,
+                                   int* is_slow_work) {
+  uv_threadpool_t* pool;
+  struct wq_shard* s;
+  struct uv__queue* q;
+  int pass_on;
+
+  pool = t->pool;
+  s = t->shard;
+  pass_on = 0;
+  *owner = s;
+  uv_mutex_lock(&s->mutex);
+
+  if (done != NULL) {
+    if (s->forward == NULL) {
+      record(s, done, t->wait_time, t->run_time);
+      complete(s, done, NULL);
+    } else {
+      /* Our queue was forwarded while the work ran. */
+      uv_mutex_unlock(&s->mutex);
+      complete_home(t, done);
+      uv_mutex_lock(&s->mutex);
+    }
+  }
+
+  for (;;) {
+    /* `s->mutex` should always be locked at this point. */
+    if (s->nretire > 0) {
+      s->nretire -= 1;
+      /* We may have consumed the wakeup meant for pending work. */
+      if (!shard_empty(s))
+        pass_on = !wake_shard(s) && pool->nshards > 1;
+      q = NULL;
+      break;
+    }
+
+    q = dequeue(pool, s, is_slow_work);
+    if (q == &s->exit_message) {
+      uv_cond_signal(&s->cond);
+      q = NULL;
+      break;
+    }
+
+    if (q != NULL)
+      break;
+
+    s->idle_threads += 1;
+
+    if (pool->nshards > 1) {
+      /* Count ourselves as idle before looking at the other queues so that
+         work posted to a queue we have already looked at wakes us up. */
+      uv__fetch_add_int(&pool->idle_threads, 1);
+      uv_mutex_unlock(&s->mutex);
+      q = steal(pool, s, owner, is_slow_work);
+      uv_mutex_lock(&s->mutex);
+    }
+
+    if (q == NULL && s->wakeups == 0)
+      uv_cond_wait(&s->cond, &s->mutex);
+
+    if (s->wakeups > 0) {
+      s->wakeups -= 1;
+      /* We got work elsewhere, let someone else pick up the new work. */
+      pass_on = (q != NULL);
+    }
+
+    if (pool->nshards > 1)
+      uv__fetch_add_int(&pool->idle_threads, -1);
+
+    s->idle_threads -= 1;
+
+    if (q != NULL)
+      break;
+  }
+  uv_mutex_unlock(&s->mutex);
+
+  if (pass_on)
+    wake_idle_thread(pool, s);
+
+  return q;
+}
+
+
+/* To avoid deadlock with uv_cancel() it's crucial that the worker
+ * never holds two queue mutexes at the same time.
+ */
+static void worker(void* arg) {
+  struct wq_shard* owner;
+  struct wq_thread* t;
+  struct uv__work* done;
+  struct uv__work* w;
+  struct uv__queue* q;
+  uint64_t start;
+  int is_slow_work;
+
+  t = (struct wq_thread*) arg;
+  uv_sem_post(t->started);
+  arg = NULL;
+
+  done = NULL;
+  while ((q = next_work(t, done, &owner, &is_slow_work)) != NULL) {
     w = uv__queue_data(q, struct uv__work, wq);
+    start = uv_hrtime();
     w->work(w);
+    t->run_time = uv_hrtime() - start;
+    t->wait_time = start - w->queued;
+
+    /* Work from our own queue is completed by the next call to next_work(),
+     * which takes the lock anyway.
+     */
+    done = w;
+    if (owner != t->shard) {
+      complete_home(t, w);
+      done = NULL;
+    }
 
-    uv_mutex_lock(&w->loop->wq_mutex);
-    w->work = NULL;  /* Signal uv_cancel() that the work req is done
-                        executing. */
-    uv__queue_insert_tail(&w->loop->wq, &w->wq);
-    uv_async_send(&w->loop->wq_async);
-    uv_mutex_unlock(&w->loop->wq_mutex);
-
-    /* Lock `mutex` since that is expected at the start of the next
-     * iteration. */
-    uv_mutex_lock(&mutex);
-    if (is_slow_work) {
-      /* `slow_io_work_running` is protected by `mutex`. */
-      slow_io_work_running--;
+    if (is_slow_work)
+      slow_io_release(t->pool);
+  }
+
+  uv__exchange_int_relaxed(&t->exited, 1);
+}
+
+
+/* Joins threads that have exited after the pool shrunk. Must be called with
+ * `pool->lock` held.
+ */
+static void reap_threads(uv_threadpool_t* pool) {
+  struct wq_thread* t;
+  struct uv__queue* q;
+  struct uv__queue* next;
+
+  for (q = uv__queue_head(&pool->threads); q != &pool->threads; q = next) {
+    next = uv__queue_next(q);
+    t = uv__queue_data(q, struct wq_thread, queue);
+    if (uv__load_int(&t->exited) == 0)
+      continue;
+
+    if (uv_thread_join(&t->thread))
+      abort();
+
+    uv__queue_remove(q);
+    uv__free(t);
+  }
+}
+
+
+/* Returns the queue, other than `skip`, that still has threads of its own
+ * but the fewest of them or, with `skip`, the fewest other queues
+ * forwarding to it. Must be called with `pool->lock` held.
+ */
+static struct wq_shard* least_served_shard(uv_threadpool_t* pool,
+                                           struct wq_shard* skip) {
+  struct wq_shard* best;
+  struct wq_shard* s;
+  unsigned int i;
+
+  best = NULL;
+  for (i = 0; i < pool->nshards; i++) {
+    s = pool->shards + i;
+    if (s == skip || s->forward != NULL)
+      continue;
+
+    if (best == NULL)
+      best = s;
+    else if (skip == NULL && s->nthreads < best->nthreads)
+      best = s;
+    else if (skip != NULL && s->nhomes < best->nhomes)
+      best = s;
+  }
+
+  return best;
+}
+
+
+/* Moves the work queued on `s` to `to` and sends future work there as well.
+ * Must be called with `pool->lock` held.
+ */
+static void forward_shard(struct wq_shard* s, struct wq_shard* to) {
+  struct wq_class* from;
+  struct wq_class* c;
+  uint64_t nwork;
+  unsigned int i;
+
+  if (s < to) {
+    uv_mutex_lock(&s->mutex);
+    uv_mutex_lock(&to->mutex);
+  } else {
+    uv_mutex_lock(&to->mutex);
+    uv_mutex_lock(&s->mutex);
+  }
+
+  nwork = s->submitted - s->started - s->cancelled;
+  for (i = 0; i < PRIORITY_CLASSES; i++) {
+    from = s->classes + i;
+    c = to->classes + i;
+
+    /* The slow I/O marker belongs to the queue, it isn't work. */
+    if (!uv__queue_empty(&from->run_slow_work_message)) {
+      uv__queue_remove(&from->run_slow_work_message);
+      uv__queue_init(&from->run_slow_work_message);
     }
+
+    uv__queue_add(&c->wq, &from->wq);
+    uv__queue_init(&from->wq);
+
+    if (uv__queue_empty(&from->slow_io_pending_wq))
+      continue;
+
+    uv__queue_add(&c->slow_io_pending_wq, &from->slow_io_pending_wq);
+    uv__queue_init(&from->slow_io_pending_wq);
+    if (uv__queue_empty(&c->run_slow_work_message))
+      uv__queue_insert_tail(&c->wq, &c->run_slow_work_message);
   }
+
+  /* Move the work's accounting along with it. */
+  s->submitted -= nwork;
+  to->submitted += nwork;
+  to->slow_io_queued += s->slow_io_queued;
+  s->slow_io_queued = 0;
+
+  uv__exchange_ptr((void**) &s->forward, to);
+  to->nhomes += s->nhomes;
+  s->nhomes = 0;
+
+  for (; nwork > 0; nwork--)
+    if (!wake_shard(to))
+      break;
+
+  uv_mutex_unlock(&s->mutex);
+  uv_mutex_unlock(&to->mutex);
 }
 
 
-static void post(struct uv__queue* q, enum uv__work_kind kind) {
-  uv_mutex_lock(&mutex);
-  if (kind == UV__WORK_SLOW_IO) {
-    /* Insert into a separate queue. */
-    uv__queue_insert_tail(&slow_io_pending_wq, q);
-    if (!uv__queue_empty(&run_slow_work_message)) {
-      /* Running slow I/O tasks is already scheduled => Nothing to do here.
-         The worker that runs said other task will schedule this one as well. */
-      uv_mutex_unlock(&mutex);
-      return;
+/* Starts `n` more threads. Must be called with `pool->lock` held. */
+static int add_threads(uv_threadpool_t* pool, unsigned int n) {
+  uv_thread_options_t config;
+  struct wq_thread* t;
+  unsigned int i;
+  uv_sem_t sem;
+  int err;
+
+  err = uv_sem_init(&sem, 0);
+  if (err)
+    return err;
+
+  config.flags = UV_THREAD_HAS_STACK_SIZE;
+  config.stack_size = 8u << 20;  /* 8 MB */
+
+  for (i = 0; i < n; i++) {
+    t = (struct wq_thread*) uv__malloc(sizeof(*t));
+    if (t == NULL) {
+      err = UV_ENOMEM;
+      break;
+    }
+
+    t->pool = pool;
+    t->shard = least_served_shard(pool, NULL);
+    t->shard->nthreads += 1;
+    t->started = &sem;
+    t->exited = 0;
+
+    err = uv_thread_create_ex(&t->thread, &config, worker, t);
+    if (err) {
+      uv__free(t);
+      break;
     }
-    q = &run_slow_work_message;
+
+    uv__queue_insert_tail(&pool->threads, &t->queue);
+    uv__fetch_add_int(&pool->nthreads, 1);
   }
 
-  uv__queue_insert_tail(&wq, q);
-  if (idle_threads > 0)
-    uv_cond_signal(&cond);
-  uv_mutex_unlock(&mutex);
+  while (i-- > 0)
+    uv_sem_wait(&sem);
+
+  uv_sem_destroy(&sem);
+  return err;
 }
 
 
-#ifdef __MVS__
-/* TODO(itodorov) - zos: revisit when Woz compiler is available. */
-__attribute__((destructor))
-#endif
-void uv__threadpool_cleanup(void) {
+/* Asks `n` threads to exit, from the queue with the most threads. When
+ * that is down to one, the last queue that still has threads of its own
+ * forwards its work first. Must be called with `pool->lock` held.
+ */
+static void remove_threads(uv_threadpool_t* pool, unsigned int n) {
+  struct wq_shard* s;
   unsigned int i;
 
-  if (nthreads == 0)
-    return;
+  uv__fetch_add_int(&pool->nthreads, -(int) n);
+
+  while (n-- > 0) {
+    s = NULL;
+    for (i = 0; i < pool->nshards; i++)
+      if (s == NULL || pool->shards[i].nthreads >= s->nthreads)
+        s = pool->shards + i;
+
+    if (s->nthreads == 1)
+      forward_shard(s, least_served_shard(pool, s));
+
+    s->nthreads -= 1;
+    uv_mutex_lock(&s->mutex);
+    s->nretire += 1;
+    uv_cond_broadcast(&s->cond);
+    uv_mutex_unlock(&s->mutex);
+  }
+}
+
+
+static void pool_stop(uv_threadpool_t* pool);
+
+
+static int pool_start(uv_threadpool_t* pool, unsigned int size) {
+  struct wq_shard* s;
+  unsigned int i;
+  unsigned int j;
+  int err;
+
+  pool->nshards = 1;
+  if (pool->flags & UV_THREADPOOL_WORK_STEALING)
+    pool->nshards = size;
+
+  pool->shards = (struct wq_shard*) uv__calloc(pool->nshards, sizeof(*s));
+  if (pool->shards == NULL)
+    return UV_ENOMEM;
+
+  for (i = 0; i < pool->nshards; i++) {
+    s = pool->shards + i;
+
+    if (uv_cond_init(&s->cond))
+      abort();
+
+    if (uv_mutex_init(&s->mutex))
+      abort();
+
+    uv__queue_init(&s->exit_message);
+    for (j = 0; j < PRIORITY_CLASSES; j++) {
+      uv__queue_init(&s->classes[j].wq);
+      uv__queue_init(&s->classes[j].slow_io_pending_wq);
+      uv__queue_init(&s->classes[j].run_slow_work_message);
+      s->classes[j].turns = class_turns[j];
+    }
+    s->nhomes = 1;
+  }
+
+  if (uv_mutex_init(&pool->lock))
+    abort();
+
+  uv__queue_init(&pool->threads);
+  pool->nthreads = 0;
+  pool->idle_threads = 0;
+  pool->slow_io_work_running = 0;
+  pool->next_home_shard = 0;
+
+  uv_mutex_lock(&pool->lock);
+  err = add_threads(pool, size);
+  uv_mutex_unlock(&pool->lock);
+
+  if (err)
+    pool_stop(pool);
+
+  return err;
+}
+
+
+static void pool_stop(uv_threadpool_t* pool) {
+  struct wq_thread* t;
+  struct uv__queue* q;
+  unsigned int i;
 
 #ifndef __MVS__
   /* TODO(gabylb) - zos: revisit when Woz compiler is available. */
-  post(&exit_message, UV__WORK_CPU);
+  for (i = 0; i < pool->nshards; i++) {
+    uv_mutex_lock(&pool->shards[i].mutex);
+    pool->shards[i].exiting = 1;
+    uv_cond_broadcast(&pool->shards[i].cond);
+    uv_mutex_unlock(&pool->shards[i].mutex);
+  }
 #endif
 
-  for (i = 0; i < nthreads; i++)
-    if (uv_thread_join(threads + i))
+  while (!uv__queue_empty(&pool->threads)) {
+    q = uv__queue_head(&pool->threads);
+    uv__queue_remove(q);
+    t = uv__queue_data(q, struct wq_thread, queue);
+    if (uv_thread_join(&t->thread))
       abort();
+    uv__free(t);
+  }
+
+  for (i = 0; i < pool->nshards; i++) {
+    uv_mutex_destroy(&pool->shards[i].mutex);
+    uv_cond_destroy(&pool->shards[i].cond);
+  }
 
-  if (threads != default_threads)
-    uv__free(threads);
+  uv_mutex_destroy(&pool->lock);
+  uv__free(pool->shards);
+  pool->shards = NULL;
+  pool->nshards = 0;
+  pool->nthreads = 0;
+}
+
+
+#ifdef __MVS__
+/* TODO(itodorov) - zos: revisit when Woz compiler is available. */
+__attribute__((destructor))
+#endif
+void uv__threadpool_cleanup(void) {
+  uv_threadpool_t* pool;
+  struct uv__queue* q;
+
+  if (pools.next == NULL)
+    return;
 
-  uv_mutex_destroy(&mutex);
-  uv_cond_destroy(&cond);
+  while (!uv__queue_empty(&pools)) {
+    q = uv__queue_head(&pools);
+    uv__queue_remove(q);
+    pool = uv__queue_data(q, uv_threadpool_t, queue);
+    pool_stop(pool);
+    if (pool != &default_pool) {
+      uv__free(pool->name);
+      uv__free(pool);
+    }
+  }
 
-  threads = NULL;
-  nthreads = 0;
+  uv_mutex_destroy(&pools_mutex);
+  pools.next = NULL;
 }
 
 
-static void init_threads(void) {
-  uv_thread_options_t config;
-  unsigned int i;
+static unsigned int default_pool_size(void) {
+  unsigned int size;
   const char* val;
-  uv_sem_t sem;
 
-  nthreads = ARRAY_SIZE(default_threads);
+  size = 4;
   val = getenv("UV_THREADPOOL_SIZE");
   if (val != NULL)
-    nthreads = atoi(val);
-  if (nthreads == 0)
-    nthreads = 1;
-  if (nthreads > MAX_THREADPOOL_SIZE)
-    nthreads = MAX_THREADPOOL_SIZE;
-
-  threads = default_threads;
-  if (nthreads > ARRAY_SIZE(default_threads)) {
-    threads = (uv_thread_t*) uv__malloc(nthreads * sizeof(threads[0]));
-    if (threads == NULL) {
-      nthreads = ARRAY_SIZE(default_threads);
-      threads = default_threads;
-    }
-  }
+    size = atoi(val);
+  if (size == 0)
+    size = 1;
+  if (size > MAX_THREADPOOL_SIZE)
+    size = MAX_THREADPOOL_SIZE;
 
-  if (uv_cond_init(&cond))
-    abort();
+  return size;
+}
 
-  if (uv_mutex_init(&mutex))
-    abort();
 
-  uv__queue_init(&wq);
-  uv__queue_init(&slow_io_pending_wq);
-  uv__queue_init(&run_slow_work_message);
+static void init_threads(void) {
+  uv_threadpool_t* pool;
+  struct uv__queue* q;
+  struct uv__queue* t;
+  const char* val;
 
-  if (uv_sem_init(&sem, 0))
+  if (uv_mutex_init(&pools_mutex))
     abort();
 
-  config.flags = UV_THREAD_HAS_STACK_SIZE;
-  config.stack_size = 8u << 20;  /* 8 MB */
+  /* After a fork, restart the threads of every pool. Work that was queued
+   * in the parent is discarded.
+   */
+  if (pools.next != NULL) {
+    uv__queue_foreach(q, &pools) {
+      pool = uv__queue_data(q, uv_threadpool_t, queue);
+      while (!uv__queue_empty(&pool->threads)) {
+        t = uv__queue_head(&pool->threads);
+        uv__queue_remove(t);
+        uv__free(uv__queue_data(t, struct wq_thread, queue));
+      }
+      uv__free(pool->shards);
+      if (pool_start(pool, pool->nthreads))
+        abort();
+    }
+    return;
+  }
 
-  for (i = 0; i < nthreads; i++)
-    if (uv_thread_create_ex(threads + i, &config, worker, &sem))
-      abort();
+  uv__queue_init(&pools);
 
-  for (i = 0; i < nthreads; i++)
-    uv_sem_wait(&sem);
+  default_pool.name = default_pool_name;
+  default_pool.flags = 0;
+  val = getenv("UV_THREADPOOL_STEALING");
+  if (val != NULL && atoi(val) != 0)
+    default_pool.flags |= UV_THREADPOOL_WORK_STEALING;
 
-  uv_sem_destroy(&sem);
+  if (pool_start(&default_pool, default_pool_size()))
+    abort();
+
+  uv__queue_insert_tail(&pools, &default_pool.queue);
 }
 
 
@@ -262,16 +966,91 @@ static void init_once(void) {
 }
 
 
+static void post(uv_threadpool_t* pool,
+                 struct uv__queue* q,
+                 uv_loop_t* loop,
+                 enum uv__work_kind kind,
+                 uv_work_priority priority) {
+  struct wq_class* c;
+  struct wq_shard* s;
+  int wake_other;
+
+  s = lock_home_shard(pool, loop);
+  c = s->classes + priority;
+  s->submitted += 1;
+  if (kind == UV__WORK_SLOW_IO) {
+    /* Insert into a separate queue. */
+    uv__queue_insert_tail(&c->slow_io_pending_wq, q);
+    s->slow_io_queued += 1;
+    if (!uv__queue_empty(&c->run_slow_work_message)) {
+      /* Running slow I/O tasks is already scheduled => Nothing to do here.
+         The worker that runs said other task will schedule this one as well. */
+      uv_mutex_unlock(&s->mutex);
+      return;
+    }
+    q = &c->run_slow_work_message;
+  }
+
+  uv__queue_insert_tail(&c->wq, q);
+
+  wake_other = !wake_shard(s) && pool->nshards > 1;
+  uv_mutex_unlock(&s->mutex);
+
+  if (wake_other)
+    wake_idle_thread(pool, s);
+}
+
+
+static void submit(uv_threadpool_t* pool,
+                   uv_loop_t* loop,
+                   struct uv__work* w,
+                   enum uv__work_kind kind,
+                   uv_work_priority priority,
+                   void (*work)(struct uv__work* w),
+                   void (*done)(struct uv__work* w, int status)) {
+  w->loop = loop;
+  w->work = work;
+  w->done = done;
+  w->pool = pool;
+  w->kind = kind;
+  w->queued = uv_hrtime();
+  uv__fetch_add_int(&pool->refs, 1);
+  post(pool, &w->wq, loop, kind, priority);
+}
+
+
+static uv_threadpool_t* loop_pool(uv_loop_t* loop, uv_req_type type) {
+  uv_threadpool_t* pool;
+
+  pool = uv__get_internal_fields(loop)->wq_pools[type];
+  if (pool == NULL)
+    pool = &default_pool;
+
+  return pool;
+}
+
+
 void uv__work_submit(uv_loop_t* loop,
+                     uv_req_t* req,
                      struct uv__work* w,
                      enum uv__work_kind kind,
                      void (*work)(struct uv__work* w),
                      void (*done)(struct uv__work* w, int status)) {
+  uv__loop_internal_fields_t* lfields;
+  uv_work_priority priority;
+  uv_fs_type fs_type;
+
   uv_once(&once, init_once);
-  w->loop = loop;
-  w->work = work;
-  w->done = done;
-  post(&w->wq, kind);
+
+  priority = UV_WORK_PRIORITY_NORMAL;
+  if (req->type == UV_FS) {
+    fs_type = ((uv_fs_t*) req)->fs_type;
+    lfields = uv__get_internal_fields(loop);
+    if (fs_type >= 0 && fs_type < UV__FS_TYPE_MAX)
+      priority = (uv_work_priority) lfields->wq_fs_priority[fs_type];
+  }
+
+  submit(loop_pool(loop, req->type), loop, w, kind, priority, work, done);
 }
 
 
@@ -279,44 +1058,132 @@ void uv__work_submit(uv_loop_t* loop,
  * that go through io_uring instead of the thread pool.
  */
 static int uv__work_cancel(uv_loop_t* loop, uv_req_t* req, struct uv__work* w) {
+  struct wq_shard* s;
   int cancelled;
 
-  uv_once(&once, init_once);  /* Ensure |mutex| is initialized. */
-  uv_mutex_lock(&mutex);
-  uv_mutex_lock(&w->loop->wq_mutex);
+  uv_once(&once, init_once);  /* Ensure the default pool is initialized. */
+  s = lock_home_shard(w->pool, w->loop);
 
-  cancelled = !uv__queue_empty(&w->wq) && w->work != NULL;
-  if (cancelled)
+  cancelled = !uv__queue_empty(&w->wq) &&
+              w->work != NULL &&
+              w->work != uv__cancelled;
+  if (cancelled) {
     uv__queue_remove(&w->wq);
+    if (w->kind == UV__WORK_SLOW_IO)
+      s->slow_io_queued -= 1;
+    complete(s, w, uv__cancelled);
+  }
 
-  uv_mutex_unlock(&w->loop->wq_mutex);
-  uv_mutex_unlock(&mutex);
+  uv_mutex_unlock(&s->mutex);
 
   if (!cancelled)
     return UV_EBUSY;
 
-  w->work = uv__cancelled;
-  uv_mutex_lock(&loop->wq_mutex);
-  uv__queue_insert_tail(&loop->wq, &w->wq);
-  uv_async_send(&loop->wq_async);
-  uv_mutex_unlock(&loop->wq_mutex);
+  return 0;
+}
+
+
+/* Waits for threads that may still be touching `loop` after handing back
+ * the last of its work.
+ */
+void uv__work_loop_close(uv_loop_t* loop) {
+  uv__loop_internal_fields_t* lfields;
+  uv_threadpool_t* pool;
+  struct wq_shard* s;
+  struct uv__queue* q;
+  int type;
+
+  lfields = uv__get_internal_fields(loop);
+  assert(uv__load_ptr(&lfields->wq_completed) == NULL &&
+         "thread pool work queue not empty!");
+
+  for (type = 0; type < UV_REQ_TYPE_MAX; type++) {
+    pool = lfields->wq_pools[type];
+    if (pool != NULL)
+      uv__fetch_add_int(&pool->refs, -1);
+    lfields->wq_pools[type] = NULL;
+  }
+
+  if (lfields->wq_shard == 0 || pools.next == NULL)
+    return;
+
+  uv_mutex_lock(&pools_mutex);
+  uv__queue_foreach(q, &pools) {
+    pool = uv__queue_data(q, uv_threadpool_t, queue);
+    s = lock_home_shard(pool, loop);
+    uv_mutex_unlock(&s->mutex);
+  }
+  uv_mutex_unlock(&pools_mutex);
+}
+
+
+int uv__work_loop_configure(uv_loop_t* loop,
+                            uv_loop_option option,
+                            va_list ap) {
+  uv__loop_internal_fields_t* lfields;
+  uv_threadpool_t* pool;
+  int priority;
+  int type;
+
+  lfields = uv__get_internal_fields(loop);
+
+  if (option == UV_LOOP_FS_PRIORITY) {
+    type = va_arg(ap, int);
+    priority = va_arg(ap, int);
+    if (type < 0 || type >= UV__FS_TYPE_MAX)
+      return UV_EINVAL;
+    if (priority < 0 || priority >= PRIORITY_CLASSES)
+      return UV_EINVAL;
+    lfields->wq_fs_priority[type] = (unsigned char) priority;
+    return 0;
+  }
+
+  type = va_arg(ap, int);
+  pool = va_arg(ap, uv_threadpool_t*);
+
+  switch (type) {
+  case UV_FS:
+  case UV_GETADDRINFO:
+  case UV_GETNAMEINFO:
+  case UV_RANDOM:
+  case UV_WORK:
+    break;
+  default:
+    return UV_EINVAL;
+  }
 
+  /* Keeps uv_threadpool_delete() from freeing the pool under the loop. */
+  if (pool != NULL)
+    uv__fetch_add_int(&pool->refs, 1);
+  if (lfields->wq_pools[type] != NULL)
+    uv__fetch_add_int(&lfields->wq_pools[type]->refs, -1);
+
+  lfields->wq_pools[type] = pool;
   return 0;
 }
 
 
 void uv__work_done(uv_async_t* handle) {
+  uv__loop_internal_fields_t* lfields;
   struct uv__work* w;
   uv_loop_t* loop;
   struct uv__queue* q;
+  struct uv__queue* next;
   struct uv__queue wq;
   int err;
   int nevents;
 
   loop = container_of(handle, uv_loop_t, wq_async);
-  uv_mutex_lock(&loop->wq_mutex);
-  uv__queue_move(&loop->wq, &wq);
-  uv_mutex_unlock(&loop->wq_mutex);
+  lfields = uv__get_internal_fields(loop);
+  q = (struct uv__queue*) uv__exchange_ptr(&lfields->wq_completed, NULL);
+
+  /* The stack is in LIFO order, turn it around. */
+  uv__queue_init(&wq);
+  while (q != NULL) {
+    next = q->next;
+    uv__queue_insert_head(&wq, q);
+    q = next;
+  }
 
   nevents = 0;
 
@@ -326,6 +1193,8 @@ void uv__work_done(uv_async_t* handle) {
 
     w = container_of(q, struct uv__work, wq);
     err = (w->work == uv__cancelled) ? UV_ECANCELED : 0;
+    /* Before the callback, which may delete the pool. */
+    uv__fetch_add_int(&w->pool->refs, -1);
     w->done(w, err);
     nevents++;
   }
@@ -369,18 +1238,207 @@ int uv_queue_work(uv_loop_t* loop,
                   uv_work_t* req,
                   uv_work_cb work_cb,
                   uv_after_work_cb after_work_cb) {
+  return uv_queue_work_ex(loop, req, work_cb, after_work_cb, NULL);
+}
+
+
+int uv_queue_work_ex(uv_loop_t* loop,
+                     uv_work_t* req,
+                     uv_work_cb work_cb,
+                     uv_after_work_cb after_work_cb,
+                     const uv_work_options_t* options) {
+  uv_work_priority priority;
+  uv_threadpool_t* pool;
+
   if (work_cb == NULL)
     return UV_EINVAL;
 
+  priority = UV_WORK_PRIORITY_NORMAL;
+  pool = NULL;
+  if (options != NULL) {
+    if (options->priority < 0 || options->priority >= PRIORITY_CLASSES)
+      return UV_EINVAL;
+    priority = options->priority;
+    pool = options->pool;
+  }
+
+  uv_once(&once, init_once);
+  if (pool == NULL)
+    pool = loop_pool(loop, UV_WORK);
+
   uv__req_init(loop, req, UV_WORK);
   req->loop = loop;
   req->work_cb = work_cb;
   req->after_work_cb = after_work_cb;
-  uv__work_submit(loop,
-                  &req->work_req,
-                  UV__WORK_CPU,
-                  uv__queue_work,
-                  uv__queue_done);
+  submit(pool,
+         loop,
+         &req->work_req,
+         UV__WORK_CPU,
+         priority,
+         uv__queue_work,
+         uv__queue_done);
+  return 0;
+}
+
+
+/* Must be called with `pools_mutex` held. */
+static uv_threadpool_t* find_pool(const char* name) {
+  uv_threadpool_t* pool;
+  struct uv__queue* q;
+
+  uv__queue_foreach(q, &pools) {
+    pool = uv__queue_data(q, uv_threadpool_t, queue);
+    if (strcmp(pool->name, name) == 0)
+      return pool;
+  }
+
+  return NULL;
+}
+
+
+int uv_threadpool_new(uv_threadpool_t** pool,
+                      const char* name,
+                      unsigned int size,
+                      unsigned int flags) {
+  uv_threadpool_t* p;
+  int err;
+
+  if (name == NULL || size == 0 || size > MAX_THREADPOOL_SIZE)
+    return UV_EINVAL;
+
+  if (flags & ~UV_THREADPOOL_WORK_STEALING)
+    return UV_EINVAL;
+
+  uv_once(&once, init_once);
+
+  p = (uv_threadpool_t*) uv__calloc(1, sizeof(*p));
+  if (p == NULL)
+    return UV_ENOMEM;
+
+  p->name = uv__strdup(name);
+  if (p->name == NULL) {
+    uv__free(p);
+    return UV_ENOMEM;
+  }
+
+  uv_mutex_lock(&pools_mutex);
+
+  if (find_pool(name) != NULL) {
+    err = UV_EEXIST;
+    goto fail;
+  }
+
+  p->flags = flags;
+  err = pool_start(p, size);
+  if (err)
+    goto fail;
+
+  uv__queue_insert_tail(&pools, &p->queue);
+  uv_mutex_unlock(&pools_mutex);
+
+  *pool = p;
+  return 0;
+
+fail:
+  uv_mutex_unlock(&pools_mutex);
+  uv__free(p->name);
+  uv__free(p);
+  return err;
+}
+
+
+int uv_threadpool_delete(uv_threadpool_t* pool) {
+  if (pool == &default_pool)
+    return UV_EINVAL;
+
+  if (!uv__cas_int(&pool->refs, 0, -1))
+    return UV_EBUSY;
+
+  uv_mutex_lock(&pools_mutex);
+  uv__queue_remove(&pool->queue);
+  uv_mutex_unlock(&pools_mutex);
+
+  pool_stop(pool);
+  uv__free(pool->name);
+  uv__free(pool);
+
+  return 0;
+}
+
+
+uv_threadpool_t* uv_threadpool_get(const char* name) {
+  uv_threadpool_t* pool;
+
+  uv_once(&once, init_once);
+
+  uv_mutex_lock(&pools_mutex);
+  pool = find_pool(name);
+  uv_mutex_unlock(&pools_mutex);
+
+  return pool;
+}
+
+
+const char* uv_threadpool_get_name(const uv_threadpool_t* pool) {
+  return pool->name;
+}
+
+
+int uv_threadpool_resize(uv_threadpool_t* pool, unsigned int size) {
+  unsigned int nthreads;
+  int err;
+
+  if (size == 0 || size > MAX_THREADPOOL_SIZE)
+    return UV_EINVAL;
+
+  uv_once(&once, init_once);
+
+  err = 0;
+  uv_mutex_lock(&pool->lock);
+  reap_threads(pool);
+
+  nthreads = uv__load_int(&pool->nthreads);
+  if (size > nthreads)
+    err = add_threads(pool, size - nthreads);
+  else if (size < nthreads)
+    remove_threads(pool, nthreads - size);
+
+  uv_mutex_unlock(&pool->lock);
+
+  return err;
+}
+
+
+int uv_threadpool_stats(uv_threadpool_t* pool, uv_threadpool_stats_t* stats) {
+  struct wq_shard* s;
+  unsigned int i;
+  unsigned int j;
+  unsigned int k;
+
+  uv_once(&once, init_once);
+
+  memset(stats, 0, sizeof(*stats));
+  stats->size = uv__load_int(&pool->nthreads);
+
+  for (i = 0; i < pool->nshards; i++) {
+    s = pool->shards + i;
+    uv_mutex_lock(&s->mutex);
+    stats->idle_threads += s->idle_threads;
+    stats->busy_threads += s->started - s->completed;
+    stats->queued += s->submitted - s->started - s->cancelled;
+    stats->slow_io_queued += s->slow_io_queued;
+    stats->submitted += s->submitted;
+    stats->completed += s->completed;
+    stats->cancelled += s->cancelled;
+    for (j = 0; j < UV_WORK_KIND_MAX; j++) {
+      for (k = 0; k < UV_THREADPOOL_HISTOGRAM_BUCKETS; k++) {
+        stats->wait_time[j][k] += s->wait_time[j][k];
+        stats->run_time[j][k] += s->run_time[j][k];
+      }
+    }
+    uv_mutex_unlock(&s->mutex);
+  }
+
   return 0;
 }
 
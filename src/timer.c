@@ -25,6 +25,48 @@
 #include <assert.h>
 #include <limits.h>
 
+/* Hierarchical timing wheel, enabled with UV_LOOP_TIMER_WHEEL. Level 0 has
+ * a slot for each of the next WHEEL_SIZE milliseconds, each level above
+ * covers WHEEL_SIZE times the range of the one below. A timer sits in the
+ * lowest level where its timeout and `now` fall in the same slot of the
+ * level above. When `now` enters a slot of a higher level, the timers in
+ * it are cascaded down. Level 0 slots thus hold timers with the same
+ * timeout, in the order they were started, which is what start_id would
+ * order them by.
+ *
+ * The linked list node is stored in the timer's heap_node, the slot it
+ * lives in in heap_node[2].
+ */
+#define WHEEL_BITS 6
+#define WHEEL_SIZE (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SIZE - 1)
+#define WHEEL_LEVELS 11  /* Enough to cover 64 bits. */
+
+struct uv__timer_wheel {
+  uint64_t now;  /* Never ahead of loop->time. */
+  uint64_t occupied[WHEEL_LEVELS];  /* Bitmaps of non-empty slots. */
+  struct uv__queue slots[WHEEL_LEVELS * WHEEL_SIZE];
+};
+
+/* Array-backed 4-ary heap, enabled with UV_LOOP_TIMER_DHEAP. The entries
+ * carry a copy of the sort key, so comparisons stay within the array. The
+ * timers are only touched to update their slot index, which is stored in
+ * heap_node[0].
+ */
+#define DHEAP_ARITY 4
+
+struct uv__timer_dheap_entry {
+  uint64_t timeout;
+  uint64_t start_id;
+  uv_timer_t* handle;
+};
+
+struct uv__timer_dheap {
+  struct uv__timer_dheap_entry* entries;
+  unsigned int nelts;
+  unsigned int size;
+};
+
 
 static struct heap *timer_heap(const uv_loop_t* loop) {
 #ifdef _WIN32
@@ -35,6 +77,27 @@ static struct heap *timer_heap(const uv_loop_t* loop) {
 }
 
 
+static struct heap* slack_heap(const uv_loop_t* loop) {
+  return (struct heap*) &uv__get_internal_fields(loop)->timer_slack_heap;
+}
+
+
+static struct heap* deadline_heap(const uv_loop_t* loop) {
+  return (struct heap*) &uv__get_internal_fields(loop)->timer_deadline_heap;
+}
+
+
+static uint64_t timer_deadline(const uv_timer_t* handle) {
+  uint64_t deadline;
+
+  deadline = handle->timeout + handle->slack;
+  if (deadline < handle->timeout)
+    deadline = (uint64_t) -1;
+
+  return deadline;
+}
+
+
 static int timer_less_than(const struct heap_node* ha,
                            const struct heap_node* hb) {
   const uv_timer_t* a;
@@ -55,11 +118,339 @@ static int timer_less_than(const struct heap_node* ha,
 }
 
 
+static struct uv__timer_wheel* timer_wheel(const uv_loop_t* loop) {
+  return uv__get_internal_fields(loop)->timer_wheel;
+}
+
+
+static unsigned int lowest_bit(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(bits);
+#else
+  unsigned int n;
+
+  for (n = 0; (bits & 1) == 0; n++)
+    bits >>= 1;
+
+  return n;
+#endif
+}
+
+
+static void wheel_insert(struct uv__timer_wheel* wheel, uv_timer_t* handle) {
+  struct uv__queue* slot;
+  unsigned int level;
+  unsigned int index;
+  unsigned int shift;
+  uint64_t timeout;
+
+  timeout = handle->timeout;
+  if (timeout < wheel->now)
+    timeout = wheel->now;
+
+  for (level = 0; level < WHEEL_LEVELS - 1; level++) {
+    shift = WHEEL_BITS * (level + 1);
+    if (timeout >> shift == wheel->now >> shift)
+      break;
+  }
+
+  index = (timeout >> (WHEEL_BITS * level)) & WHEEL_MASK;
+  slot = wheel->slots + level * WHEEL_SIZE + index;
+  uv__queue_insert_tail(slot, (struct uv__queue*) handle->heap_node);
+  handle->heap_node[2] = slot;
+  wheel->occupied[level] |= (uint64_t) 1 << index;
+}
+
+
+static void wheel_remove(struct uv__timer_wheel* wheel, uv_timer_t* handle) {
+  struct uv__queue* slot;
+  unsigned int n;
+
+  slot = (struct uv__queue*) handle->heap_node[2];
+  uv__queue_remove((struct uv__queue*) handle->heap_node);
+
+  if (uv__queue_empty(slot)) {
+    n = slot - wheel->slots;
+    wheel->occupied[n / WHEEL_SIZE] &= ~((uint64_t) 1 << (n % WHEEL_SIZE));
+  }
+}
+
+
+/* Returns a lower bound for the earliest timeout in the wheel, which is
+ * exact for timers in level 0, or UINT64_MAX if the wheel is empty.
+ */
+static uint64_t wheel_next(const struct uv__timer_wheel* wheel) {
+  unsigned int level;
+  unsigned int shift;
+  unsigned int index;
+  uint64_t bits;
+
+  index = wheel->now & WHEEL_MASK;
+  bits = wheel->occupied[0] & (~(uint64_t) 0 << index);
+  if (bits != 0)
+    return (wheel->now & ~(uint64_t) WHEEL_MASK) | lowest_bit(bits);
+
+  /* The slot of `now` is always empty on the upper levels. */
+  for (level = 1; level < WHEEL_LEVELS; level++) {
+    shift = WHEEL_BITS * level;
+    index = (wheel->now >> shift) & WHEEL_MASK;
+    bits = wheel->occupied[level] & ~(~(uint64_t) 0 >> (WHEEL_MASK - index));
+    if (bits == 0)
+      continue;
+
+    bits = (uint64_t) lowest_bit(bits) << shift;
+    if (level == WHEEL_LEVELS - 1)
+      return bits;
+    return (wheel->now >> (shift + WHEEL_BITS) << (shift + WHEEL_BITS)) | bits;
+  }
+
+  return (uint64_t) -1;
+}
+
+
+/* Moves `now` forward to `time`, which must not be past wheel_next(). */
+static void wheel_advance(struct uv__timer_wheel* wheel, uint64_t time) {
+  struct uv__queue timers;
+  struct uv__queue* slot;
+  struct uv__queue* q;
+  unsigned int level;
+  unsigned int shift;
+  unsigned int index;
+  uint64_t now;
+
+  now = wheel->now;
+  wheel->now = time;
+
+  for (level = WHEEL_LEVELS - 1; level > 0; level--) {
+    shift = WHEEL_BITS * level;
+    if (now >> shift == time >> shift)
+      continue;
+
+    index = (time >> shift) & WHEEL_MASK;
+    if (!(wheel->occupied[level] & ((uint64_t) 1 << index)))
+      continue;
+
+    slot = wheel->slots + level * WHEEL_SIZE + index;
+    uv__queue_move(slot, &timers);
+    wheel->occupied[level] &= ~((uint64_t) 1 << index);
+
+    while (!uv__queue_empty(&timers)) {
+      q = uv__queue_head(&timers);
+      uv__queue_remove(q);
+      wheel_insert(wheel, uv__queue_data(q, uv_timer_t, heap_node));
+    }
+  }
+}
+
+
+static struct uv__timer_dheap* timer_dheap(const uv_loop_t* loop) {
+  return uv__get_internal_fields(loop)->timer_dheap;
+}
+
+
+static int dheap_less_than(const struct uv__timer_dheap_entry* a,
+                           const struct uv__timer_dheap_entry* b) {
+  if (a->timeout < b->timeout)
+    return 1;
+  if (b->timeout < a->timeout)
+    return 0;
+
+  return a->start_id < b->start_id;
+}
+
+
+static void dheap_set(struct uv__timer_dheap* dheap,
+                      unsigned int index,
+                      struct uv__timer_dheap_entry entry) {
+  dheap->entries[index] = entry;
+  entry.handle->heap_node[0] = (void*) (uintptr_t) index;
+}
+
+
+static void dheap_sift_up(struct uv__timer_dheap* dheap,
+                          unsigned int index,
+                          struct uv__timer_dheap_entry entry) {
+  unsigned int parent;
+
+  while (index > 0) {
+    parent = (index - 1) / DHEAP_ARITY;
+    if (!dheap_less_than(&entry, dheap->entries + parent))
+      break;
+    dheap_set(dheap, index, dheap->entries[parent]);
+    index = parent;
+  }
+
+  dheap_set(dheap, index, entry);
+}
+
+
+static void dheap_sift_down(struct uv__timer_dheap* dheap,
+                            unsigned int index,
+                            struct uv__timer_dheap_entry entry) {
+  unsigned int child;
+  unsigned int least;
+  unsigned int end;
+
+  for (;;) {
+    child = index * DHEAP_ARITY + 1;
+    if (child >= dheap->nelts)
+      break;
+
+    end = child + DHEAP_ARITY;
+    if (end > dheap->nelts)
+      end = dheap->nelts;
+
+    for (least = child++; child < end; child++)
+      if (dheap_less_than(dheap->entries + child, dheap->entries + least))
+        least = child;
+
+    if (!dheap_less_than(dheap->entries + least, &entry))
+      break;
+
+    dheap_set(dheap, index, dheap->entries[least]);
+    index = least;
+  }
+
+  dheap_set(dheap, index, entry);
+}
+
+
+static int dheap_insert(struct uv__timer_dheap* dheap, uv_timer_t* handle) {
+  struct uv__timer_dheap_entry* entries;
+  struct uv__timer_dheap_entry entry;
+  unsigned int size;
+
+  if (dheap->nelts == dheap->size) {
+    size = dheap->size == 0 ? 64 : 2 * dheap->size;
+    entries = (struct uv__timer_dheap_entry*)
+        uv__realloc(dheap->entries, size * sizeof(*entries));
+    if (entries == NULL)
+      return UV_ENOMEM;
+    dheap->entries = entries;
+    dheap->size = size;
+  }
+
+  entry.timeout = handle->timeout;
+  entry.start_id = handle->start_id;
+  entry.handle = handle;
+  dheap_sift_up(dheap, dheap->nelts++, entry);
+
+  return 0;
+}
+
+
+static void dheap_remove(struct uv__timer_dheap* dheap, uv_timer_t* handle) {
+  struct uv__timer_dheap_entry last;
+  unsigned int index;
+  unsigned int parent;
+
+  index = (unsigned int) (uintptr_t) handle->heap_node[0];
+  last = dheap->entries[--dheap->nelts];
+  if (index == dheap->nelts)
+    return;
+
+  parent = (index - 1) / DHEAP_ARITY;
+  if (index > 0 && dheap_less_than(&last, dheap->entries + parent))
+    dheap_sift_up(dheap, index, last);
+  else
+    dheap_sift_down(dheap, index, last);
+}
+
+
+static int timers_active(const uv_loop_t* loop) {
+  return heap_min(timer_heap(loop)) != NULL ||
+         heap_min(slack_heap(loop)) != NULL;
+}
+
+
+int uv__timer_dheap_init(uv_loop_t* loop) {
+  struct uv__timer_dheap* dheap;
+
+  if (timer_dheap(loop) != NULL)
+    return 0;
+
+  if (timer_wheel(loop) != NULL)
+    return UV_EINVAL;
+
+  if (timers_active(loop))
+    return UV_EBUSY;
+
+  dheap = (struct uv__timer_dheap*) uv__calloc(1, sizeof(*dheap));
+  if (dheap == NULL)
+    return UV_ENOMEM;
+
+  uv__get_internal_fields(loop)->timer_dheap = dheap;
+  return 0;
+}
+
+
+int uv__timer_wheel_init(uv_loop_t* loop) {
+  struct uv__timer_wheel* wheel;
+  unsigned int i;
+
+  if (timer_wheel(loop) != NULL)
+    return 0;
+
+  if (timer_dheap(loop) != NULL)
+    return UV_EINVAL;
+
+  if (timers_active(loop))
+    return UV_EBUSY;
+
+  wheel = (struct uv__timer_wheel*) uv__malloc(sizeof(*wheel));
+  if (wheel == NULL)
+    return UV_ENOMEM;
+
+  wheel->now = loop->time;
+  for (i = 0; i < WHEEL_LEVELS; i++)
+    wheel->occupied[i] = 0;
+  for (i = 0; i < ARRAY_SIZE(wheel->slots); i++)
+    uv__queue_init(wheel->slots + i);
+
+  uv__get_internal_fields(loop)->timer_wheel = wheel;
+  return 0;
+}
+
+
+void uv__timer_loop_close(uv_loop_t* loop) {
+  uv__loop_internal_fields_t* lfields;
+
+  lfields = uv__get_internal_fields(loop);
+  uv__free(lfields->timer_wheel);
+  lfields->timer_wheel = NULL;
+
+  if (lfields->timer_dheap != NULL) {
+    uv__free(lfields->timer_dheap->entries);
+    uv__free(lfields->timer_dheap);
+    lfields->timer_dheap = NULL;
+  }
+}
+
+
+/* Orders the timers with slack by the latest time they may run. */
+static int deadline_less_than(const struct heap_node* ha,
+                              const struct heap_node* hb) {
+  const uv_timer_t* a;
+  const uv_timer_t* b;
+
+  a = container_of(ha, uv_timer_t, deadline_node);
+  b = container_of(hb, uv_timer_t, deadline_node);
+
+  if (timer_deadline(a) < timer_deadline(b))
+    return 1;
+  if (timer_deadline(b) < timer_deadline(a))
+    return 0;
+
+  return a->start_id < b->start_id;
+}
+
+
 int uv_timer_init(uv_loop_t* loop, uv_timer_t* handle) {
   uv__handle_init(loop, (uv_handle_t*)handle, UV_TIMER);
   handle->timer_cb = NULL;
   handle->timeout = 0;
   handle->repeat = 0;
+  handle->slack = 0;
   return 0;
 }
 
@@ -68,7 +459,19 @@ int uv_timer_start(uv_timer_t* handle,
                    uv_timer_cb cb,
                    uint64_t timeout,
                    uint64_t repeat) {
+  return uv_timer_start_ex(handle, cb, timeout, repeat, 0);
+}
+
+
+int uv_timer_start_ex(uv_timer_t* handle,
+                      uv_timer_cb cb,
+                      uint64_t timeout,
+                      uint64_t repeat,
+                      uint64_t slack) {
+  struct uv__timer_wheel* wheel;
+  struct uv__timer_dheap* dheap;
   uint64_t clamped_timeout;
+  int err;
 
   if (uv__is_closing(handle) || cb == NULL)
     return UV_EINVAL;
@@ -83,12 +486,34 @@ int uv_timer_start(uv_timer_t* handle,
   handle->timer_cb = cb;
   handle->timeout = clamped_timeout;
   handle->repeat = repeat;
+  handle->slack = slack;
   /* start_id is the second index to be compared in timer_less_than() */
   handle->start_id = handle->loop->timer_counter++;
 
-  heap_insert(timer_heap(handle->loop),
-              (struct heap_node*) &handle->heap_node,
-              timer_less_than);
+  if (slack != 0) {
+    heap_insert(slack_heap(handle->loop),
+                (struct heap_node*) &handle->heap_node,
+                timer_less_than);
+    heap_insert(deadline_heap(handle->loop),
+                (struct heap_node*) &handle->deadline_node,
+                deadline_less_than);
+    uv__handle_start(handle);
+    return 0;
+  }
+
+  wheel = timer_wheel(handle->loop);
+  dheap = timer_dheap(handle->loop);
+  if (wheel != NULL) {
+    wheel_insert(wheel, handle);
+  } else if (dheap != NULL) {
+    err = dheap_insert(dheap, handle);
+    if (err)
+      return err;
+  } else {
+    heap_insert(timer_heap(handle->loop),
+                (struct heap_node*) &handle->heap_node,
+                timer_less_than);
+  }
   uv__handle_start(handle);
 
   return 0;
@@ -96,12 +521,33 @@ int uv_timer_start(uv_timer_t* handle,
 
 
 int uv_timer_stop(uv_timer_t* handle) {
+  struct uv__timer_wheel* wheel;
+  struct uv__timer_dheap* dheap;
+
   if (!uv__is_active(handle))
     return 0;
 
-  heap_remove(timer_heap(handle->loop),
-              (struct heap_node*) &handle->heap_node,
-              timer_less_than);
+  if (handle->slack != 0) {
+    heap_remove(slack_heap(handle->loop),
+                (struct heap_node*) &handle->heap_node,
+                timer_less_than);
+    heap_remove(deadline_heap(handle->loop),
+                (struct heap_node*) &handle->deadline_node,
+                deadline_less_than);
+    uv__handle_stop(handle);
+    return 0;
+  }
+
+  wheel = timer_wheel(handle->loop);
+  dheap = timer_dheap(handle->loop);
+  if (wheel != NULL)
+    wheel_remove(wheel, handle);
+  else if (dheap != NULL)
+    dheap_remove(dheap, handle);
+  else
+    heap_remove(timer_heap(handle->loop),
+                (struct heap_node*) &handle->heap_node,
+                timer_less_than);
   uv__handle_stop(handle);
 
   return 0;
@@ -114,7 +560,11 @@ int uv_timer_again(uv_timer_t* handle) {
 
   if (handle->repeat) {
     uv_timer_stop(handle);
-    uv_timer_start(handle, handle->timer_cb, handle->repeat, handle->repeat);
+    uv_timer_start_ex(handle,
+                      handle->timer_cb,
+                      handle->repeat,
+                      handle->repeat,
+                      handle->slack);
   }
 
   return 0;
@@ -139,20 +589,60 @@ uint64_t uv_timer_get_due_in(const uv_timer_t* handle) {
 }
 
 
-int uv__next_timeout(const uv_loop_t* loop) {
+/* Returns the earliest time the loop has to wake up for a timer, or
+ * UINT64_MAX if there are no timers. Timers with slack only need to run by
+ * their deadline.
+ */
+static uint64_t next_wakeup(const uv_loop_t* loop) {
   const struct heap_node* heap_node;
   const uv_timer_t* handle;
+  struct uv__timer_wheel* wheel;
+  struct uv__timer_dheap* dheap;
+  uint64_t wakeup;
+
+  wheel = timer_wheel(loop);
+  dheap = timer_dheap(loop);
+  if (wheel != NULL) {
+    /* Waking up early for a slot on an upper level is harmless, the timers
+     * in it are cascaded down and we go back to sleep.
+     */
+    wakeup = wheel_next(wheel);
+  } else if (dheap != NULL) {
+    wakeup = (uint64_t) -1;
+    if (dheap->nelts > 0)
+      wakeup = dheap->entries[0].timeout;
+  } else {
+    wakeup = (uint64_t) -1;
+    heap_node = heap_min(timer_heap(loop));
+    if (heap_node != NULL) {
+      handle = container_of(heap_node, uv_timer_t, heap_node);
+      wakeup = handle->timeout;
+    }
+  }
+
+  heap_node = heap_min(deadline_heap(loop));
+  if (heap_node != NULL) {
+    handle = container_of(heap_node, uv_timer_t, deadline_node);
+    if (timer_deadline(handle) < wakeup)
+      wakeup = timer_deadline(handle);
+  }
+
+  return wakeup;
+}
+
+
+int uv__next_timeout(const uv_loop_t* loop) {
+  uint64_t timeout;
   uint64_t diff;
 
-  heap_node = heap_min(timer_heap(loop));
-  if (heap_node == NULL)
+  timeout = next_wakeup(loop);
+  if (timeout == (uint64_t) -1)
     return -1; /* block indefinitely */
 
-  handle = container_of(heap_node, uv_timer_t, heap_node);
-  if (handle->timeout <= loop->time)
+  if (timeout <= loop->time)
     return 0;
 
-  diff = handle->timeout - loop->time;
+  diff = timeout - loop->time;
   if (diff > INT_MAX)
     diff = INT_MAX;
 
@@ -160,17 +650,75 @@ int uv__next_timeout(const uv_loop_t* loop) {
 }
 
 
-void uv__run_timers(uv_loop_t* loop) {
+/* Returns the next timer without slack that is due, or NULL. */
+static uv_timer_t* next_due_timer(uv_loop_t* loop) {
+  struct uv__timer_wheel* wheel;
+  struct uv__timer_dheap* dheap;
   struct heap_node* heap_node;
+  struct uv__queue* slot;
   uv_timer_t* handle;
+  uint64_t next;
 
-  for (;;) {
+  dheap = timer_dheap(loop);
+  if (dheap != NULL) {
+    if (dheap->nelts == 0 || dheap->entries[0].timeout > loop->time)
+      return NULL;
+
+    return dheap->entries[0].handle;
+  }
+
+  wheel = timer_wheel(loop);
+  if (wheel == NULL) {
     heap_node = heap_min(timer_heap(loop));
     if (heap_node == NULL)
-      break;
+      return NULL;
 
     handle = container_of(heap_node, uv_timer_t, heap_node);
     if (handle->timeout > loop->time)
+      return NULL;
+
+    return handle;
+  }
+
+  for (;;) {
+    slot = wheel->slots + (wheel->now & WHEEL_MASK);
+    if (!uv__queue_empty(slot))
+      return uv__queue_data(uv__queue_head(slot), uv_timer_t, heap_node);
+
+    if (wheel->now >= loop->time)
+      return NULL;
+
+    next = wheel_next(wheel);
+    if (next > loop->time)
+      next = loop->time;
+
+    wheel_advance(wheel, next);
+  }
+}
+
+
+/* Runs every timer that is due, including timers with slack whose window
+ * has opened, in (timeout, start_id) order.
+ */
+void uv__run_timers(uv_loop_t* loop) {
+  struct heap_node* heap_node;
+  uv_timer_t* handle;
+  uv_timer_t* slack;
+
+  for (;;) {
+    handle = next_due_timer(loop);
+
+    heap_node = heap_min(slack_heap(loop));
+    if (heap_node != NULL) {
+      slack = container_of(heap_node, uv_timer_t, heap_node);
+      if (slack->timeout <= loop->time)
+        if (handle == NULL ||
+            timer_less_than(heap_node,
+                            (struct heap_node*) &handle->heap_node))
+          handle = slack;
+    }
+
+    if (handle == NULL)
       break;
 
     uv_timer_stop(handle);
@@ -42,6 +42,88 @@ static void uv__async_send(uv_loop_t* loop);
 static int uv__async_start(uv_loop_t* loop);
 static void uv__cpu_relax(void);
 
+/* Values of lfields->async_state. A sleeping loop is blocked in, or about to
+ * enter, uv__io_poll() and only notices new ready handles when the eventfd is
+ * written. An awake loop looks at the ready list before it blocks again, so
+ * uv_async_send() can skip the write() syscall.
+ */
+enum {
+  UV__ASYNC_SLEEPING = 0,
+  UV__ASYNC_AWAKE = 1
+};
+
+
+/* Signalled handles are pushed onto the loop's ready list, a lock-free stack,
+ * by the thread that sets their pending flag. That flag keeps a handle from
+ * being on the list more than once. The loop thread takes the whole list and
+ * dispatches only those handles, instead of scanning all of them.
+ *
+ * Returns non-zero if the list was empty, i.e. the loop needs a wakeup.
+ */
+static int uv__async_push(uv_async_t* handle) {
+  uv__loop_internal_fields_t* lfields;
+  _Atomic(uv_async_t*)* ready;
+  uv_async_t* head;
+
+  lfields = uv__get_internal_fields(handle->loop);
+  ready = (_Atomic(uv_async_t*)*) &lfields->async_ready;
+  head = atomic_load_explicit(ready, memory_order_relaxed);
+
+  /* Sequentially consistent, pairs with uv__async_block(). */
+  do
+    handle->ready_next = head;
+  while (!atomic_compare_exchange_weak(ready, &head, handle));
+
+  return head == NULL;
+}
+
+
+/* Moves the ready list to the end of the taken list, in the order in which
+ * the handles were signalled. Only call this from the event loop thread.
+ */
+static void uv__async_take(uv_loop_t* loop) {
+  uv__loop_internal_fields_t* lfields;
+  _Atomic(uv_async_t*)* ready;
+  uv_async_t* list;
+  uv_async_t* next;
+  uv_async_t* h;
+  uv_async_t** tail;
+
+  lfields = uv__get_internal_fields(loop);
+  ready = (_Atomic(uv_async_t*)*) &lfields->async_ready;
+
+  h = atomic_exchange_explicit(ready, NULL, memory_order_acquire);
+  if (h == NULL)
+    return;
+
+  /* Reverse, it's a stack. */
+  list = NULL;
+  for (; h != NULL; h = next) {
+    next = h->ready_next;
+    h->ready_next = list;
+    list = h;
+  }
+
+  tail = (uv_async_t**) &lfields->async_taken;
+  while (*tail != NULL)
+    tail = &(*tail)->ready_next;
+
+  *tail = list;
+}
+
+
+/* Returns non-zero if handles await dispatch, either on the ready list or on
+ * the taken list, where uv__async_close() moves them. A sender that found the
+ * loop awake did not write the eventfd for either. Only call this from the
+ * event loop thread.
+ */
+static int uv__async_pending(uv__loop_internal_fields_t* lfields) {
+  if (lfields->async_taken != NULL)
+    return 1;
+
+  return atomic_load((_Atomic(void*)*) &lfields->async_ready) != NULL;
+}
+
 
 int uv_async_init(uv_loop_t* loop, uv_async_t* handle, uv_async_cb async_cb) {
   int err;
@@ -65,9 +147,11 @@ int uv_async_init(uv_loop_t* loop, uv_async_t* handle, uv_async_cb async_cb) {
 int uv_async_send(uv_async_t* handle) {
   _Atomic int* pending;
   _Atomic int* busy;
+  _Atomic int* state;
 
   pending = (_Atomic int*) &handle->pending;
   busy = (_Atomic int*) &handle->u.fd;
+  state = (_Atomic int*) &uv__get_internal_fields(handle->loop)->async_state;
 
   /* Do a cheap read first. */
   if (atomic_load_explicit(pending, memory_order_relaxed) != 0)
@@ -76,9 +160,13 @@ int uv_async_send(uv_async_t* handle) {
   /* Set the loop to busy. */
   atomic_fetch_add(busy, 1);
 
-  /* Wake up the other thread's event loop. */
+  /* Wake up the other thread's event loop, unless a wakeup is due already
+   * or the loop is awake and will see the handle before it blocks.
+   */
   if (atomic_exchange(pending, 1) == 0)
-    uv__async_send(handle->loop);
+    if (uv__async_push(handle))
+      if (atomic_load(state) == UV__ASYNC_SLEEPING)
+        uv__async_send(handle->loop);
 
   /* Set the loop to not-busy. */
   atomic_fetch_add(busy, -1);
@@ -87,11 +175,65 @@ int uv_async_send(uv_async_t* handle) {
 }
 
 
-/* Wait for the busy flag to clear before closing.
- * Only call this from the event loop thread. */
-static void uv__async_spin(uv_async_t* handle) {
+/* Called by uv_run() right before uv__io_poll(), and by uv__io_poll() before
+ * it blocks again after running callbacks. Returns non-zero if handles were
+ * signalled while the loop was awake and have not been dispatched yet, in
+ * which case the loop must not block: the async watcher has been fed instead,
+ * so the handles are dispatched without reading the eventfd.
+ */
+int uv__async_block(uv_loop_t* loop) {
+  uv__loop_internal_fields_t* lfields;
+  _Atomic int* state;
+
+  lfields = uv__get_internal_fields(loop);
+  state = (_Atomic int*) &lfields->async_state;
+
+  /* Either a sender sees this store and writes the eventfd, or we see its
+   * push below. Both are sequentially consistent.
+   */
+  atomic_store(state, UV__ASYNC_SLEEPING);
+  if (!uv__async_pending(lfields))
+    return 0;
+
+  atomic_store_explicit(state, UV__ASYNC_AWAKE, memory_order_relaxed);
+  uv__io_feed(loop, &loop->async_io_watcher);
+
+  return 1;
+}
+
+
+/* Called by uv_run() after uv__io_poll() returns. The epoll and kqueue
+ * backends call it as soon as the kernel reports events, so that senders
+ * skip the write while the callbacks run as well.
+ */
+void uv__async_wake(uv_loop_t* loop) {
+  _Atomic int* state;
+
+  state = (_Atomic int*) &uv__get_internal_fields(loop)->async_state;
+  atomic_store_explicit(state, UV__ASYNC_AWAKE, memory_order_relaxed);
+}
+
+
+/* Called when uv_run() returns. Whoever polls the loop next, uv_run() or an
+ * embedder waiting on uv_backend_fd(), relies on the eventfd.
+ */
+void uv__async_park(uv_loop_t* loop) {
+  uv__loop_internal_fields_t* lfields;
+
+  lfields = uv__get_internal_fields(loop);
+  atomic_store((_Atomic int*) &lfields->async_state, UV__ASYNC_SLEEPING);
+
+  if (uv__async_pending(lfields))
+    uv__async_send(loop);
+}
+
+
+/* Wait for the busy flag to clear before closing. Returns the previous value
+ * of the pending flag. Only call this from the event loop thread. */
+static int uv__async_spin(uv_async_t* handle) {
   _Atomic int* pending;
   _Atomic int* busy;
+  int was_pending;
   int i;
 
   pending = (_Atomic int*) &handle->pending;
@@ -99,7 +241,7 @@ static void uv__async_spin(uv_async_t* handle) {
 
   /* Set the pending flag first, so no new events will be added by other
    * threads after this function returns. */
-  atomic_store(pending, 1);
+  was_pending = atomic_exchange(pending, 1);
 
   for (;;) {
     /* 997 is not completely chosen at random. It's a prime number, acyclic by
@@ -107,7 +249,7 @@ static void uv__async_spin(uv_async_t* handle) {
      */
     for (i = 0; i < 997; i++) {
       if (atomic_load(busy) == 0)
-        return;
+        return was_pending;
 
       /* Other thread is busy with this handle, spin until it's done. */
       uv__cpu_relax();
@@ -123,23 +265,54 @@ static void uv__async_spin(uv_async_t* handle) {
 
 
 void uv__async_close(uv_async_t* handle) {
-  uv__async_spin(handle);
+  /* A pending handle is on the ready list, or about to be pushed by a thread
+   * that uv__async_spin() waits for. Move it to the taken list, where
+   * uv__async_io() skips it and uv__async_finish_close() removes it.
+   */
+  if (uv__async_spin(handle)) {
+    uv__async_take(handle->loop);
+    uv__get_internal_fields(handle->loop)->async_closed++;
+  }
+
   uv__queue_remove(&handle->queue);
   uv__handle_stop(handle);
 }
 
 
+/* Called before the close callback, which may free the handle. Removes all
+ * closed handles from the taken list in one go.
+ */
+void uv__async_finish_close(uv_async_t* handle) {
+  uv__loop_internal_fields_t* lfields;
+  uv_async_t** p;
+
+  lfields = uv__get_internal_fields(handle->loop);
+  if (lfields->async_closed == 0)
+    return;
+
+  p = (uv_async_t**) &lfields->async_taken;
+  while (*p != NULL) {
+    if (uv__is_closing(*p))
+      *p = (*p)->ready_next;
+    else
+      p = &(*p)->ready_next;
+  }
+
+  lfields->async_closed = 0;
+}
+
+
 static void uv__async_io(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
+  uv__loop_internal_fields_t* lfields;
   char buf[1024];
   ssize_t r;
-  struct uv__queue queue;
-  struct uv__queue* q;
   uv_async_t* h;
   _Atomic int *pending;
 
   assert(w == &loop->async_io_watcher);
 
-  for (;;) {
+  /* There's nothing to read when uv__async_block() fed the watcher. */
+  while (events & POLLIN) {
     r = read(w->fd, buf, sizeof(buf));
 
     if (r == sizeof(buf))
@@ -157,15 +330,20 @@ static void uv__async_io(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
     abort();
   }
 
-  uv__queue_move(&loop->async_handles, &queue);
-  while (!uv__queue_empty(&queue)) {
-    q = uv__queue_head(&queue);
-    h = uv__queue_data(q, uv_async_t, queue);
+  /* Handles signalled from here on wake up the loop again. */
+  uv__async_take(loop);
 
-    uv__queue_remove(q);
-    uv__queue_insert_tail(&loop->async_handles, q);
+  lfields = uv__get_internal_fields(loop);
+  while (lfields->async_taken != NULL) {
+    h = (uv_async_t*) lfields->async_taken;
+    lfields->async_taken = h->ready_next;
 
-    /* Atomically fetch and clear pending flag */
+    if (uv__is_closing(h))
+      continue;
+
+    /* Atomically fetch and clear pending flag. The handle can be signalled
+     * and pushed again from here on.
+     */
     pending = (_Atomic int*) &h->pending;
     if (atomic_exchange(pending, 0) == 0)
       continue;
@@ -262,6 +440,11 @@ void uv__async_stop(uv_loop_t* loop) {
     uv__async_spin(h);
   }
 
+  uv__get_internal_fields(loop)->async_ready = NULL;
+  uv__get_internal_fields(loop)->async_taken = NULL;
+  uv__get_internal_fields(loop)->async_closed = 0;
+  uv__get_internal_fields(loop)->async_state = UV__ASYNC_SLEEPING;
+
   if (loop->async_wfd != -1) {
     if (loop->async_wfd != loop->async_io_watcher.fd)
       uv__close(loop->async_wfd);
@@ -301,6 +484,11 @@ int uv__async_fork(uv_loop_t* loop) {
     h->u.fd = 0;
   }
 
+  uv__get_internal_fields(loop)->async_ready = NULL;
+  uv__get_internal_fields(loop)->async_taken = NULL;
+  uv__get_internal_fields(loop)->async_closed = 0;
+  uv__get_internal_fields(loop)->async_state = UV__ASYNC_SLEEPING;
+
   /* Recreate these, since they still exist, but belong to the wrong pid now. */
   if (loop->async_wfd != -1) {
     if (loop->async_wfd != loop->async_io_watcher.fd)
@@ -112,6 +112,7 @@ extern char** environ;
 #endif
 
 static void uv__run_pending(uv_loop_t* loop);
+static void uv__read_budget_next(uv_loop_t* loop);
 
 /* Verify that uv_buf_t is ABI-compatible with struct iovec. */
 STATIC_ASSERT(sizeof(uv_buf_t) == sizeof(struct iovec));
@@ -227,6 +228,12 @@ void uv_close(uv_handle_t* handle, uv_close_cb close_cb) {
      * running. The poll code will call uv__make_close_pending() for us. */
     return;
 
+  case UV_CHANNEL:
+    uv__channel_close((uv_channel_t*)handle);
+    /* Channels close their internal async handle first. The channel code
+     * will call uv__make_close_pending() for us. */
+    return;
+
   case UV_SIGNAL:
     uv__signal_close((uv_signal_t*) handle);
     break;
@@ -317,15 +324,21 @@ static void uv__finish_close(uv_handle_t* handle) {
   handle->flags |= UV_HANDLE_CLOSED;
 
   switch (handle->type) {
+    case UV_ASYNC:
+#ifndef __VMS
+      uv__async_finish_close((uv_async_t*) handle);
+#endif
+      break;
+
     case UV_PREPARE:
     case UV_CHECK:
     case UV_IDLE:
-    case UV_ASYNC:
     case UV_TIMER:
     case UV_PROCESS:
     case UV_FS_EVENT:
     case UV_FS_POLL:
     case UV_POLL:
+    case UV_CHANNEL:
       break;
 
     case UV_SIGNAL:
@@ -345,6 +358,16 @@ static void uv__finish_close(uv_handle_t* handle) {
     case UV_NAMED_PIPE:
     case UV_TCP:
     case UV_TTY:
+#if defined(__linux__)
+      /* Like signals above, wait for the io_uring reads and writes of the
+       * stream to finish cancelling. The kernel still references its memory.
+       */
+      if (((uv_stream_t*) handle)->iou_flags & UV__IOU_STREAM_IN_FLIGHT) {
+        handle->flags ^= UV_HANDLE_CLOSED;
+        uv__make_close_pending(handle);  /* Back into the queue. */
+        return;
+      }
+#endif
       uv__stream_destroy((uv_stream_t*)handle);
       break;
 
@@ -404,6 +427,7 @@ static int uv__backend_timeout(const uv_loop_t* loop) {
       /* uv__loop_alive(loop) && */
       (uv__has_active_handles(loop) || uv__has_active_reqs(loop)) &&
       uv__queue_empty(&loop->pending_queue) &&
+      uv__queue_empty(&uv__get_internal_fields(loop)->read_budget.next) &&
       uv__queue_empty(&loop->idle_handles) &&
       (loop->flags & UV_LOOP_REAP_CHILDREN) == 0 &&
       loop->closing_handles == NULL)
@@ -444,6 +468,8 @@ int uv_run(uv_loop_t* loop, uv_run_mode mode) {
   }
 
   while (r != 0 && loop->stop_flag == 0) {
+    uv__read_budget_next(loop);
+
     can_sleep =
         uv__queue_empty(&loop->pending_queue) &&
         uv__queue_empty(&loop->idle_handles);
@@ -458,8 +484,18 @@ int uv_run(uv_loop_t* loop, uv_run_mode mode) {
 
     uv__metrics_inc_loop_count(loop);
 
+#ifndef __VMS
+    /* Don't block if handles were signalled while the loop was awake. */
+    if (uv__async_block(loop))
+      timeout = 0;
+#endif
+
     uv__io_poll(loop, timeout);
 
+#ifndef __VMS
+    uv__async_wake(loop);
+#endif
+
     /* Process immediate callbacks (e.g. write_cb) a small fixed number of
      * times to avoid loop starvation.*/
     for (r = 0; r < 8 && !uv__queue_empty(&loop->pending_queue); r++)
@@ -489,6 +525,10 @@ int uv_run(uv_loop_t* loop, uv_run_mode mode) {
   if (loop->stop_flag != 0)
     loop->stop_flag = 0;
 
+#ifndef __VMS
+  uv__async_park(loop);
+#endif
+
   return r;
 }
 
@@ -540,6 +580,24 @@ int uv__socket(int domain, int type, int protocol) {
   return sockfd;
 }
 
+/* Linux's SO_REUSEPORT balances the load over the sockets, the BSDs' only
+ * lets the last one bind, see uv__set_reuse() in udp.c.
+ */
+int uv__sock_reuseport(int fd) {
+#if defined(__linux__) && defined(SO_REUSEPORT)
+  int on;
+
+  on = 1;
+  if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)))
+    return UV__ERR(errno);
+
+  return 0;
+#else
+  (void) fd;
+  return UV_ENOTSUP;
+#endif
+}
+
 /* get a file pointer to a file in read-only and close-on-exec mode */
 FILE* uv__open_file(const char* path) {
   int fd;
@@ -844,6 +902,25 @@ int uv_fileno(const uv_handle_t* handle, uv_os_fd_t* fd) {
 }
 
 
+/* Streams that used up their UV_LOOP_READ_BUDGET in the previous loop
+ * iteration go first in this one, see uv__read().
+ */
+static void uv__read_budget_next(uv_loop_t* loop) {
+  uv__loop_internal_fields_t* lfields;
+  struct uv__queue* next;
+
+  lfields = uv__get_internal_fields(loop);
+  lfields->read_budget.tick++;
+
+  next = &lfields->read_budget.next;
+  if (uv__queue_empty(next))
+    return;
+
+  uv__queue_add(&loop->pending_queue, next);
+  uv__queue_init(next);
+}
+
+
 static void uv__run_pending(uv_loop_t* loop) {
   struct uv__queue* q;
   struct uv__queue pq;
@@ -920,6 +997,8 @@ void uv__io_init(uv__io_t* w, uv__io_cb cb, int fd) {
 
 
 void uv__io_start(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
+  uv__io_t* old;
+
   assert(0 == (events & ~(POLLIN | POLLOUT | UV__POLLRDHUP | UV__POLLPRI)));
   assert(0 != events);
   assert(w->fd >= 0);
@@ -928,6 +1007,30 @@ void uv__io_start(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
   w->pevents |= events;
   maybe_resize(loop, w->fd + 1);
 
+  /* Edge-triggered watchers are registered once, for everything, and stay
+   * registered until they're closed. Starting and stopping them only changes
+   * what is passed on to the callback. The kernel doesn't report readiness
+   * twice, feed the watcher if it's still there from before.
+   */
+  if ((w->events & UV__POLLET) && loop->watchers[w->fd] == w) {
+    if (uv__io_ready(w) & events)
+      uv__io_feed(loop, w);
+    return;
+  }
+
+  /* A stopped edge-triggered watcher of another handle for the same file
+   * descriptor makes room.
+   */
+  old = loop->watchers[w->fd];
+  if (old != NULL && old != w && (old->events & UV__POLLET)) {
+    assert(old->pevents == 0);
+    uv__queue_remove(&old->watcher_queue);
+    uv__queue_init(&old->watcher_queue);
+    old->events = 0;
+    loop->watchers[w->fd] = NULL;
+    loop->nfds--;
+  }
+
 #if !defined(__sun)
   /* The event ports backend needs to rearm all file descriptors on each and
    * every tick of the event loop but the other backends allow us to
@@ -962,6 +1065,10 @@ void uv__io_stop(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
 
   w->pevents &= ~events;
 
+  /* Stays registered, see uv__io_start(). */
+  if (w->events & UV__POLLET)
+    return;
+
   if (w->pevents == 0) {
     uv__queue_remove(&w->watcher_queue);
     uv__queue_init(&w->watcher_queue);
@@ -982,6 +1089,18 @@ void uv__io_close(uv_loop_t* loop, uv__io_t* w) {
   uv__io_stop(loop, w, POLLIN | POLLOUT | UV__POLLRDHUP | UV__POLLPRI);
   uv__queue_remove(&w->pending_queue);
 
+  if (w->events & UV__POLLET) {
+    uv__queue_remove(&w->watcher_queue);
+    uv__queue_init(&w->watcher_queue);
+    w->events = 0;
+
+    if (w->fd != -1 && w == loop->watchers[w->fd]) {
+      assert(loop->nfds > 0);
+      loop->watchers[w->fd] = NULL;
+      loop->nfds--;
+    }
+  }
+
   /* Remove stale events for this file descriptor */
   if (w->fd != -1)
     uv__platform_invalidate_fd(loop, w->fd);
@@ -994,6 +1113,35 @@ void uv__io_feed(uv_loop_t* loop, uv__io_t* w) {
 }
 
 
+/* Returns the POLLIN and POLLOUT readiness that an edge-triggered watcher has
+ * been told about and that hasn't been used up yet. Always 0 for other
+ * watchers. A hangup stays, it makes reads and writes return right away.
+ */
+unsigned int uv__io_ready(const uv__io_t* w) {
+  unsigned int ready;
+
+  if (!(w->events & UV__POLLET))
+    return 0;
+
+  ready = w->events & (POLLIN | POLLOUT);
+  if (w->events & UV__POLLRDHUP)
+    ready |= POLLIN;
+  if (w->events & POLLHUP)
+    ready |= POLLIN | POLLOUT;
+
+  return ready;
+}
+
+
+/* A read or write came up short: the kernel reports it when the file
+ * descriptor becomes ready again.
+ */
+void uv__io_drained(uv__io_t* w, unsigned int events) {
+  if (w->events & UV__POLLET)
+    w->events &= ~events;
+}
+
+
 int uv__io_active(const uv__io_t* w, unsigned int events) {
   assert(0 == (events & ~(POLLIN | POLLOUT | UV__POLLRDHUP | UV__POLLPRI)));
   assert(0 != events);
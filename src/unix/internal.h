@@ -148,6 +148,22 @@ union uv__sockaddr {
 # define UV__POLLPRI 0
 #endif
 
+/* Marks edge-triggered watchers, see uv__io_start(). Same as EPOLLET. */
+#if defined(__linux__)
+# define UV__POLLET 0x80000000u
+#else
+# define UV__POLLET 0
+#endif
+
+#if defined(__linux__)
+# ifndef SO_ZEROCOPY
+#  define SO_ZEROCOPY 60
+# endif
+# ifndef MSG_ZEROCOPY
+#  define MSG_ZEROCOPY 0x4000000
+# endif
+#endif
+
 #if !defined(O_CLOEXEC) && defined(__FreeBSD__)
 /*
  * It may be that we are just missing `__POSIX_VISIBLE >= 200809`.
@@ -161,7 +177,9 @@ typedef struct uv__stream_queued_fds_s uv__stream_queued_fds_t;
 /* loop flags */
 enum {
   UV_LOOP_BLOCK_SIGPROF = 0x1,
-  UV_LOOP_REAP_CHILDREN = 0x2
+  UV_LOOP_REAP_CHILDREN = 0x2,
+  UV_LOOP_IOU_STREAMS = 0x4,
+  UV_LOOP_EDGE_TRIGGERED_IO = 0x8
 };
 
 /* flags of excluding ifaddr */
@@ -251,6 +269,7 @@ int uv__close(int fd); /* preserves errno */
 int uv__close_nocheckstdio(int fd);
 int uv__close_nocancel(int fd);
 int uv__socket(int domain, int type, int protocol);
+int uv__sock_reuseport(int fd);
 ssize_t uv__recvmsg(int fd, struct msghdr *msg, int flags);
 void uv__make_close_pending(uv_handle_t* handle);
 int uv__getiovmax(void);
@@ -260,6 +279,8 @@ void uv__io_start(uv_loop_t* loop, uv__io_t* w, unsigned int events);
 void uv__io_stop(uv_loop_t* loop, uv__io_t* w, unsigned int events);
 void uv__io_close(uv_loop_t* loop, uv__io_t* w);
 void uv__io_feed(uv_loop_t* loop, uv__io_t* w);
+unsigned int uv__io_ready(const uv__io_t* w);
+void uv__io_drained(uv__io_t* w, unsigned int events);
 int uv__io_active(const uv__io_t* w, unsigned int events);
 int uv__io_check_fd(uv_loop_t* loop, int fd);
 void uv__io_poll(uv_loop_t* loop, int timeout); /* in milliseconds or -1 */
@@ -269,12 +290,21 @@ int uv__fd_exists(uv_loop_t* loop, int fd);
 /* async */
 void uv__async_stop(uv_loop_t* loop);
 int uv__async_fork(uv_loop_t* loop);
+#ifndef __VMS
+int uv__async_block(uv_loop_t* loop);
+void uv__async_wake(uv_loop_t* loop);
+void uv__async_park(uv_loop_t* loop);
+#endif
 
 
 /* loop */
 void uv__run_idle(uv_loop_t* loop);
 void uv__run_check(uv_loop_t* loop);
 void uv__run_prepare(uv_loop_t* loop);
+int uv__buf_pool_init(uv_loop_t* loop, unsigned int count, unsigned int size);
+void uv__buf_pool_get(uv_loop_t* loop, uv_buf_t* buf);
+char* uv__buf_pool_take(uv_loop_t* loop);
+int uv__buf_pool_put(uv_loop_t* loop, char* buf);
 
 /* stream */
 void uv__stream_init(uv_loop_t* loop, uv_stream_t* stream,
@@ -294,6 +324,7 @@ int uv__slurp(const char* filename, char* buf, size_t len);
 int uv__tcp_listen(uv_tcp_t* tcp, int backlog, uv_connection_cb cb);
 int uv__tcp_nodelay(int fd, int on);
 int uv__tcp_keepalive(int fd, int on, unsigned int delay);
+int uv__tcp_zerocopy(int fd);
 
 /* pipe */
 int uv__pipe_listen(uv_pipe_t* handle, int backlog, uv_connection_cb cb);
@@ -314,6 +345,9 @@ int uv__process_init(uv_loop_t* loop);
 
 /* various */
 void uv__async_close(uv_async_t* handle);
+#ifndef __VMS
+void uv__async_finish_close(uv_async_t* handle);
+#endif
 void uv__check_close(uv_check_t* handle);
 void uv__fs_event_close(uv_fs_event_t* handle);
 void uv__idle_close(uv_idle_t* handle);
@@ -356,6 +390,46 @@ int uv__iou_fs_statx(uv_loop_t* loop,
                      int is_lstat);
 int uv__iou_fs_symlink(uv_loop_t* loop, uv_fs_t* req);
 int uv__iou_fs_unlink(uv_loop_t* loop, uv_fs_t* req);
+
+/* Stream operations in flight, and cancellations thereof, in iou_flags.
+ * Listening streams use UV__IOU_STREAM_READ for their multishot accept.
+ */
+enum {
+  UV__IOU_STREAM_READ = 1,
+  UV__IOU_STREAM_WRITE = 2,
+  UV__IOU_STREAM_READ_CANCEL = 4,
+  UV__IOU_STREAM_WRITE_CANCEL = 8,
+  UV__IOU_STREAM_ACCEPT = 16,     /* Listening stream uses io_uring. */
+  UV__IOU_STREAM_CONNECTION = 32, /* accepted_fd needs a connection_cb. */
+  UV__IOU_STREAM_RECV = 64,       /* The read is a multishot recv. */
+  UV__IOU_STREAM_LOST = 128,      /* Out of memory for data read ahead. */
+  UV__IOU_STREAM_RING = 256       /* Pooled reads use the io_uring buffers. */
+};
+
+#define UV__IOU_STREAM_IN_FLIGHT (UV__IOU_STREAM_READ | UV__IOU_STREAM_WRITE)
+
+int uv__iou_stream_init(uv_loop_t* loop);
+int uv__iou_stream_read(uv_loop_t* loop,
+                        uv_stream_t* stream,
+                        char* buf,
+                        unsigned int len);
+int uv__iou_stream_write(uv_loop_t* loop,
+                         uv_stream_t* stream,
+                         const uv_buf_t* bufs,
+                         unsigned int nbufs);
+int uv__iou_stream_accept(uv_loop_t* loop, uv_stream_t* stream);
+int uv__iou_stream_recv(uv_loop_t* loop, uv_stream_t* stream);
+void uv__iou_stream_flush(uv_loop_t* loop);
+int uv__iou_stream_cancel(uv_loop_t* loop,
+                          uv_stream_t* stream,
+                          unsigned int op);
+void uv__stream_iou_done(uv_stream_t* stream,
+                         unsigned int op,
+                         int res,
+                         int more,
+                         char* buf);
+int uv__iou_bufs_init(uv_loop_t* loop, unsigned int count, unsigned int size);
+int uv__iou_buf_put(uv_loop_t* loop, char* buf);
 #else
 #define uv__iou_fs_close(loop, req) 0
 #define uv__iou_fs_fsync_or_fdatasync(loop, req, fsync_flags) 0
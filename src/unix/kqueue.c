@@ -299,6 +299,11 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
       goto update_timeout;
     }
 
+    /* The callbacks below may signal async handles, the loop looks at them
+     * before it blocks again so their senders needn't write the pipe.
+     */
+    uv__async_wake(loop);
+
     have_signals = 0;
     nevents = 0;
 
@@ -424,6 +429,10 @@ update_timeout:
     if (timeout == 0)
       return;
 
+    /* Don't block on handles that were signalled while we were awake. */
+    if (uv__async_block(loop))
+      return;
+
     if (timeout == -1)
       continue;
 
@@ -153,9 +153,13 @@ enum {
   UV__IORING_OP_READV = 1,
   UV__IORING_OP_WRITEV = 2,
   UV__IORING_OP_FSYNC = 3,
+  UV__IORING_OP_ACCEPT = 13,
+  UV__IORING_OP_ASYNC_CANCEL = 14,
   UV__IORING_OP_OPENAT = 18,
   UV__IORING_OP_CLOSE = 19,
   UV__IORING_OP_STATX = 21,
+  UV__IORING_OP_READ = 22,
+  UV__IORING_OP_RECV = 27,
   UV__IORING_OP_EPOLL_CTL = 29,
   UV__IORING_OP_RENAMEAT = 35,
   UV__IORING_OP_UNLINKAT = 36,
@@ -164,6 +168,10 @@ enum {
   UV__IORING_OP_LINKAT = 39,
 };
 
+enum {
+  UV__IOSQE_BUFFER_SELECT = 32u,
+};
+
 enum {
   UV__IORING_ENTER_GETEVENTS = 1u,
   UV__IORING_ENTER_SQ_WAKEUP = 2u,
@@ -178,6 +186,30 @@ enum {
   UV__MKDIRAT_SYMLINKAT_LINKAT = 1u,
 };
 
+enum {
+  UV__IORING_ACCEPT_MULTISHOT = 1u,  /* linux v5.19 */
+  UV__IORING_RECV_MULTISHOT = 2u,  /* linux v6.0 */
+};
+
+enum {
+  UV__IORING_CQE_F_BUFFER = 1u,
+  UV__IORING_CQE_F_MORE = 2u,
+  UV__IORING_CQE_BUFFER_SHIFT = 16,
+};
+
+enum {
+  UV__IORING_REGISTER_PBUF_RING = 22,  /* linux v5.19 */
+};
+
+/* The user_data of stream SQEs is the stream with the operation in the low
+ * bits, see UV__IOU_STREAM_READ and UV__IOU_STREAM_WRITE. The low bits of
+ * fs requests are zero.
+ */
+enum {
+  UV__IOU_TAG_MASK = 3u,
+  UV__IOU_TAG_CANCEL = 3u,
+};
+
 struct uv__io_cqring_offsets {
   uint32_t head;
   uint32_t tail;
@@ -235,6 +267,7 @@ struct uv__io_uring_sqe {
   uint64_t user_data;
   union {
     uint16_t buf_index;
+    uint16_t buf_group;
     uint64_t pad[3];
   };
 };
@@ -251,6 +284,28 @@ STATIC_ASSERT(28 == offsetof(struct uv__io_uring_sqe, rw_flags));
 STATIC_ASSERT(32 == offsetof(struct uv__io_uring_sqe, user_data));
 STATIC_ASSERT(40 == offsetof(struct uv__io_uring_sqe, buf_index));
 
+/* The tail of a provided buffer ring overlays the resv field of its first
+ * entry.
+ */
+struct uv__io_uring_buf {
+  uint64_t addr;
+  uint32_t len;
+  uint16_t bid;
+  uint16_t resv;
+};
+
+STATIC_ASSERT(16 == sizeof(struct uv__io_uring_buf));
+
+struct uv__io_uring_buf_reg {
+  uint64_t ring_addr;
+  uint32_t ring_entries;
+  uint16_t bgid;
+  uint16_t flags;
+  uint64_t resv[3];
+};
+
+STATIC_ASSERT(40 == sizeof(struct uv__io_uring_buf_reg));
+
 struct uv__io_uring_params {
   uint32_t sq_entries;
   uint32_t cq_entries;
@@ -284,6 +339,8 @@ struct watcher_root {
 };
 
 static int uv__inotify_fork(uv_loop_t* loop, struct watcher_list* root);
+static int uv__iou_bufs_register(uv_loop_t* loop);
+static void uv__iou_bufs_delete(struct uv__iou_bufs* bufs);
 static void uv__inotify_read(uv_loop_t* loop,
                              uv__io_t* w,
                              unsigned int revents);
@@ -641,6 +698,7 @@ int uv__platform_loop_init(uv_loop_t* loop) {
   lfields = uv__get_internal_fields(loop);
   lfields->ctl.ringfd = -1;
   lfields->iou.ringfd = -1;
+  lfields->streams.ringfd = -1;
 
   loop->inotify_watchers = NULL;
   loop->inotify_fd = -1;
@@ -652,10 +710,219 @@ int uv__platform_loop_init(uv_loop_t* loop) {
   uv__iou_init(loop->backend_fd, &lfields->iou, 64, UV__IORING_SETUP_SQPOLL);
   uv__iou_init(loop->backend_fd, &lfields->ctl, 256, 0);
 
+  /* After a fork. Streams fall back to epoll if it fails. */
+  if (loop->flags & UV_LOOP_IOU_STREAMS)
+    uv__iou_stream_init(loop);
+
+  return 0;
+}
+
+
+/* Streams get a ring of their own, without a kernel thread polling it. What
+ * they submit while running callbacks is flushed in one go by uv__io_poll(),
+ * right before it blocks. Completions are reported through epoll.
+ */
+int uv__iou_stream_init(uv_loop_t* loop) {
+  struct epoll_event e;
+  struct uv__iou* streams;
+  int err;
+
+  streams = &uv__get_internal_fields(loop)->streams;
+  if (streams->ringfd != -1)
+    return 0;
+
+  uv__iou_init(loop->backend_fd, streams, 256, 0);
+  if (streams->ringfd == -1)
+    return UV_ENOSYS;
+
+  memset(&e, 0, sizeof(e));
+  e.events = POLLIN;
+  e.data.fd = streams->ringfd;
+
+  if (epoll_ctl(loop->backend_fd, EPOLL_CTL_ADD, streams->ringfd, &e)) {
+    err = UV__ERR(errno);
+    uv__iou_delete(streams);
+    return err;
+  }
+
+  /* After a fork. The new ring doesn't have the buffers yet. */
+  if (uv__get_internal_fields(loop)->bufs.count != 0)
+    return uv__iou_bufs_register(loop);
+
+  return 0;
+}
+
+
+/* Pooled reads draw from a ring of buffers that the kernel picks from when
+ * data arrives, instead of every stream holding a buffer while it waits.
+ * The kernel takes them in ring order. uv_buf_release() puts them back.
+ */
+int uv__iou_bufs_init(uv_loop_t* loop, unsigned int count, unsigned int size) {
+  struct uv__io_uring_buf* ring;
+  struct uv__iou_bufs* bufs;
+  uint32_t i;
+  int err;
+
+  bufs = &uv__get_internal_fields(loop)->bufs;
+  if (bufs->count != 0)
+    return UV_EBUSY;
+
+  if (count == 0 || count > 32768 || (count & (count - 1)) != 0 || size == 0)
+    return UV_EINVAL;
+
+  /* Multishot recv. */
+  if (uv__kernel_version() < /* 6.0.0 */ 0x060000)
+    return UV_ENOSYS;
+
+  err = uv__iou_stream_init(loop);
+  if (err)
+    return err;
+
+  bufs->ringlen = count * sizeof(*ring);
+  bufs->ring = mmap(NULL,
+                    bufs->ringlen,
+                    PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS,
+                    -1,
+                    0);
+
+  if (bufs->ring == MAP_FAILED)
+    return UV__ERR(errno);
+
+  bufs->base = uv__malloc((size_t) count * size);
+  if (bufs->base == NULL) {
+    munmap(bufs->ring, bufs->ringlen);
+    return UV_ENOMEM;
+  }
+
+  ring = bufs->ring;
+  for (i = 0; i < count; i++) {
+    ring[i].addr = (uintptr_t) bufs->base + (size_t) i * size;
+    ring[i].len = size;
+    ring[i].bid = i;
+  }
+
+  bufs->count = count;
+  bufs->size = size;
+  bufs->lent = 0;
+  bufs->tail = count;
+  uv__queue_init(&bufs->waiting);
+
+  err = uv__iou_bufs_register(loop);
+  if (err)
+    uv__iou_bufs_delete(bufs);
+
+  return err;
+}
+
+
+static int uv__iou_bufs_register(uv_loop_t* loop) {
+  struct uv__io_uring_buf_reg reg;
+  struct uv__io_uring_buf* ring;
+  struct uv__io_uring_buf* tmp;
+  struct uv__iou_bufs* bufs;
+  uint32_t start;
+  uint32_t mask;
+  uint32_t n;
+  uint32_t i;
+
+  bufs = &uv__get_internal_fields(loop)->bufs;
+  ring = bufs->ring;
+  mask = bufs->count - 1;
+  n = bufs->count - bufs->lent;
+
+  /* A new ring starts taking at the first entry. The buffers that weren't
+   * lent out are the last n ones put in, move them there.
+   */
+  start = (uint16_t) (bufs->tail - n) & mask;
+  if (start != 0) {
+    tmp = uv__malloc(n * sizeof(*tmp));
+    if (tmp == NULL)
+      return UV_ENOMEM;
+
+    for (i = 0; i < n; i++)
+      tmp[i] = ring[(start + i) & mask];
+
+    for (i = 0; i < n; i++) {
+      ring[i].addr = tmp[i].addr;
+      ring[i].len = tmp[i].len;
+      ring[i].bid = tmp[i].bid;
+    }
+
+    uv__free(tmp);
+  }
+
+  bufs->tail = n;
+  atomic_store_explicit((_Atomic uint16_t*) &ring[0].resv,
+                        bufs->tail,
+                        memory_order_release);
+
+  memset(&reg, 0, sizeof(reg));
+  reg.ring_addr = (uintptr_t) ring;
+  reg.ring_entries = bufs->count;
+  reg.bgid = 0;
+
+  if (uv__io_uring_register(uv__get_internal_fields(loop)->streams.ringfd,
+                            UV__IORING_REGISTER_PBUF_RING,
+                            &reg,
+                            1)) {
+    return UV__ERR(errno);
+  }
+
   return 0;
 }
 
 
+static void uv__iou_bufs_delete(struct uv__iou_bufs* bufs) {
+  if (bufs->count != 0) {
+    munmap(bufs->ring, bufs->ringlen);
+    uv__free(bufs->base);
+    bufs->ring = NULL;
+    bufs->base = NULL;
+    bufs->count = 0;
+  }
+}
+
+
+static char* uv__iou_buf_take(uv_loop_t* loop, uint32_t bid) {
+  struct uv__iou_bufs* bufs;
+
+  bufs = &uv__get_internal_fields(loop)->bufs;
+  assert(bid < bufs->count);
+  bufs->lent++;
+
+  return bufs->base + (size_t) bid * bufs->size;
+}
+
+
+/* Returns 0 if buf isn't one of the ring's buffers. */
+int uv__iou_buf_put(uv_loop_t* loop, char* buf) {
+  struct uv__io_uring_buf* ring;
+  struct uv__io_uring_buf* e;
+  struct uv__iou_bufs* bufs;
+  uintptr_t off;
+
+  bufs = &uv__get_internal_fields(loop)->bufs;
+  off = (uintptr_t) buf - (uintptr_t) bufs->base;
+  if (bufs->count == 0 || off >= (uintptr_t) bufs->count * bufs->size)
+    return 0;
+
+  ring = bufs->ring;
+  e = &ring[bufs->tail & (bufs->count - 1)];
+  e->addr = (uintptr_t) bufs->base + off - off % bufs->size;
+  e->len = bufs->size;
+  e->bid = off / bufs->size;
+
+  bufs->tail++;
+  bufs->lent--;
+  atomic_store_explicit((_Atomic uint16_t*) &ring[0].resv,
+                        bufs->tail,
+                        memory_order_release);
+
+  return 1;
+}
+
+
 int uv__io_fork(uv_loop_t* loop) {
   int err;
   struct watcher_list* root;
@@ -682,6 +949,11 @@ void uv__platform_loop_delete(uv_loop_t* loop) {
   lfields = uv__get_internal_fields(loop);
   uv__iou_delete(&lfields->ctl);
   uv__iou_delete(&lfields->iou);
+  uv__iou_delete(&lfields->streams);
+
+  /* Not when forking, the buffers lent out are still in use. */
+  if (loop->backend_fd != -1)
+    uv__iou_bufs_delete(&lfields->bufs);
 
   if (loop->inotify_fd != -1) {
     uv__io_stop(loop, &loop->inotify_read_watcher, POLLIN);
@@ -759,9 +1031,8 @@ int uv__io_check_fd(uv_loop_t* loop, int fd) {
 
 
 /* Caller must initialize SQE and call uv__iou_submit(). */
-static struct uv__io_uring_sqe* uv__iou_get_sqe(struct uv__iou* iou,
-                                                uv_loop_t* loop,
-                                                uv_fs_t* req) {
+static struct uv__io_uring_sqe* uv__iou_next_sqe(struct uv__iou* iou,
+                                                 uint64_t user_data) {
   struct uv__io_uring_sqe* sqe;
   uint32_t head;
   uint32_t tail;
@@ -783,7 +1054,22 @@ static struct uv__io_uring_sqe* uv__iou_get_sqe(struct uv__iou* iou,
   sqe = iou->sqe;
   sqe = &sqe[slot];
   memset(sqe, 0, sizeof(*sqe));
-  sqe->user_data = (uintptr_t) req;
+  sqe->user_data = user_data;
+  iou->in_flight++;
+
+  return sqe;
+}
+
+
+/* Caller must initialize SQE and call uv__iou_submit(). */
+static struct uv__io_uring_sqe* uv__iou_get_sqe(struct uv__iou* iou,
+                                                uv_loop_t* loop,
+                                                uv_fs_t* req) {
+  struct uv__io_uring_sqe* sqe;
+
+  sqe = uv__iou_next_sqe(iou, (uintptr_t) req);
+  if (sqe == NULL)
+    return NULL;
 
   /* Pacify uv_cancel(). */
   req->work_req.loop = loop;
@@ -792,7 +1078,6 @@ static struct uv__io_uring_sqe* uv__iou_get_sqe(struct uv__iou* iou,
   uv__queue_init(&req->work_req.wq);
 
   uv__req_register(loop, req);
-  iou->in_flight++;
 
   return sqe;
 }
@@ -815,6 +1100,61 @@ static void uv__iou_submit(struct uv__iou* iou) {
 }
 
 
+/* Submits the entries of a ring that has no kernel thread polling it. */
+static void uv__iou_flush(struct uv__iou* iou) {
+  uint32_t n;
+  int rc;
+
+  n = *iou->sqtail - *iou->sqhead;
+  while (n > 0) {
+    rc = uv__io_uring_enter(iou->ringfd, n, 0, 0);
+
+    if (rc == -1) {
+      if (errno == EINTR)
+        continue;
+
+      /* The completion ring is full. Retried after draining it. */
+      if (errno == EAGAIN || errno == EBUSY)
+        return;
+
+      perror("libuv: io_uring_enter(submit)");  /* Can't happen. */
+      return;
+    }
+
+    if (rc == 0)
+      return;
+
+    n -= rc;
+  }
+}
+
+
+void uv__iou_stream_flush(uv_loop_t* loop) {
+  struct uv__iou* streams;
+
+  streams = &uv__get_internal_fields(loop)->streams;
+  if (streams->ringfd != -1)
+    uv__iou_flush(streams);
+}
+
+
+static struct uv__io_uring_sqe* uv__iou_stream_sqe(uv_loop_t* loop,
+                                                   uint64_t user_data) {
+  struct uv__io_uring_sqe* sqe;
+  struct uv__iou* streams;
+
+  streams = &uv__get_internal_fields(loop)->streams;
+
+  sqe = uv__iou_next_sqe(streams, user_data);
+  if (sqe == NULL && streams->ringfd != -1) {
+    uv__iou_flush(streams);
+    sqe = uv__iou_next_sqe(streams, user_data);
+  }
+
+  return sqe;
+}
+
+
 int uv__iou_fs_close(uv_loop_t* loop, uv_fs_t* req) {
   struct uv__io_uring_sqe* sqe;
   struct uv__iou* iou;
@@ -1092,6 +1432,115 @@ int uv__iou_fs_statx(uv_loop_t* loop,
 }
 
 
+int uv__iou_stream_read(uv_loop_t* loop,
+                        uv_stream_t* stream,
+                        char* buf,
+                        unsigned int len) {
+  struct uv__io_uring_sqe* sqe;
+
+  sqe = uv__iou_stream_sqe(loop, (uintptr_t) stream | UV__IOU_STREAM_READ);
+  if (sqe == NULL)
+    return 0;
+
+  sqe->addr = (uintptr_t) buf;
+  sqe->fd = uv__stream_fd(stream);
+  sqe->len = len;
+  sqe->off = -1;  /* Not seekable. */
+  sqe->opcode = UV__IORING_OP_READ;
+
+  uv__iou_submit(&uv__get_internal_fields(loop)->streams);
+
+  return 1;
+}
+
+
+int uv__iou_stream_write(uv_loop_t* loop,
+                         uv_stream_t* stream,
+                         const uv_buf_t* bufs,
+                         unsigned int nbufs) {
+  struct uv__io_uring_sqe* sqe;
+
+  if (nbufs > IOV_MAX)
+    nbufs = IOV_MAX;
+
+  sqe = uv__iou_stream_sqe(loop, (uintptr_t) stream | UV__IOU_STREAM_WRITE);
+  if (sqe == NULL)
+    return 0;
+
+  sqe->addr = (uintptr_t) bufs;
+  sqe->fd = uv__stream_fd(stream);
+  sqe->len = nbufs;
+  sqe->off = -1;  /* Not seekable. */
+  sqe->opcode = UV__IORING_OP_WRITEV;
+
+  uv__iou_submit(&uv__get_internal_fields(loop)->streams);
+
+  return 1;
+}
+
+
+/* Keeps accepting until cancelled or an error occurs. Completions carry the
+ * UV__IOU_STREAM_READ tag.
+ */
+int uv__iou_stream_accept(uv_loop_t* loop, uv_stream_t* stream) {
+  struct uv__io_uring_sqe* sqe;
+
+  sqe = uv__iou_stream_sqe(loop, (uintptr_t) stream | UV__IOU_STREAM_READ);
+  if (sqe == NULL)
+    return 0;
+
+  sqe->fd = uv__stream_fd(stream);
+  sqe->ioprio = UV__IORING_ACCEPT_MULTISHOT;
+  sqe->opcode = UV__IORING_OP_ACCEPT;
+  sqe->rw_flags = SOCK_CLOEXEC | SOCK_NONBLOCK;  /* accept_flags */
+
+  uv__iou_submit(&uv__get_internal_fields(loop)->streams);
+
+  return 1;
+}
+
+
+/* Keeps receiving into the loop's buffers until cancelled, an error occurs or
+ * the buffers run out. Completions carry the UV__IOU_STREAM_READ tag.
+ */
+int uv__iou_stream_recv(uv_loop_t* loop, uv_stream_t* stream) {
+  struct uv__io_uring_sqe* sqe;
+
+  sqe = uv__iou_stream_sqe(loop, (uintptr_t) stream | UV__IOU_STREAM_READ);
+  if (sqe == NULL)
+    return 0;
+
+  sqe->buf_group = 0;
+  sqe->fd = uv__stream_fd(stream);
+  sqe->flags = UV__IOSQE_BUFFER_SELECT;
+  sqe->ioprio = UV__IORING_RECV_MULTISHOT;
+  sqe->opcode = UV__IORING_OP_RECV;
+
+  uv__iou_submit(&uv__get_internal_fields(loop)->streams);
+
+  return 1;
+}
+
+
+int uv__iou_stream_cancel(uv_loop_t* loop,
+                          uv_stream_t* stream,
+                          unsigned int op) {
+  struct uv__io_uring_sqe* sqe;
+
+  sqe = uv__iou_stream_sqe(loop, UV__IOU_TAG_CANCEL);
+  if (sqe == NULL)
+    return 0;
+
+  sqe->addr = (uintptr_t) stream | op;
+  sqe->fd = -1;
+  sqe->opcode = UV__IORING_OP_ASYNC_CANCEL;
+
+  uv__iou_submit(&uv__get_internal_fields(loop)->streams);
+
+  return 1;
+}
+
+
 void uv__statx_to_stat(const struct uv__statx* statxbuf, uv_stat_t* buf) {
   buf->st_dev = makedev(statxbuf->stx_dev_major, statxbuf->stx_dev_minor);
   buf->st_mode = statxbuf->stx_mode;
@@ -1138,6 +1587,9 @@ static void uv__poll_io_uring(uv_loop_t* loop, struct uv__iou* iou) {
   struct uv__io_uring_cqe* cqe;
   struct uv__io_uring_cqe* e;
   uv_fs_t* req;
+  uint64_t tag;
+  uint32_t more;
+  char* buf;
   uint32_t head;
   uint32_t tail;
   uint32_t mask;
@@ -1156,6 +1608,29 @@ static void uv__poll_io_uring(uv_loop_t* loop, struct uv__iou* iou) {
   for (i = head; i != tail; i++) {
     e = &cqe[i & mask];
 
+    tag = e->user_data & UV__IOU_TAG_MASK;
+    if (tag != 0) {
+      more = e->flags & UV__IORING_CQE_F_MORE;  /* Multishot, not done yet. */
+      if (!more)
+        iou->in_flight--;
+
+      buf = NULL;
+      if (e->flags & UV__IORING_CQE_F_BUFFER)
+        buf = uv__iou_buf_take(loop, e->flags >> UV__IORING_CQE_BUFFER_SHIFT);
+
+      if (tag != UV__IOU_TAG_CANCEL) {
+        uv__metrics_update_idle_time(loop);
+        uv__stream_iou_done((uv_stream_t*) (uintptr_t) (e->user_data ^ tag),
+                            tag,
+                            e->res,
+                            more,
+                            buf);
+        nevents++;
+      }
+
+      continue;
+    }
+
     req = (uv_fs_t*) (uintptr_t) e->user_data;
     assert(req->type == UV_FS);
 
@@ -1333,6 +1808,7 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
   struct uv__invalidate inv;
   struct epoll_event* pe;
   struct epoll_event e;
+  struct uv__iou* streams;
   struct uv__iou* ctl;
   struct uv__iou* iou;
   int real_timeout;
@@ -1356,6 +1832,7 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
   lfields = uv__get_internal_fields(loop);
   ctl = &lfields->ctl;
   iou = &lfields->iou;
+  streams = &lfields->streams;
 
   sigmask = NULL;
   if (loop->flags & UV_LOOP_BLOCK_SIGPROF) {
@@ -1388,12 +1865,19 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
     uv__queue_remove(q);
     uv__queue_init(q);
 
-    op = EPOLL_CTL_MOD;
-    if (w->events == 0)
+    if (w->events & UV__POLLET) {
+      /* For good, see uv__io_start(). */
       op = EPOLL_CTL_ADD;
+      e.events = POLLIN | POLLOUT | UV__POLLRDHUP | UV__POLLET;
+    } else {
+      op = EPOLL_CTL_MOD;
+      if (w->events == 0)
+        op = EPOLL_CTL_ADD;
+
+      w->events = w->pevents;
+      e.events = w->pevents;
+    }
 
-    w->events = w->pevents;
-    e.events = w->pevents;
     e.data.fd = w->fd;
 
     uv__epoll_ctl_prep(epollfd, ctl, &prep, op, w->fd, &e);
@@ -1405,7 +1889,7 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
 
   for (;;) {
     if (loop->nfds == 0)
-      if (iou->in_flight == 0)
+      if (iou->in_flight == 0 && streams->in_flight == 0)
         break;
 
     /* All event mask mutations should be visible to the kernel before
@@ -1415,6 +1899,9 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
       while (*ctl->sqhead != *ctl->sqtail)
         uv__epoll_ctl_flush(epollfd, ctl, &prep);
 
+    if (streams->ringfd != -1)
+      uv__iou_flush(streams);
+
     /* Only need to set the provider_entry_time if timeout != 0. The function
      * will return early if the loop isn't configured with UV_METRICS_IDLE_TIME.
      */
@@ -1453,6 +1940,11 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
       goto update_timeout;
     }
 
+    /* The callbacks below may signal async handles, the loop looks at them
+     * before it blocks again so their senders needn't write the eventfd.
+     */
+    uv__async_wake(loop);
+
     have_iou_events = 0;
     have_signals = 0;
     nevents = 0;
@@ -1474,6 +1966,12 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
         continue;
       }
 
+      if (fd == streams->ringfd) {
+        uv__poll_io_uring(loop, streams);
+        have_iou_events = 1;
+        continue;
+      }
+
       assert(fd >= 0);
       assert((unsigned) fd < loop->nwatchers);
 
@@ -1489,6 +1987,15 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
         continue;
       }
 
+      /* Edge-triggered, remember what the kernel won't report again until
+       * a read or write comes up short. Stopped watchers only take note.
+       */
+      if (w->events & UV__POLLET) {
+        w->events |= pe->events & (POLLIN | POLLOUT | UV__POLLRDHUP | POLLHUP);
+        if (w->pevents == 0)
+          continue;
+      }
+
       /* Give users only events they're interested in. Prevents spurious
        * callbacks when previous callback invocation in this loop has stopped
        * the current watcher. Also, filters out events that users has not
@@ -1550,6 +2057,12 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
     if (have_signals != 0)
       break;  /* Event loop should cycle now so don't poll again. */
 
+    /* Streams that used up their UV_LOOP_READ_BUDGET go first in the next
+     * loop iteration, not after yet another round of events.
+     */
+    if (!uv__queue_empty(&lfields->read_budget.next))
+      break;
+
     if (nevents != 0) {
       if (nfds == ARRAY_SIZE(events) && --count != 0) {
         /* Poll for more events but don't block this time. */
@@ -1563,6 +2076,10 @@ update_timeout:
     if (timeout == 0)
       break;
 
+    /* Don't block on handles that were signalled while we were awake. */
+    if (uv__async_block(loop))
+      break;
+
     if (timeout == -1)
       continue;
 
@@ -64,6 +64,7 @@ int uv_loop_init(uv_loop_t* loop) {
   loop->nwatchers = 0;
   uv__queue_init(&loop->pending_queue);
   uv__queue_init(&loop->watcher_queue);
+  uv__queue_init(&lfields->read_budget.next);
 
   loop->closing_handles = NULL;
   uv__update_time(loop);
@@ -157,6 +158,14 @@ int uv_loop_fork(uv_loop_t* loop) {
     if (w == NULL)
       continue;
 
+    if (w->events & UV__POLLET) {
+      /* Edge-triggered, registered even when stopped. Readiness starts over. */
+      w->events = UV__POLLET;
+      if (uv__queue_empty(&w->watcher_queue))
+        uv__queue_insert_tail(&loop->watcher_queue, &w->watcher_queue);
+      continue;
+    }
+
     if (w->pevents != 0 && uv__queue_empty(&w->watcher_queue)) {
       w->events = 0; /* Force re-registration in uv__io_poll. */
       uv__queue_insert_tail(&loop->watcher_queue, &w->watcher_queue);
@@ -187,10 +196,8 @@ void uv__loop_close(uv_loop_t* loop) {
     loop->backend_fd = -1;
   }
 
-  uv_mutex_lock(&loop->wq_mutex);
-  assert(uv__queue_empty(&loop->wq) && "thread pool work queue not empty!");
+  uv__work_loop_close(loop);
   assert(!uv__has_active_reqs(loop));
-  uv_mutex_unlock(&loop->wq_mutex);
   uv_mutex_destroy(&loop->wq_mutex);
 
   /*
@@ -210,14 +217,101 @@ void uv__loop_close(uv_loop_t* loop) {
   loop->nwatchers = 0;
 
   lfields = uv__get_internal_fields(loop);
+  uv__free(lfields->buf_pool.base);
   uv_mutex_destroy(&lfields->loop_metrics.lock);
   uv__free(lfields);
   loop->internal_fields = NULL;
 }
 
 
+/* The buffer pool is a slab of same-sized buffers. Free buffers are linked
+ * through their first bytes, the last one released is the first one lent
+ * again while it's still warm in the cache. The heap takes over when all of
+ * them are out.
+ */
+int uv__buf_pool_init(uv_loop_t* loop, unsigned int count, unsigned int size) {
+  struct uv__buf_pool* pool;
+  unsigned int i;
+
+  pool = &uv__get_internal_fields(loop)->buf_pool;
+  if (pool->count != 0)
+    return UV_EBUSY;
+
+  if (count == 0 || size < sizeof(void*) || count > (size_t) -1 / size)
+    return UV_EINVAL;
+
+  pool->base = uv__malloc((size_t) count * size);
+  if (pool->base == NULL)
+    return UV_ENOMEM;
+
+  pool->count = count;
+  pool->size = size;
+  pool->free = NULL;
+  for (i = count; i > 0; i--)
+    uv__buf_pool_put(loop, pool->base + (size_t) (i - 1) * size);
+
+  return 0;
+}
+
+
+/* Returns NULL when all buffers are lent out. */
+char* uv__buf_pool_take(uv_loop_t* loop) {
+  struct uv__buf_pool* pool;
+  char* buf;
+
+  pool = &uv__get_internal_fields(loop)->buf_pool;
+  buf = pool->free;
+  if (buf != NULL)
+    memcpy(&pool->free, buf, sizeof(pool->free));
+
+  return buf;
+}
+
+
+/* Lends a buffer to a pooled read. buf->base is NULL if the pool is empty and
+ * the heap is out of memory too.
+ */
+void uv__buf_pool_get(uv_loop_t* loop, uv_buf_t* buf) {
+  struct uv__buf_pool* pool;
+  char* base;
+
+  pool = &uv__get_internal_fields(loop)->buf_pool;
+  base = uv__buf_pool_take(loop);
+  if (base != NULL) {
+    uv__metrics_inc_buf_pool_hits(loop, 1);
+  } else {
+    uv__metrics_inc_buf_pool_misses(loop);
+    base = uv__malloc(pool->size);
+  }
+
+  *buf = uv_buf_init(base, base != NULL ? pool->size : 0);
+}
+
+
+/* Returns 0 if buf is not from the pool. */
+int uv__buf_pool_put(uv_loop_t* loop, char* buf) {
+  struct uv__buf_pool* pool;
+  uintptr_t off;
+
+  pool = &uv__get_internal_fields(loop)->buf_pool;
+  off = (uintptr_t) buf - (uintptr_t) pool->base;
+  if (pool->base == NULL || off >= (uintptr_t) pool->count * pool->size)
+    return 0;
+
+  buf = pool->base + off - off % pool->size;
+  memcpy(buf, &pool->free, sizeof(pool->free));
+  pool->free = buf;
+  return 1;
+}
+
+
 int uv__loop_configure(uv_loop_t* loop, uv_loop_option option, va_list ap) {
   uv__loop_internal_fields_t* lfields;
+  unsigned int count;
+  unsigned int size;
+#if defined(__linux__)
+  int err;
+#endif
 
   lfields = uv__get_internal_fields(loop);
   if (option == UV_METRICS_IDLE_TIME) {
@@ -225,6 +319,51 @@ int uv__loop_configure(uv_loop_t* loop, uv_loop_option option, va_list ap) {
     return 0;
   }
 
+  if (option == UV_LOOP_IO_URING_STREAMS) {
+#if defined(__linux__)
+    err = uv__iou_stream_init(loop);
+    if (err == 0)
+      loop->flags |= UV_LOOP_IOU_STREAMS;
+    return err;
+#else
+    return UV_ENOSYS;
+#endif
+  }
+
+  if (option == UV_LOOP_EDGE_TRIGGERED) {
+#if defined(__linux__)
+    loop->flags |= UV_LOOP_EDGE_TRIGGERED_IO;
+    return 0;
+#else
+    return UV_ENOSYS;
+#endif
+  }
+
+  if (option == UV_LOOP_READ_BUDGET) {
+    lfields->read_budget.bytes = va_arg(ap, unsigned int);
+    lfields->read_budget.time = va_arg(ap, unsigned int) * (uint64_t) 1000;
+    return 0;
+  }
+
+  if (option == UV_LOOP_IO_URING_BUFFERS) {
+#if defined(__linux__)
+    count = va_arg(ap, unsigned int);
+    size = va_arg(ap, unsigned int);
+    err = uv__iou_bufs_init(loop, count, size);
+    if (err == 0)
+      loop->flags |= UV_LOOP_IOU_STREAMS;
+    return err;
+#else
+    return UV_ENOSYS;
+#endif
+  }
+
+  if (option == UV_LOOP_BUFFER_POOL) {
+    count = va_arg(ap, unsigned int);
+    size = va_arg(ap, unsigned int);
+    return uv__buf_pool_init(loop, count, size);
+  }
+
   if (option != UV_LOOP_BLOCK_SIGNAL)
     return UV_ENOSYS;
 
@@ -35,6 +35,14 @@
 #include <unistd.h>
 #include <limits.h> /* IOV_MAX */
 
+#if defined(__linux__)
+# include <netinet/in.h>
+# include <linux/errqueue.h>
+# ifndef SO_EE_ORIGIN_ZEROCOPY
+#  define SO_EE_ORIGIN_ZEROCOPY 5
+# endif
+#endif
+
 #ifdef __VMS
 /* Fix these for 64-bit C++ pointers. */
 #undef _CMSG_SPACE
@@ -83,12 +91,20 @@ union uv__cmsg {
 STATIC_ASSERT(256 == sizeof(union uv__cmsg));
 
 static void uv__stream_connect(uv_stream_t*);
+#if defined(__linux__)
+static void uv__stream_zc_reap(uv_stream_t* stream);
+#endif
 static void uv__write(uv_stream_t* stream);
 static void uv__read(uv_stream_t* stream);
 static void uv__stream_io(uv_loop_t* loop, uv__io_t* w, unsigned int events);
 static void uv__write_callbacks(uv_stream_t* stream);
 static size_t uv__write_req_size(uv_write_t* req);
 static void uv__drain(uv_stream_t* stream);
+#if defined(__linux__)
+static void uv__stream_iou_connections(uv_stream_t* stream);
+static void uv__stream_iou_listen(uv_stream_t* stream);
+static int uv__stream_iou_recv(uv_stream_t* stream);
+#endif
 
 
 void uv__stream_init(uv_loop_t* loop,
@@ -99,6 +115,9 @@ void uv__stream_init(uv_loop_t* loop,
   uv__handle_init(loop, (uv_handle_t*)stream, type);
   stream->read_cb = NULL;
   stream->alloc_cb = NULL;
+  stream->read_bufs_cb = NULL;
+  stream->alloc_bufs_cb = NULL;
+  stream->cork_bufs = NULL;
   stream->close_cb = NULL;
   stream->connection_cb = NULL;
   stream->connect_req = NULL;
@@ -106,6 +125,9 @@ void uv__stream_init(uv_loop_t* loop,
   stream->accepted_fd = -1;
   stream->queued_fds = NULL;
   stream->delayed_error = 0;
+  stream->read_budget_tick = 0;
+  stream->read_budget_bytes = 0;
+  stream->read_budget_time = 0;
   uv__queue_init(&stream->write_queue);
   uv__queue_init(&stream->write_completed_queue);
   stream->write_queue_size = 0;
@@ -127,6 +149,18 @@ void uv__stream_init(uv_loop_t* loop,
   stream->select = NULL;
 #endif /* defined(__APPLE_) */
 
+#if defined(__linux__)
+  stream->iou_read_buf = NULL;
+  stream->iou_read_off = 0;
+  stream->iou_read_len = 0;
+  stream->iou_flags = 0;
+  uv__queue_init(&stream->iou_bufs_queue);
+  uv__queue_init(&stream->zc_queue);
+  stream->zc_threshold = 0;
+  stream->zc_sent = 0;
+  stream->zc_done = 0;
+#endif
+
   uv__io_init(&stream->io_watcher, uv__stream_io, -1);
 }
 
@@ -434,6 +468,11 @@ int uv__stream_open(uv_stream_t* stream, int fd, int flags) {
         uv__tcp_keepalive(fd, 1, 60)) {
       return UV__ERR(errno);
     }
+
+#if defined(__linux__)
+    if (stream->zc_threshold != 0 && uv__tcp_zerocopy(fd))
+      return UV__ERR(errno);
+#endif
   }
 
 #if defined(__APPLE__)
@@ -451,9 +490,32 @@ int uv__stream_open(uv_stream_t* stream, int fd, int flags) {
 }
 
 
+#if defined(__linux__)
+/* Completes the requests waiting for zero-copy sends without waiting any
+ * longer. Their data was written, the kernel may still be sending it.
+ */
+static void uv__stream_zc_flush(uv_stream_t* stream) {
+  struct uv__queue* q;
+
+  while (!uv__queue_empty(&stream->zc_queue)) {
+    q = uv__queue_head(&stream->zc_queue);
+    uv__queue_remove(q);
+    uv__queue_insert_tail(&stream->write_completed_queue, q);
+  }
+
+  uv__io_stop(stream->loop, &stream->io_watcher, UV__POLLPRI);
+}
+#endif
+
+
 void uv__stream_flush_write_queue(uv_stream_t* stream, int error) {
   uv_write_t* req;
   struct uv__queue* q;
+
+#if defined(__linux__)
+  uv__stream_zc_flush(stream);
+#endif
+
   while (!uv__queue_empty(&stream->write_queue)) {
     q = uv__queue_head(&stream->write_queue);
     uv__queue_remove(q);
@@ -481,6 +543,16 @@ void uv__stream_destroy(uv_stream_t* stream) {
   uv__drain(stream);
 
   assert(stream->write_queue_size == 0);
+
+  uv__free(stream->cork_bufs);
+  stream->cork_bufs = NULL;
+
+#if defined(__linux__)
+  assert(!(stream->iou_flags & UV__IOU_STREAM_IN_FLIGHT));
+  uv__free(stream->iou_read_buf);
+  stream->iou_read_buf = NULL;
+  stream->iou_read_len = 0;
+#endif
 }
 
 
@@ -527,6 +599,15 @@ void uv__server_io(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
   int fd;
 
   stream = container_of(w, uv_stream_t, io_watcher);
+
+#if defined(__linux__)
+  /* Fed by uv_accept(). */
+  if (stream->iou_flags & UV__IOU_STREAM_ACCEPT) {
+    uv__stream_iou_connections(stream);
+    return;
+  }
+#endif
+
   assert(events & POLLIN);
   assert(stream->accepted_fd == -1);
   assert(!(stream->flags & UV_HANDLE_CLOSING));
@@ -596,6 +677,14 @@ done:
     /* Read first */
     server->accepted_fd = queued_fds->fds[0];
 
+#if defined(__linux__)
+    /* Accepted by io_uring. Report it like a new connection. */
+    if (server->iou_flags & UV__IOU_STREAM_ACCEPT) {
+      server->iou_flags |= UV__IOU_STREAM_CONNECTION;
+      uv__io_feed(server->loop, &server->io_watcher);
+    }
+#endif
+
     /* All read, free */
     assert(queued_fds->offset > 0);
     if (--queued_fds->offset == 0) {
@@ -609,6 +698,14 @@ done:
     }
   } else {
     server->accepted_fd = -1;
+#if defined(__linux__)
+    /* Accept again if io_uring stopped accepting. */
+    if (server->iou_flags & UV__IOU_STREAM_ACCEPT) {
+      if (!(server->iou_flags & UV__IOU_STREAM_READ))
+        uv__io_feed(server->loop, &server->io_watcher);
+      return err;
+    }
+#endif
     if (err == 0)
       uv__io_start(server->loop, &server->io_watcher, POLLIN);
   }
@@ -637,6 +734,11 @@ int uv_listen(uv_stream_t* stream, int backlog, uv_connection_cb cb) {
   if (err == 0)
     uv__handle_start(stream);
 
+#if defined(__linux__)
+  if (err == 0)
+    uv__stream_iou_listen(stream);
+#endif
+
   return err;
 }
 
@@ -738,6 +840,26 @@ static void uv__write_req_finish(uv_write_t* req) {
   /* Pop the req off tcp->write_queue. */
   uv__queue_remove(&req->queue);
 
+#if defined(__linux__)
+  /* Callbacks run in order, so a request waits for the zero-copy sends before
+   * it even if it didn't make any itself. After an error, nothing waits.
+   */
+  if (req->error == 0 &&
+      (stream->zc_sent != stream->zc_done ||
+       !uv__queue_empty(&stream->zc_queue))) {
+    if (req->bufs != req->bufsml)
+      uv__free(req->bufs);
+    req->bufs = NULL;
+    req->write_index = stream->zc_sent;  /* See uv__stream_zc_reap(). */
+    uv__queue_insert_tail(&stream->zc_queue, &req->queue);
+    uv__io_start(stream->loop, &stream->io_watcher, UV__POLLPRI);
+    return;
+  }
+
+  if (req->error != 0)
+    uv__stream_zc_flush(stream);
+#endif
+
   /* Only free when there was no error. On error, we touch up write_queue_size
    * right before making the callback. The reason we don't do that right away
    * is that a write_queue_size > 0 is our only way to signal to the user that
@@ -775,7 +897,8 @@ static int uv__handle_fd(uv_handle_t* handle) {
 static int uv__try_write(uv_stream_t* stream,
                          const uv_buf_t bufs[],
                          unsigned int nbufs,
-                         uv_stream_t* send_handle) {
+                         uv_stream_t* send_handle,
+                         int zerocopy) {
   struct iovec* iov;
   int iovmax;
   int iovcnt;
@@ -833,6 +956,28 @@ static int uv__try_write(uv_stream_t* stream,
       n = sendmsg(uv__stream_fd(stream), &msg, 0);
 #endif
     while (n == -1 && errno == EINTR);
+#if defined(__linux__)
+  } else if (zerocopy) {
+    struct msghdr msg;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovcnt;
+
+    do
+      n = sendmsg(uv__stream_fd(stream), &msg, MSG_ZEROCOPY);
+    while (n == -1 && errno == EINTR);
+
+    /* Every send that succeeds gets a completion, see uv__stream_zc_reap().
+     * ENOBUFS means too many pages are pinned already, copy instead.
+     */
+    if (n >= 0)
+      stream->zc_sent++;
+    else if (errno == ENOBUFS)
+      do
+        n = uv__writev(uv__stream_fd(stream), iov, iovcnt);
+      while (n == -1 && errno == EINTR);
+#endif
   } else {
     do
       n = uv__writev(uv__stream_fd(stream), iov, iovcnt);
@@ -862,14 +1007,423 @@ static int uv__try_write(uv_stream_t* stream,
   return UV__ERR(errno);
 }
 
+/* Gets the buffers for the next read from the user, one with uv_read_start()
+ * and up to UV_READ_BUFS_MAX with uv_read_start_bufs(). Returns UV_ENOBUFS if
+ * the user can't or won't handle the read.
+ */
+static int uv__stream_alloc(uv_stream_t* stream,
+                            size_t suggested_size,
+                            uv_buf_t* bufs,
+                            unsigned int* nbufs) {
+  bufs[0] = uv_buf_init(NULL, 0);
+
+  if (stream->flags & UV_HANDLE_READ_BUFS) {
+    *nbufs = UV_READ_BUFS_MAX;
+    assert(stream->alloc_bufs_cb != NULL);
+    stream->alloc_bufs_cb((uv_handle_t*)stream, suggested_size, bufs, nbufs);
+    assert(*nbufs <= UV_READ_BUFS_MAX);
+  } else {
+    *nbufs = 1;
+    assert(stream->alloc_cb != NULL);
+    stream->alloc_cb((uv_handle_t*)stream, suggested_size, bufs);
+  }
+
+  if (bufs[0].base == NULL || uv__count_bufs(bufs, *nbufs) == 0)
+    return UV_ENOBUFS;
+
+  return 0;
+}
+
+
+static void uv__stream_read_cb(uv_stream_t* stream,
+                               ssize_t nread,
+                               const uv_buf_t* bufs,
+                               unsigned int nbufs) {
+  if (stream->flags & UV_HANDLE_READ_BUFS)
+    stream->read_bufs_cb(stream, nread, bufs, nbufs);
+  else
+    stream->read_cb(stream, nread, bufs);
+}
+
+
+#if defined(__linux__)
+/* With UV_LOOP_IO_URING_STREAMS, reads are submitted to the loop's io_uring
+ * instead of waiting for epoll readiness, and so are writes that would block.
+ * At most one read and one write is in flight per stream. The kernel
+ * references the stream and the buffers until they complete, so
+ * uv__finish_close() waits for them.
+ *
+ * Reads go to a buffer owned by the stream and are handed out through
+ * alloc_cb and read_cb when they complete. That way a uv_read_stop() or
+ * uv_close() doesn't have to wait for the kernel to let go of a buffer of
+ * the user's. Data read when the stream had stopped reading is kept for the
+ * next uv_read_start().
+ *
+ * Pooled reads arm a multishot recv instead, the kernel picks a buffer from
+ * the loop's ring when data arrives. Those buffers go to read_cb directly.
+ */
+#define UV__IOU_READ_SIZE (64 * 1024)
+
+/* Data read ahead, or lost for want of memory to keep it. */
+#define uv__stream_iou_pending(stream)                                        \
+  ((stream)->iou_read_len > 0 || (stream)->iou_flags & UV__IOU_STREAM_LOST)
+
+static int uv__stream_iou_enabled(const uv_stream_t* stream) {
+  if (!(stream->loop->flags & UV_LOOP_IOU_STREAMS))
+    return 0;
+
+  if (stream->type == UV_TTY)
+    return 0;
+
+  if (stream->type == UV_NAMED_PIPE && ((const uv_pipe_t*) stream)->ipc)
+    return 0;
+
+  return !(stream->flags & UV_HANDLE_BLOCKING_WRITES);
+}
+
+
+static void uv__stream_iou_cancel(uv_stream_t* stream, unsigned int op) {
+  unsigned int cancel;
+
+  cancel = op << 2;  /* UV__IOU_STREAM_READ_CANCEL or WRITE_CANCEL. */
+  if (!(stream->iou_flags & op) || (stream->iou_flags & cancel))
+    return;
+
+  if (uv__iou_stream_cancel(stream->loop, stream, op))
+    stream->iou_flags |= cancel;
+}
+
+
+/* Hands out the data that was read ahead. Returns 0 once it's all gone. */
+static int uv__stream_iou_deliver(uv_stream_t* stream) {
+  uv_buf_t bufs[UV_READ_BUFS_MAX];
+  unsigned int nbufs;
+  unsigned int len;
+  unsigned int n;
+  unsigned int i;
+  int count;
+
+  count = 32;
+  while (stream->iou_read_len > 0 &&
+         stream->flags & UV_HANDLE_READING &&
+         count-- > 0) {
+    if (uv__stream_alloc(stream, stream->iou_read_len, bufs, &nbufs)) {
+      /* User indicates it can't or won't handle the read. */
+      uv__stream_read_cb(stream, UV_ENOBUFS, bufs, nbufs);
+      return 1;
+    }
+
+    n = 0;
+    for (i = 0; i < nbufs && stream->iou_read_len > 0; i++) {
+      len = stream->iou_read_len;
+      if (len > bufs[i].len)
+        len = bufs[i].len;
+
+      memcpy(bufs[i].base, stream->iou_read_buf + stream->iou_read_off, len);
+      stream->iou_read_off += len;
+      stream->iou_read_len -= len;
+      n += len;
+    }
+
+    uv__stream_read_cb(stream, n, bufs, nbufs);
+  }
+
+  return stream->iou_read_len > 0;
+}
+
+
+/* Keeps data that a multishot recv delivered while the stream wasn't taking
+ * it. The loop's buffer goes back to the ring right away.
+ */
+static void uv__stream_iou_set_aside(uv_stream_t* stream,
+                                     const char* data,
+                                     unsigned int n) {
+  unsigned int len;
+  char* buf;
+
+  buf = stream->iou_read_buf;
+  len = stream->iou_read_off + stream->iou_read_len + n;
+
+  if (buf == NULL || len > UV__IOU_READ_SIZE) {
+    if (len < UV__IOU_READ_SIZE)
+      len = UV__IOU_READ_SIZE;
+
+    buf = (char*) uv__realloc(buf, len);
+    if (buf == NULL) {
+      stream->iou_flags |= UV__IOU_STREAM_LOST;
+      return;
+    }
+
+    stream->iou_read_buf = buf;
+  }
+
+  memcpy(buf + stream->iou_read_off + stream->iou_read_len, data, n);
+  stream->iou_read_len += n;
+}
+
+
+/* Hands the data read ahead to a pooled read. It's not in the loop's buffers,
+ * uv_buf_release() frees it.
+ */
+static void uv__stream_iou_lend(uv_stream_t* stream) {
+  uv_buf_t buf;
+
+  buf = uv_buf_init(stream->iou_read_buf, stream->iou_read_len);
+  if (stream->iou_read_off != 0)
+    memmove(buf.base, buf.base + stream->iou_read_off, buf.len);
+
+  stream->iou_read_buf = NULL;
+  stream->iou_read_off = 0;
+  stream->iou_read_len = 0;
+  stream->read_cb(stream, buf.len, &buf);
+}
+
+
+/* Returns 0 if the read should be done the regular way. */
+static int uv__stream_iou_read(uv_stream_t* stream) {
+  uv_buf_t buf;
+
+  if (stream->iou_flags & UV__IOU_STREAM_READ) {
+    /* Left over from a uv_read_stop(), completes soon. */
+    uv__io_stop(stream->loop, &stream->io_watcher, POLLIN);
+    return 1;
+  }
+
+  if (stream->iou_flags & UV__IOU_STREAM_LOST) {
+    uv__io_stop(stream->loop, &stream->io_watcher, POLLIN);
+    stream->iou_flags &= ~UV__IOU_STREAM_LOST;
+    buf = uv_buf_init(NULL, 0);
+    uv__stream_read_cb(stream, UV_ENOBUFS, &buf, 0);
+
+    if (!(stream->flags & UV_HANDLE_READING))
+      return 1;
+
+    if (uv__stream_fd(stream) == -1)
+      return 1;  /* read_cb closed stream. */
+  }
+
+  if (stream->iou_read_len > 0) {
+    uv__io_stop(stream->loop, &stream->io_watcher, POLLIN);
+    if (stream->flags & UV_HANDLE_READ_POOLED) {
+      uv__stream_iou_lend(stream);
+    } else if (uv__stream_iou_deliver(stream)) {
+      /* Try again on the next loop iteration, see uv__stream_io(). */
+      if (stream->flags & UV_HANDLE_READING)
+        uv__io_feed(stream->loop, &stream->io_watcher);
+      return 1;
+    }
+
+    if (!(stream->flags & UV_HANDLE_READING))
+      return 1;
+
+    if (uv__stream_fd(stream) == -1)
+      return 1;  /* read_cb closed stream. */
+  }
+
+  if (stream->iou_flags & UV__IOU_STREAM_RING)
+    return uv__stream_iou_recv(stream);
+
+  /* Pooled reads without the ring, and vectored reads, read the regular
+   * way.
+   */
+  if (stream->flags & (UV_HANDLE_READ_POOLED | UV_HANDLE_READ_BUFS))
+    return 0;
+
+  if (!uv__stream_iou_enabled(stream))
+    return 0;
+
+  if (!(stream->flags & UV_HANDLE_READING))
+    return 1;
+
+  if (stream->iou_read_buf == NULL) {
+    stream->iou_read_buf = (char*) uv__malloc(UV__IOU_READ_SIZE);
+    if (stream->iou_read_buf == NULL)
+      return 0;
+  }
+
+  stream->iou_read_off = 0;
+  if (!uv__iou_stream_read(stream->loop,
+                           stream,
+                           stream->iou_read_buf,
+                           UV__IOU_READ_SIZE)) {
+    return 0;  /* The ring is full. */
+  }
+
+  stream->iou_flags |= UV__IOU_STREAM_READ;
+  uv__io_stop(stream->loop, &stream->io_watcher, POLLIN);
+  return 1;
+}
+
+
+/* Arms the multishot recv of a pooled read. */
+static int uv__stream_iou_recv(uv_stream_t* stream) {
+  uv__io_stop(stream->loop, &stream->io_watcher, POLLIN);
+
+  if (!(stream->flags & UV_HANDLE_READING))
+    return 1;
+
+  /* Waiting for uv_buf_release(). */
+  if (!uv__queue_empty(&stream->iou_bufs_queue))
+    return 1;
+
+  if (uv__iou_stream_recv(stream->loop, stream))
+    stream->iou_flags |= UV__IOU_STREAM_READ | UV__IOU_STREAM_RECV;
+  else
+    uv__io_start(stream->loop, &stream->io_watcher, POLLIN);  /* Ring full. */
+
+  return 1;
+}
+
+
+/* Multishot accept. Accepted file descriptors are queued for uv_accept(). */
+static void uv__stream_iou_listen(uv_stream_t* stream) {
+  if (!(stream->iou_flags & UV__IOU_STREAM_ACCEPT)) {
+    if (!uv__stream_iou_enabled(stream))
+      return;
+
+    if (!uv__iou_stream_accept(stream->loop, stream))
+      return;  /* The ring is full. Accept the regular way. */
+
+    stream->iou_flags |= UV__IOU_STREAM_READ | UV__IOU_STREAM_ACCEPT;
+  }
+
+  uv__io_stop(stream->loop, &stream->io_watcher, POLLIN);
+}
+
+
+/* Reports the connections accepted by io_uring, one at a time as uv_accept()
+ * takes them, and resumes accepting once they're all taken.
+ */
+static void uv__stream_iou_connections(uv_stream_t* stream) {
+  while (stream->iou_flags & UV__IOU_STREAM_CONNECTION) {
+    stream->iou_flags &= ~UV__IOU_STREAM_CONNECTION;
+    stream->connection_cb(stream, 0);
+    if (uv__is_closing(stream))
+      return;
+  }
+
+  if (stream->queued_fds != NULL)
+    return;
+
+  if (stream->iou_flags & UV__IOU_STREAM_READ)
+    return;
+
+  if (uv__iou_stream_accept(stream->loop, stream)) {
+    stream->iou_flags |= UV__IOU_STREAM_READ;
+    return;
+  }
+
+  /* The ring is full. Accept the regular way. */
+  stream->iou_flags &= ~UV__IOU_STREAM_ACCEPT;
+  if (stream->accepted_fd == -1)
+    uv__io_start(stream->loop, &stream->io_watcher, POLLIN);
+}
+
+
+/* Returns 0 if the stream should wait for POLLOUT the regular way. */
+static int uv__stream_iou_write(uv_stream_t* stream, uv_write_t* req) {
+  if (!uv__stream_iou_enabled(stream))
+    return 0;
+
+  if (req->send_handle != NULL)
+    return 0;
+
+  if (stream->zc_threshold != 0)
+    return 0;  /* Zero-copy sends wait for POLLOUT. */
+
+  if (!uv__iou_stream_write(stream->loop,
+                            stream,
+                            req->bufs + req->write_index,
+                            req->nbufs - req->write_index)) {
+    return 0;
+  }
+
+  stream->iou_flags |= UV__IOU_STREAM_WRITE;
+  uv__io_stop(stream->loop, &stream->io_watcher, POLLOUT);
+  return 1;
+}
+#endif  /* defined(__linux__) */
+
+
+/* Writes the queued requests of a corked stream with one writev(), as much of
+ * them as fits in uv__getiovmax() buffers. Finishes the requests that were
+ * written in full. Sets `all` if everything that was tried went out.
+ */
+static ssize_t uv__write_gathered(uv_stream_t* stream, int* all) {
+  struct uv__queue* q;
+  uv_write_t* req;
+  unsigned int iovmax;
+  unsigned int iovcnt;
+  unsigned int n;
+  ssize_t nwritten;
+  size_t size;
+  size_t len;
+
+  iovmax = uv__getiovmax();
+  iovcnt = 0;
+
+  uv__queue_foreach(q, &stream->write_queue) {
+    req = uv__queue_data(q, uv_write_t, queue);
+    if (req->send_handle != NULL || iovcnt == iovmax)
+      break;
+
+    n = req->nbufs - req->write_index;
+    if (n > iovmax - iovcnt)
+      n = iovmax - iovcnt;
+
+    memcpy(stream->cork_bufs + iovcnt,
+           req->bufs + req->write_index,
+           n * sizeof(req->bufs[0]));
+    iovcnt += n;
+  }
+
+  nwritten = uv__try_write(stream, stream->cork_bufs, iovcnt, NULL, 0);
+  if (nwritten < 0)
+    return nwritten;
+
+  *all = (size_t) nwritten == uv__count_bufs(stream->cork_bufs, iovcnt);
+
+  size = nwritten;
+  while (!uv__queue_empty(&stream->write_queue)) {
+    q = uv__queue_head(&stream->write_queue);
+    req = uv__queue_data(q, uv_write_t, queue);
+    if (req->send_handle != NULL)
+      break;
+
+    len = uv__write_req_size(req);
+    if (len > size) {
+      if (size > 0)
+        uv__write_req_update(stream, req, size);
+      break;
+    }
+
+    uv__write_req_update(stream, req, len);
+    uv__write_req_finish(req);
+    size -= len;
+  }
+
+  return nwritten;
+}
+
+
 static void uv__write(uv_stream_t* stream) {
   struct uv__queue* q;
   uv_write_t* req;
   ssize_t n;
+  int zerocopy;
   int count;
+  int all;
 
   assert(uv__stream_fd(stream) >= 0);
 
+#if defined(__linux__)
+  /* The next write is tried when the one in flight completes. */
+  if (stream->iou_flags & UV__IOU_STREAM_WRITE) {
+    uv__io_stop(stream->loop, &stream->io_watcher, POLLOUT);
+    return;
+  }
+#endif
+
   /* Prevent loop starvation when the consumer of this stream read as fast as
    * (or faster than) we can write it. This `count` mechanism does not need to
    * change even if we switch to edge-triggered I/O.
@@ -884,10 +1438,36 @@ static void uv__write(uv_stream_t* stream) {
     req = uv__queue_data(q, uv_write_t, queue);
     assert(req->handle == stream);
 
+    zerocopy = 0;
+#if defined(__linux__)
+    if (stream->zc_threshold != 0 && req->send_handle == NULL)
+      zerocopy = uv__write_req_size(req) >= stream->zc_threshold;
+#endif
+
+    /* Corked, more than one request to write. */
+    if ((stream->flags & UV_HANDLE_CORKED) &&
+        req->send_handle == NULL &&
+        !zerocopy &&
+        uv__queue_next(q) != &stream->write_queue) {
+      n = uv__write_gathered(stream, &all);
+      if (n >= 0 && all) {
+        if (count-- > 0)
+          continue;
+
+        return;
+      }
+
+      if (n >= 0 || n == UV_EAGAIN)
+        goto wait;
+
+      goto error;
+    }
+
     n = uv__try_write(stream,
                       &(req->bufs[req->write_index]),
                       req->nbufs - req->write_index,
-                      req->send_handle);
+                      req->send_handle,
+                      zerocopy);
 
     /* Ensure the handle isn't sent again in case this is a partial write. */
     if (n >= 0) {
@@ -902,11 +1482,20 @@ static void uv__write(uv_stream_t* stream) {
     } else if (n != UV_EAGAIN)
       goto error;
 
+wait:
     /* If this is a blocking stream, try again. */
     if (stream->flags & UV_HANDLE_BLOCKING_WRITES)
       continue;
 
+#if defined(__linux__)
+    q = uv__queue_head(&stream->write_queue);
+    req = uv__queue_data(q, uv_write_t, queue);
+    if (uv__stream_iou_write(stream, req))
+      return;
+#endif
+
     /* We're not done. */
+    uv__io_drained(&stream->io_watcher, POLLOUT);
     uv__io_start(stream->loop, &stream->io_watcher, POLLOUT);
 
     /* Notify select() thread about state change */
@@ -954,16 +1543,71 @@ static void uv__write_callbacks(uv_stream_t* stream) {
 }
 
 
-static void uv__stream_eof(uv_stream_t* stream, const uv_buf_t* buf) {
-  stream->flags |= UV_HANDLE_READ_EOF;
-  stream->flags &= ~UV_HANDLE_READING;
-  uv__io_stop(stream->loop, &stream->io_watcher, POLLIN);
-  uv__handle_stop(stream);
-  uv__stream_osx_interrupt_select(stream);
-  stream->read_cb(stream, UV_EOF, buf);
-}
-
-
+#if defined(__linux__)
+/* The kernel reports on the socket's error queue when it's done with the
+ * pages of zero-copy sends, as a range of send numbers. TCP completes them in
+ * order. Requests on zc_queue have the number of sends made before they
+ * finished in write_index and complete when all of those have.
+ */
+static void uv__stream_zc_reap(uv_stream_t* stream) {
+  struct sock_extended_err* serr;
+  struct cmsghdr* cmsg;
+  union uv__cmsg control;
+  struct msghdr msg;
+  uv_write_t* req;
+  struct uv__queue* q;
+
+  for (;;) {
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_control = &control.hdr;
+    msg.msg_controllen = sizeof(control);
+
+    if (uv__recvmsg(uv__stream_fd(stream), &msg, MSG_ERRQUEUE) < 0)
+      break;  /* UV_EAGAIN, nothing left. */
+
+    for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if (!(cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) &&
+          !(cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR))
+        continue;
+
+      serr = (struct sock_extended_err*) CMSG_DATA(cmsg);
+      if (serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+        continue;
+
+      /* Sends ee_info through ee_data are done. */
+      if ((int) (serr->ee_data + 1 - stream->zc_done) > 0)
+        stream->zc_done = serr->ee_data + 1;
+    }
+  }
+
+  while (!uv__queue_empty(&stream->zc_queue)) {
+    q = uv__queue_head(&stream->zc_queue);
+    req = uv__queue_data(q, uv_write_t, queue);
+    if ((int) (req->write_index - stream->zc_done) > 0)
+      return;
+
+    uv__queue_remove(q);
+    uv__queue_insert_tail(&stream->write_completed_queue, q);
+    uv__io_feed(stream->loop, &stream->io_watcher);
+  }
+
+  uv__io_stop(stream->loop, &stream->io_watcher, UV__POLLPRI);
+}
+#endif
+
+
+static void uv__stream_eof(uv_stream_t* stream,
+                           const uv_buf_t* bufs,
+                           unsigned int nbufs) {
+  stream->flags |= UV_HANDLE_READ_EOF;
+  stream->flags &= ~UV_HANDLE_READING;
+  uv__io_stop(stream->loop, &stream->io_watcher, POLLIN);
+  uv__handle_stop(stream);
+  uv__stream_osx_interrupt_select(stream);
+  uv__stream_read_cb(stream, UV_EOF, bufs, nbufs);
+}
+
+
 static int uv__stream_queue_fd(uv_stream_t* stream, int fd) {
   uv__stream_queued_fds_t* queued_fds;
   unsigned int queue_size;
@@ -1043,53 +1687,142 @@ static int uv__stream_recv_cmsg(uv_stream_t* stream, struct msghdr* msg) {
 }
 
 
+/* UV_LOOP_READ_BUDGET: returns 1 when the stream has had its share of this
+ * loop iteration. `start` is when it would have started reading if it had
+ * read all in one go.
+ */
+static int uv__read_budget_spent(uv_stream_t* stream, uint64_t start) {
+  uv__loop_internal_fields_t* lfields;
+
+  lfields = uv__get_internal_fields(stream->loop);
+
+  if (lfields->read_budget.bytes != 0)
+    if (stream->read_budget_bytes >= lfields->read_budget.bytes)
+      return 1;
+
+  if (lfields->read_budget.time != 0) {
+    stream->read_budget_time = uv__hrtime(UV_CLOCK_FAST) - start;
+    if (stream->read_budget_time >= lfields->read_budget.time)
+      return 1;
+  }
+
+  return 0;
+}
+
+
+/* Queues the stream for the next loop iteration, ahead of the next poll. Not
+ * for the pending callbacks of this one, they run more than once.
+ */
+static void uv__read_budget_next(uv_stream_t* stream) {
+  uv__loop_internal_fields_t* lfields;
+  uv__io_t* w;
+
+  lfields = uv__get_internal_fields(stream->loop);
+  w = &stream->io_watcher;
+
+  stream->flags |= UV_HANDLE_READ_BUDGET;
+  uv__queue_remove(&w->pending_queue);
+  uv__queue_insert_tail(&lfields->read_budget.next, &w->pending_queue);
+}
+
+
 static void uv__read(uv_stream_t* stream) {
-  uv_buf_t buf;
+  uv__loop_internal_fields_t* lfields;
+  uv_buf_t bufs[UV_READ_BUFS_MAX];
+  unsigned int nbufs;
+  size_t buflen;
+  size_t left;
+  unsigned int i;
   ssize_t nread;
   struct msghdr msg;
   union uv__cmsg cmsg;
+  uint64_t start;
+  int budget;
   int count;
   int err;
   int is_ipc;
 
   stream->flags &= ~UV_HANDLE_READ_PARTIAL;
 
+#if defined(__linux__)
+  if (uv__stream_iou_read(stream))
+    return;
+#endif
+
   /* Prevent loop starvation when the data comes in as fast as (or faster than)
-   * we can read it. XXX Need to rearm fd if we switch to edge-triggered I/O.
+   * we can read it. A UV_LOOP_READ_BUDGET replaces the fixed count.
    */
-  count = 32;
+  lfields = uv__get_internal_fields(stream->loop);
+  budget = lfields->read_budget.bytes != 0 || lfields->read_budget.time != 0;
+  count = budget ? INT_MAX : 32;
+  start = 0;
+
+  if (budget) {
+    if (stream->read_budget_tick != lfields->read_budget.tick) {
+      stream->read_budget_tick = lfields->read_budget.tick;
+      stream->read_budget_bytes = 0;
+      stream->read_budget_time = 0;
+    }
+
+    if (lfields->read_budget.time != 0)
+      start = uv__hrtime(UV_CLOCK_FAST) - stream->read_budget_time;
+
+    /* Read already in this loop iteration. */
+    if (uv__read_budget_spent(stream, start)) {
+      if (stream->flags & UV_HANDLE_READING)
+        uv__read_budget_next(stream);
+      return;
+    }
+
+    stream->flags &= ~UV_HANDLE_READ_BUDGET;
+  }
 
   is_ipc = stream->type == UV_NAMED_PIPE && ((uv_pipe_t*) stream)->ipc;
 
   /* XXX: Maybe instead of having UV_HANDLE_READING we just test if
    * tcp->read_cb is NULL or not?
    */
-  while (stream->read_cb
+  while ((stream->read_cb || stream->read_bufs_cb)
       && (stream->flags & UV_HANDLE_READING)
       && (count-- > 0)) {
-    assert(stream->alloc_cb != NULL);
-
-    buf = uv_buf_init(NULL, 0);
-    stream->alloc_cb((uv_handle_t*)stream, 64 * 1024, &buf);
-    if (buf.base == NULL || buf.len == 0) {
+    if (stream->flags & UV_HANDLE_READ_POOLED) {
+      bufs[0] = uv_buf_init(NULL, 0);
+      nbufs = 1;
+      uv__buf_pool_get(stream->loop, &bufs[0]);
+    } else if (uv__stream_alloc(stream, 64 * 1024, bufs, &nbufs)) {
       /* User indicates it can't or won't handle the read. */
-      stream->read_cb(stream, UV_ENOBUFS, &buf);
-      return;
+      uv__stream_read_cb(stream, UV_ENOBUFS, bufs, nbufs);
+      break;
     }
 
-    assert(buf.base != NULL);
+    assert(bufs[0].base != NULL);
     assert(uv__stream_fd(stream) >= 0);
 
+    /* No more than what's left of the budget. */
+    if (lfields->read_budget.bytes != 0) {
+      left = lfields->read_budget.bytes - stream->read_budget_bytes;
+      for (i = 0; i < nbufs; i++) {
+        if (bufs[i].len > left)
+          bufs[i].len = left;
+        left -= bufs[i].len;
+      }
+    }
+
+    buflen = uv__count_bufs(bufs, nbufs);
+
     if (!is_ipc) {
       do {
-        nread = read(uv__stream_fd(stream), buf.base, buf.len);
+        if (nbufs == 1)
+          nread = read(uv__stream_fd(stream), bufs[0].base, bufs[0].len);
+        else
+          nread = readv(uv__stream_fd(stream), (struct iovec*) bufs, nbufs);
       }
       while (nread < 0 && errno == EINTR);
     } else {
       /* ipc uses recvmsg */
       msg.msg_flags = 0;
-      msg.msg_iov = (struct iovec*) &buf;
-      msg.msg_iovlen = 1;
+      msg.msg_iov = (struct iovec*) bufs;
+      msg.msg_iovlen = nbufs;
       msg.msg_name = NULL;
       msg.msg_namelen = 0;
       /* Set up to receive a descriptor even if one isn't in the message */
@@ -1102,24 +1835,33 @@ static void uv__read(uv_stream_t* stream) {
       while (nread < 0 && errno == EINTR);
     }
 
+    /* Pooled reads lend the buffer only when it holds data. */
+    if (nread <= 0 && stream->flags & UV_HANDLE_READ_POOLED) {
+      err = errno;
+      uv_buf_release(stream->loop, &bufs[0]);
+      bufs[0] = uv_buf_init(NULL, 0);
+      errno = err;
+    }
+
     if (nread < 0) {
       /* Error */
       if (errno == EAGAIN || errno == EWOULDBLOCK) {
         /* Wait for the next one. */
+        uv__io_drained(&stream->io_watcher, POLLIN);
         if (stream->flags & UV_HANDLE_READING) {
           uv__io_start(stream->loop, &stream->io_watcher, POLLIN);
           uv__stream_osx_interrupt_select(stream);
         }
-        stream->read_cb(stream, 0, &buf);
+        uv__stream_read_cb(stream, 0, bufs, nbufs);
 #if defined(__CYGWIN__) || defined(__MSYS__)
       } else if (errno == ECONNRESET && stream->type == UV_NAMED_PIPE) {
-        uv__stream_eof(stream, &buf);
+        uv__stream_eof(stream, bufs, nbufs);
         return;
 #endif
       } else {
         /* Error. User should call uv_close(). */
         stream->flags &= ~(UV_HANDLE_READABLE | UV_HANDLE_WRITABLE);
-        stream->read_cb(stream, UV__ERR(errno), &buf);
+        uv__stream_read_cb(stream, UV__ERR(errno), bufs, nbufs);
         if (stream->flags & UV_HANDLE_READING) {
           stream->flags &= ~UV_HANDLE_READING;
           uv__io_stop(stream->loop, &stream->io_watcher, POLLIN);
@@ -1129,16 +1871,17 @@ static void uv__read(uv_stream_t* stream) {
       }
       return;
     } else if (nread == 0) {
-      uv__stream_eof(stream, &buf);
+      uv__stream_eof(stream, bufs, nbufs);
       return;
     } else {
       /* Successful read */
-      ssize_t buflen = buf.len;
+      if (budget)
+        stream->read_budget_bytes += nread;
 
       if (is_ipc) {
         err = uv__stream_recv_cmsg(stream, &msg);
         if (err != 0) {
-          stream->read_cb(stream, err, &buf);
+          uv__stream_read_cb(stream, err, bufs, nbufs);
           return;
         }
       }
@@ -1158,7 +1901,7 @@ static void uv__read(uv_stream_t* stream) {
           nread = uv__recvmsg(uv__stream_fd(stream), &msg, 0);
           err = uv__stream_recv_cmsg(stream, &msg);
           if (err != 0) {
-            stream->read_cb(stream, err, &buf);
+            uv__stream_read_cb(stream, err, bufs, nbufs);
             msg.msg_iov = old;
             return;
           }
@@ -1166,15 +1909,30 @@ static void uv__read(uv_stream_t* stream) {
         msg.msg_iov = old;
       }
 #endif
-      stream->read_cb(stream, nread, &buf);
+      uv__stream_read_cb(stream, nread, bufs, nbufs);
 
       /* Return if we didn't fill the buffer, there is no more data to read. */
-      if (nread < buflen) {
+      if ((size_t) nread < buflen) {
         stream->flags |= UV_HANDLE_READ_PARTIAL;
+        uv__io_drained(&stream->io_watcher, POLLIN);
+        break;
+      }
+
+      if (budget && uv__read_budget_spent(stream, start)) {
+        if (stream->flags & UV_HANDLE_READING)
+          uv__read_budget_next(stream);
         return;
       }
     }
   }
+
+  /* Edge-triggered, the kernel won't report the rest of the data, or the EOF
+   * after a hangup.
+   */
+  if ((stream->flags & UV_HANDLE_READING) &&
+      (uv__io_ready(&stream->io_watcher) & POLLIN)) {
+    uv__io_feed(stream->loop, &stream->io_watcher);
+  }
 }
 
 
@@ -1224,6 +1982,24 @@ static void uv__stream_io(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
 
   assert(uv__stream_fd(stream) >= 0);
 
+#if defined(__linux__)
+  /* Fed by uv__read_start() or uv__stream_iou_read(). */
+  if (uv__stream_iou_pending(stream))
+    events |= POLLIN;
+
+  /* Zero-copy completions, they make the socket report POLLERR. */
+  if (events & (POLLERR | UV__POLLPRI) && !uv__queue_empty(&stream->zc_queue))
+    uv__stream_zc_reap(stream);
+#endif
+
+  /* Fed by uv__io_start() or uv__read(), see UV_LOOP_EDGE_TRIGGERED. */
+  if (uv__io_ready(w) & w->pevents & POLLIN)
+    events |= POLLIN;
+
+  /* Out of budget in the previous loop iteration, see uv__read(). */
+  if (stream->flags & UV_HANDLE_READ_BUDGET)
+    events |= POLLIN;
+
   /* Ignore POLLHUP here. Even if it's set, there may still be data to read. */
   if (events & (POLLIN | POLLERR | POLLHUP))
     uv__read(stream);
@@ -1242,7 +2018,7 @@ static void uv__stream_io(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
       (stream->flags & UV_HANDLE_READ_PARTIAL) &&
       !(stream->flags & UV_HANDLE_READ_EOF)) {
     uv_buf_t buf = { NULL, 0 };
-    uv__stream_eof(stream, &buf);
+    uv__stream_eof(stream, &buf, 0);
   }
 
   if (uv__stream_fd(stream) == -1)
@@ -1402,6 +2178,10 @@ int uv_write2(uv_write_t* req,
   if (stream->connect_req) {
     /* Still connecting, do nothing. */
   }
+  else if (empty_queue && (stream->flags & UV_HANDLE_CORKED)) {
+    /* Written with what else is queued by then, see uv_stream_set_cork(). */
+    uv__io_feed(stream->loop, &stream->io_watcher);
+  }
   else if (empty_queue) {
     uv__write(stream);
   }
@@ -1412,6 +2192,10 @@ int uv_write2(uv_write_t* req,
      * sufficiently flushed in uv__write.
      */
     assert(!(stream->flags & UV_HANDLE_BLOCKING_WRITES));
+#if defined(__linux__)
+    if (stream->iou_flags & UV__IOU_STREAM_WRITE)
+      return 0;  /* Submitted when the write in flight completes. */
+#endif
     uv__io_start(stream->loop, &stream->io_watcher, POLLOUT);
     uv__stream_osx_interrupt_select(stream);
   }
@@ -1453,36 +2237,195 @@ int uv_try_write2(uv_stream_t* stream,
   if (err < 0)
     return err;
 
-  return uv__try_write(stream, bufs, nbufs, send_handle);
+  return uv__try_write(stream, bufs, nbufs, send_handle, 0);
 }
 
 
-int uv__read_start(uv_stream_t* stream,
-                   uv_alloc_cb alloc_cb,
-                   uv_read_cb read_cb) {
+/* UV_LOOP_EDGE_TRIGGERED: register the file descriptor for good when it
+ * starts reading, see uv__io_start(). Not if it's watched already, e.g. for
+ * writes, and not when io_uring does the reading.
+ */
+static void uv__stream_edge_triggered(uv_stream_t* stream) {
+  uv__io_t* w;
+
+  w = &stream->io_watcher;
+  if (!(stream->loop->flags & UV_LOOP_EDGE_TRIGGERED_IO))
+    return;
+
+  if (w->events != 0 || w->pevents != 0)
+    return;
+
+#if defined(__linux__)
+  if (uv__stream_iou_enabled(stream))
+    return;
+#endif
+
+  w->events = UV__POLLET;
+}
+
+
+static int uv__read_start_watcher(uv_stream_t* stream) {
   assert(stream->type == UV_TCP || stream->type == UV_NAMED_PIPE ||
       stream->type == UV_TTY);
 
   /* The UV_HANDLE_READING flag is irrelevant of the state of the stream - it
    * just expresses the desired state of the user. */
   stream->flags |= UV_HANDLE_READING;
-  stream->flags &= ~UV_HANDLE_READ_EOF;
+  stream->flags &= ~(UV_HANDLE_READ_EOF | UV_HANDLE_READ_POOLED);
+#if defined(__linux__)
+  stream->iou_flags &= ~UV__IOU_STREAM_RING;
+#endif
 
   /* TODO: try to do the read inline? */
   assert(uv__stream_fd(stream) >= 0);
+
+  uv__stream_edge_triggered(stream);
+  uv__io_start(stream->loop, &stream->io_watcher, POLLIN);
+  uv__handle_start(stream);
+  uv__stream_osx_interrupt_select(stream);
+
+#if defined(__linux__)
+  /* Data read ahead, see uv__stream_iou_read(). */
+  if (uv__stream_iou_pending(stream))
+    uv__io_feed(stream->loop, &stream->io_watcher);
+#endif
+
+  return 0;
+}
+
+
+int uv__read_start(uv_stream_t* stream,
+                   uv_alloc_cb alloc_cb,
+                   uv_read_cb read_cb) {
   assert(alloc_cb);
 
+  stream->flags &= ~UV_HANDLE_READ_BUFS;
   stream->read_cb = read_cb;
   stream->alloc_cb = alloc_cb;
+  stream->read_bufs_cb = NULL;
+  stream->alloc_bufs_cb = NULL;
+
+  return uv__read_start_watcher(stream);
+}
 
+
+/* Like uv__read_start(), but with readv() into the buffers of alloc_cb. They
+ * are handed to read_cb as they are, the data fills them in order.
+ */
+int uv__read_start_bufs(uv_stream_t* stream,
+                        uv_alloc_bufs_cb alloc_cb,
+                        uv_read_bufs_cb read_cb) {
+  stream->flags |= UV_HANDLE_READ_BUFS;
+  stream->read_cb = NULL;
+  stream->alloc_cb = NULL;
+  stream->read_bufs_cb = read_cb;
+  stream->alloc_bufs_cb = alloc_cb;
+
+  return uv__read_start_watcher(stream);
+}
+
+
+#if defined(__linux__)
+/* Returns 0 if pooled reads can use the loop's io_uring buffers. */
+static int uv__stream_iou_ring(uv_stream_t* stream) {
+  struct stat s;
+
+  if (uv__get_internal_fields(stream->loop)->bufs.count == 0)
+    return UV_EINVAL;  /* No UV_LOOP_IO_URING_BUFFERS. */
+
+  if (!uv__stream_iou_enabled(stream))
+    return UV_ENOTSUP;
+
+  /* Multishot recv wants a socket. */
+  if (stream->type == UV_NAMED_PIPE) {
+    if (uv__fstat(uv__stream_fd(stream), &s))
+      return UV__ERR(errno);
+
+    if (!S_ISSOCK(s.st_mode))
+      return UV_ENOTSUP;
+  }
+
+  return 0;
+}
+#endif
+
+
+int uv__read_start_pooled(uv_stream_t* stream, uv_read_cb read_cb) {
+  int err;
+
+#if defined(__linux__)
+  err = uv__stream_iou_ring(stream);
+  if (err == 0) {
+    stream->flags |= UV_HANDLE_READING | UV_HANDLE_READ_POOLED;
+    stream->flags &= ~(UV_HANDLE_READ_EOF | UV_HANDLE_READ_BUFS);
+    stream->iou_flags |= UV__IOU_STREAM_RING;
+    stream->read_cb = read_cb;
+    stream->alloc_cb = NULL;
+    uv__handle_start(stream);
+
+    if (uv__stream_iou_pending(stream))
+      uv__io_feed(stream->loop, &stream->io_watcher);
+    else if (!(stream->iou_flags & UV__IOU_STREAM_READ))
+      uv__stream_iou_recv(stream);
+
+    return 0;
+  }
+#else
+  err = UV_EINVAL;
+#endif
+
+  if (uv__get_internal_fields(stream->loop)->buf_pool.count == 0)
+    return err;  /* No UV_LOOP_BUFFER_POOL either. */
+
+  /* File descriptors come along with the data. */
+  if (stream->type == UV_NAMED_PIPE && ((uv_pipe_t*) stream)->ipc)
+    return UV_ENOTSUP;
+
+  stream->flags |= UV_HANDLE_READING | UV_HANDLE_READ_POOLED;
+  stream->flags &= ~(UV_HANDLE_READ_EOF | UV_HANDLE_READ_BUFS);
+  stream->read_cb = read_cb;
+  stream->alloc_cb = NULL;
+
+  uv__stream_edge_triggered(stream);
   uv__io_start(stream->loop, &stream->io_watcher, POLLIN);
   uv__handle_start(stream);
   uv__stream_osx_interrupt_select(stream);
 
+#if defined(__linux__)
+  /* Data read ahead, see uv__stream_iou_read(). */
+  if (uv__stream_iou_pending(stream))
+    uv__io_feed(stream->loop, &stream->io_watcher);
+#endif
+
   return 0;
 }
 
 
+void uv_buf_release(uv_loop_t* loop, const uv_buf_t* buf) {
+#if defined(__linux__)
+  struct uv__queue* q;
+
+  if (uv__iou_buf_put(loop, buf->base)) {
+    /* Resume a stream that ran out of buffers. */
+    q = &uv__get_internal_fields(loop)->bufs.waiting;
+    if (!uv__queue_empty(q)) {
+      q = uv__queue_head(q);
+      uv__queue_remove(q);
+      uv__queue_init(q);
+      uv__stream_iou_recv(uv__queue_data(q, uv_stream_t, iou_bufs_queue));
+    }
+    return;
+  }
+#endif
+
+  if (uv__buf_pool_put(loop, buf->base))
+    return;
+
+  /* A pool miss, or data read ahead, see uv__stream_iou_lend(). */
+  uv__free(buf->base);
+}
+
+
 int uv_read_stop(uv_stream_t* stream) {
   if (!(stream->flags & UV_HANDLE_READING))
     return 0;
@@ -1491,9 +2434,22 @@ int uv_read_stop(uv_stream_t* stream) {
   uv__io_stop(stream->loop, &stream->io_watcher, POLLIN);
   uv__handle_stop(stream);
   uv__stream_osx_interrupt_select(stream);
+  stream->flags &= ~UV_HANDLE_READ_POOLED;
+
+#if defined(__linux__)
+  stream->iou_flags &= ~UV__IOU_STREAM_RING;
+  uv__stream_iou_cancel(stream, UV__IOU_STREAM_READ);
+
+  if (!uv__queue_empty(&stream->iou_bufs_queue)) {
+    uv__queue_remove(&stream->iou_bufs_queue);
+    uv__queue_init(&stream->iou_bufs_queue);
+  }
+#endif
 
   stream->read_cb = NULL;
   stream->alloc_cb = NULL;
+  stream->read_bufs_cb = NULL;
+  stream->alloc_bufs_cb = NULL;
   return 0;
 }
 
@@ -1555,6 +2511,24 @@ void uv__stream_close(uv_stream_t* handle) {
   uv__handle_stop(handle);
   handle->flags &= ~(UV_HANDLE_READABLE | UV_HANDLE_WRITABLE);
 
+#if defined(__linux__)
+  uv__stream_iou_cancel(handle, UV__IOU_STREAM_WRITE);
+
+  /* Stop accepting right away. The socket keeps listening for as long as the
+   * kernel holds on to it, even after the file descriptor is closed.
+   */
+  if (handle->iou_flags & UV__IOU_STREAM_ACCEPT) {
+    uv__stream_iou_cancel(handle, UV__IOU_STREAM_READ);
+    uv__iou_stream_flush(handle->loop);
+  }
+
+  /* If the ring was too full to cancel, make the operations fail instead.
+   * Closing the file descriptor doesn't, the kernel holds a reference.
+   */
+  if (handle->iou_flags & ~(handle->iou_flags >> 2) & 3)
+    shutdown(handle->io_watcher.fd, SHUT_RDWR);
+#endif
+
   if (handle->io_watcher.fd != -1) {
     /* Don't close stdio file descriptors.  Nothing good comes from it. */
     if (handle->io_watcher.fd > STDERR_FILENO)
@@ -1580,9 +2554,257 @@ void uv__stream_close(uv_stream_t* handle) {
 }
 
 
+#if defined(__linux__)
+static void uv__stream_iou_read_done(uv_stream_t* stream, int res) {
+  uv_buf_t bufs[UV_READ_BUFS_MAX];
+  unsigned int nbufs;
+
+  if (res > 0) {
+    stream->iou_read_len = res;
+    if (uv__is_closing(stream))
+      stream->iou_read_len = 0;
+  }
+
+  /* Stopped or closed while in flight. EOF and errors are seen again by the
+   * next read.
+   */
+  if (!(stream->flags & UV_HANDLE_READING))
+    return;
+
+  if (res > 0 || res == UV_ECANCELED || res == UV_EINTR) {
+    uv__read(stream);
+    return;
+  }
+
+  if (res == UV_EAGAIN) {
+    /* Kernels that don't wait for O_NONBLOCK files. Wait for epoll. */
+    uv__io_start(stream->loop, &stream->io_watcher, POLLIN);
+    return;
+  }
+
+  /* Pooled reads get no buffer with EOF and errors. */
+  bufs[0] = uv_buf_init(NULL, 0);
+  nbufs = 0;
+  if (!(stream->flags & UV_HANDLE_READ_POOLED))
+    uv__stream_alloc(stream, 64 * 1024, bufs, &nbufs);
+
+  if (res == 0) {
+    uv__stream_eof(stream, bufs, nbufs);
+    return;
+  }
+
+  /* Error. User should call uv_close(). */
+  stream->flags &= ~(UV_HANDLE_READABLE | UV_HANDLE_WRITABLE);
+  uv__stream_read_cb(stream, res, bufs, nbufs);
+  if (stream->flags & UV_HANDLE_READING) {
+    stream->flags &= ~UV_HANDLE_READING;
+    uv__handle_stop(stream);
+  }
+}
+
+
+static void uv__stream_iou_write_done(uv_stream_t* stream, int res) {
+  uv_write_t* req;
+
+  /* uv__stream_destroy() cancels the write requests. */
+  if (uv__is_closing(stream))
+    return;
+
+  assert(!uv__queue_empty(&stream->write_queue));
+  req = uv__queue_data(uv__queue_head(&stream->write_queue), uv_write_t, queue);
+
+  if (res >= 0) {
+    if (uv__write_req_update(stream, req, res))
+      uv__write_req_finish(req);
+    uv__write(stream);
+  } else if (res == UV_EINTR) {
+    uv__write(stream);
+  } else if (res == UV_EAGAIN) {
+    /* Kernels that don't wait for O_NONBLOCK files. Wait for epoll. */
+    uv__io_start(stream->loop, &stream->io_watcher, POLLOUT);
+  } else {
+    req->error = res;
+    uv__write_req_finish(req);
+  }
+
+  uv__write_callbacks(stream);
+
+  /* Write queue drained. */
+  if (uv__queue_empty(&stream->write_queue))
+    uv__drain(stream);
+}
+
+
+static void uv__stream_iou_accept_done(uv_stream_t* stream, int res) {
+  uv__stream_queued_fds_t* queued_fds;
+
+  if (uv__is_closing(stream)) {
+    if (res >= 0)
+      uv__close(res);
+    return;
+  }
+
+  if (res >= 0) {
+    if (stream->accepted_fd == -1) {
+      stream->accepted_fd = res;
+      stream->iou_flags |= UV__IOU_STREAM_CONNECTION;
+    } else if (uv__stream_queue_fd(stream, res)) {
+      uv__close(res);  /* Out of memory, shed load. */
+    }
+
+    /* The user doesn't keep up. Leave connections in the kernel's backlog
+     * until uv_accept() catches up, like the regular way does.
+     */
+    queued_fds = (uv__stream_queued_fds_t*) stream->queued_fds;
+    if (queued_fds != NULL && queued_fds->offset >= 64)
+      uv__stream_iou_cancel(stream, UV__IOU_STREAM_READ);
+  } else if (res == UV_EINVAL) {
+    /* No multishot accept before Linux 5.19. Accept the regular way. */
+    stream->iou_flags &= ~UV__IOU_STREAM_ACCEPT;
+    if (stream->accepted_fd == -1)
+      uv__io_start(stream->loop, &stream->io_watcher, POLLIN);
+    return;
+  } else if (res == UV_EMFILE || res == UV_ENFILE) {
+    uv__emfile_trick(stream->loop, uv__stream_fd(stream));  /* Shed load. */
+  }
+
+  uv__stream_iou_connections(stream);
+}
+
+
+static void uv__stream_iou_recv_done(uv_stream_t* stream,
+                                     int res,
+                                     int more,
+                                     char* data) {
+  struct uv__iou_bufs* bufs;
+  uv_buf_t buf;
+
+  if (data != NULL) {
+    buf = uv_buf_init(data, res);
+
+    if ((stream->flags & (UV_HANDLE_READING | UV_HANDLE_READ_POOLED)) !=
+        (UV_HANDLE_READING | UV_HANDLE_READ_POOLED)) {
+      /* Stopped, closed or switched to uv_read_start() while in flight. */
+      if (!uv__is_closing(stream))
+        uv__stream_iou_set_aside(stream, data, res);
+      uv_buf_release(stream->loop, &buf);
+
+      /* In case the ring was too full to cancel in uv_read_stop(). */
+      if (!(stream->flags & UV_HANDLE_READING))
+        uv__stream_iou_cancel(stream, UV__IOU_STREAM_READ);
+    } else if (stream->iou_read_len > 0) {
+      /* Read again while in flight. The data read ahead goes first. */
+      uv__stream_iou_set_aside(stream, data, res);
+      uv_buf_release(stream->loop, &buf);
+      uv__stream_iou_lend(stream);
+    } else {
+      stream->read_cb(stream, res, &buf);
+    }
+
+    if (more)
+      return;
+  }
+
+  stream->iou_flags &= ~UV__IOU_STREAM_RECV;
+
+  /* Stopped or closed while in flight. EOF and errors are seen again by the
+   * next read.
+   */
+  if (!(stream->flags & UV_HANDLE_READING))
+    return;
+
+  bufs = &uv__get_internal_fields(stream->loop)->bufs;
+  if (res == UV_ENOBUFS &&
+      stream->iou_flags & UV__IOU_STREAM_RING &&
+      bufs->lent == bufs->count) {
+    /* All buffers are out. Wait for uv_buf_release(). */
+    uv__queue_insert_tail(&bufs->waiting, &stream->iou_bufs_queue);
+    return;
+  }
+
+  /* uv__read() takes it from here. It sees errors and EOF again unless the
+   * stream reads with buffers from the ring.
+   */
+  if (!(stream->iou_flags & UV__IOU_STREAM_RING) ||
+      res > 0 ||
+      res == UV_ENOBUFS ||
+      res == UV_ECANCELED ||
+      res == UV_EINTR) {
+    uv__read(stream);
+    return;
+  }
+
+  buf = uv_buf_init(NULL, 0);
+
+  if (res == 0) {
+    uv__stream_eof(stream, &buf, 0);
+    return;
+  }
+
+  /* Error. User should call uv_close(). */
+  stream->flags &= ~(UV_HANDLE_READABLE | UV_HANDLE_WRITABLE);
+  stream->read_cb(stream, res, &buf);
+  if (stream->flags & UV_HANDLE_READING) {
+    stream->flags &= ~UV_HANDLE_READING;
+    uv__handle_stop(stream);
+  }
+}
+
+
+void uv__stream_iou_done(uv_stream_t* stream,
+                         unsigned int op,
+                         int res,
+                         int more,
+                         char* buf) {
+  if (!more)
+    stream->iou_flags &= ~(op | op << 2);
+
+  if (stream->iou_flags & UV__IOU_STREAM_ACCEPT)
+    uv__stream_iou_accept_done(stream, res);
+  else if (op == UV__IOU_STREAM_READ &&
+           stream->iou_flags & UV__IOU_STREAM_RECV)
+    uv__stream_iou_recv_done(stream, res, more, buf);
+  else if (op == UV__IOU_STREAM_READ)
+    uv__stream_iou_read_done(stream, res);
+  else
+    uv__stream_iou_write_done(stream, res);
+}
+#endif  /* defined(__linux__) */
+
+
 int uv_stream_set_blocking(uv_stream_t* handle, int blocking) {
   /* Don't need to check the file descriptor, uv__nonblock()
    * will fail with EBADF if it's not valid.
    */
   return uv__nonblock(uv__stream_fd(handle), !blocking);
 }
+
+
+/* Writes wait for the pending callbacks, that run after the callbacks of this
+ * loop iteration's events, and go out together. See uv__write_gathered().
+ */
+int uv_stream_set_cork(uv_stream_t* handle, int enable) {
+  if (enable == 0) {
+    if (!(handle->flags & UV_HANDLE_CORKED))
+      return 0;
+
+    if (handle->connect_req == NULL && uv__stream_fd(handle) != -1)
+      if (!uv__queue_empty(&handle->write_queue))
+        uv__write(handle);
+
+    handle->flags &= ~UV_HANDLE_CORKED;
+    return 0;
+  }
+
+  if (handle->flags & UV_HANDLE_BLOCKING_WRITES)
+    return UV_EINVAL;
+
+  if (handle->cork_bufs == NULL) {
+    handle->cork_bufs = uv__malloc(uv__getiovmax() * sizeof(uv_buf_t));
+    if (handle->cork_bufs == NULL)
+      return UV_ENOMEM;
+  }
+
+  handle->flags |= UV_HANDLE_CORKED;
+  return 0;
+}
@@ -39,6 +39,14 @@
 #include <ifaddrs.h>
 #endif
 
+#if defined(__linux__)
+#include <linux/filter.h>
+
+#ifndef SO_ATTACH_REUSEPORT_CBPF
+#define SO_ATTACH_REUSEPORT_CBPF 51
+#endif
+#endif
+
 static int maybe_bind_socket(int fd) {
   union uv__sockaddr s;
   socklen_t slen;
@@ -171,6 +179,12 @@ int uv__tcp_bind(uv_tcp_t* tcp,
   if (setsockopt(tcp->io_watcher.fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)))
     return UV__ERR(errno);
 
+  if (flags & UV_TCP_REUSEPORT) {
+    err = uv__sock_reuseport(tcp->io_watcher.fd);
+    if (err)
+      return err;
+  }
+
 #ifndef __OpenBSD__
 #ifdef IPV6_V6ONLY
   if (addr->sa_family == AF_INET6) {
@@ -424,6 +438,102 @@ int uv__tcp_listen(uv_tcp_t* tcp, int backlog, uv_connection_cb cb) {
 }
 
 
+#if defined(__linux__)
+/* The program returns the number of the CPU that received the connection
+ * modulo `count`. The kernel takes that as an index into the reuseport group,
+ * whose sockets are in the order they started listening, so connections from
+ * CPU n go to handles[n % count]. That is only the listener of the CPU that
+ * received the connection when the thread running loops[i] is pinned to
+ * CPU i.
+ */
+static int uv__tcp_reuseport_cpu(int fd, unsigned int count) {
+  struct sock_filter code[] = {
+    { BPF_LD | BPF_W | BPF_ABS, 0, 0, SKF_AD_OFF + SKF_AD_CPU },
+    { BPF_ALU | BPF_MOD | BPF_K, 0, 0, 0 },
+    { BPF_RET | BPF_A, 0, 0, 0 },
+  };
+  struct sock_fprog prog;
+
+  code[1].k = count;
+  prog.len = ARRAY_SIZE(code);
+  prog.filter = code;
+
+  if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)))
+    return UV__ERR(errno);
+
+  return 0;
+}
+#endif
+
+
+int uv_tcp_listen_reuseport(uv_loop_t* loops[],
+                            uv_tcp_t handles[],
+                            unsigned int count,
+                            const struct sockaddr* addr,
+                            unsigned int flags,
+                            int backlog,
+                            uv_connection_cb cb) {
+#if defined(__linux__)
+  struct sockaddr_storage name;
+  const struct sockaddr* bind_addr;
+  unsigned int bind_flags;
+  unsigned int i;
+  int namelen;
+  int err;
+
+  if (count == 0 || (flags & ~(UV_TCP_IPV6ONLY | UV_TCP_REUSEPORT_CPU)))
+    return UV_EINVAL;
+
+  bind_addr = addr;
+  bind_flags = (flags & UV_TCP_IPV6ONLY) | UV_TCP_REUSEPORT;
+
+  for (i = 0; i < count; i++) {
+    err = uv_tcp_init(loops[i], &handles[i]);
+    if (err)
+      goto fail;
+
+    err = uv_tcp_bind(&handles[i], bind_addr, bind_flags);
+    if (err == 0)
+      err = uv_listen((uv_stream_t*) &handles[i], backlog, cb);
+    if (err == 0 && i == 0) {
+      /* Let the others share the port when the kernel picked it. */
+      namelen = sizeof(name);
+      err = uv_tcp_getsockname(&handles[0], (struct sockaddr*) &name, &namelen);
+      bind_addr = (const struct sockaddr*) &name;
+    }
+
+    if (err) {
+      uv_close((uv_handle_t*) &handles[i], NULL);
+      goto fail;
+    }
+  }
+
+  if (flags & UV_TCP_REUSEPORT_CPU) {
+    err = uv__tcp_reuseport_cpu(handles[0].io_watcher.fd, count);
+    if (err)
+      goto fail;
+  }
+
+  return 0;
+
+fail:
+  while (i > 0)
+    uv_close((uv_handle_t*) &handles[--i], NULL);
+
+  return err;
+#else
+  (void) loops;
+  (void) handles;
+  (void) count;
+  (void) addr;
+  (void) flags;
+  (void) backlog;
+  (void) cb;
+  return UV_ENOTSUP;
+#endif
+}
+
+
 int uv__tcp_nodelay(int fd, int on) {
   if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)))
     return UV__ERR(errno);
@@ -431,6 +541,20 @@ int uv__tcp_nodelay(int fd, int on) {
 }
 
 
+int uv__tcp_zerocopy(int fd) {
+#if defined(__linux__)
+  int on;
+
+  on = 1;
+  if (setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &on, sizeof(on)))
+    return UV__ERR(errno);
+  return 0;
+#else
+  return UV_ENOSYS;
+#endif
+}
+
+
 int uv__tcp_keepalive(int fd, int on, unsigned int delay) {
   int intvl;
   int cnt;
@@ -512,6 +636,25 @@ int uv_tcp_keepalive(uv_tcp_t* handle, int on, unsigned int delay) {
 }
 
 
+int uv_tcp_zerocopy(uv_tcp_t* handle, size_t threshold) {
+#if defined(__linux__)
+  int err;
+
+  /* Switching it off again is up to libuv, the socket option can stay. */
+  if (threshold != 0 && uv__stream_fd(handle) != -1) {
+    err = uv__tcp_zerocopy(uv__stream_fd(handle));
+    if (err)
+      return err;
+  }
+
+  handle->zc_threshold = threshold;
+  return 0;
+#else
+  return UV_ENOSYS;
+#endif
+}
+
+
 int uv_tcp_simultaneous_accepts(uv_tcp_t* handle, int enable) {
   return 0;
 }
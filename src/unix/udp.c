@@ -32,6 +32,16 @@
 #endif
 #include <sys/un.h>
 
+#if defined(__linux__)
+# include <netinet/udp.h>
+# ifndef UDP_SEGMENT
+#  define UDP_SEGMENT 103
+# endif
+# ifndef UDP_GRO
+#  define UDP_GRO 104
+# endif
+#endif
+
 #if defined(IPV6_JOIN_GROUP) && !defined(IPV6_ADD_MEMBERSHIP)
 # define IPV6_ADD_MEMBERSHIP IPV6_JOIN_GROUP
 #endif
@@ -44,15 +54,347 @@ static void uv__udp_run_completed(uv_udp_t* handle);
 static void uv__udp_io(uv_loop_t* loop, uv__io_t* w, unsigned int revents);
 static void uv__udp_recvmsg(uv_udp_t* handle);
 static void uv__udp_sendmsg(uv_udp_t* handle);
+static int uv__udp_sendmsg_batch(uv_udp_t* handle);
+static void uv__udp_send_queued(uv_udp_t* handle);
 static int uv__udp_maybe_deferred_bind(uv_udp_t* handle,
                                        int domain,
                                        unsigned int flags);
 
+#if defined(__linux__)
+/* UDP_SEGMENT on send. */
+union uv__udp_cmsg {
+  struct cmsghdr hdr;
+  char buf[CMSG_SPACE(sizeof(int))];
+};
+
+/* UDP_GRO and the uv_udp_recv_meta_t ones on receive. */
+union uv__udp_recv_cmsg {
+  struct cmsghdr hdr;
+  char buf[CMSG_SPACE(sizeof(int)) +
+           CMSG_SPACE(sizeof(struct timespec)) +
+           CMSG_SPACE(sizeof(struct in6_pktinfo)) +
+           CMSG_SPACE(sizeof(int))];
+};
+
+
+/* Sends a datagram larger than the handle's segment size as segments of that
+ * size, see uv_udp_set_gso().
+ */
+static void uv__udp_gso(uv_udp_t* handle,
+                        struct msghdr* h,
+                        union uv__udp_cmsg* cmsg) {
+  uint16_t size;
+
+  if (handle->gso_size == 0)
+    return;
+
+  if (uv__count_bufs((uv_buf_t*) h->msg_iov, h->msg_iovlen) <= handle->gso_size)
+    return;
+
+  size = handle->gso_size;
+  memset(cmsg, 0, sizeof(*cmsg));
+  cmsg->hdr.cmsg_level = SOL_UDP;
+  cmsg->hdr.cmsg_type = UDP_SEGMENT;
+  cmsg->hdr.cmsg_len = CMSG_LEN(sizeof(size));
+  memcpy(CMSG_DATA(&cmsg->hdr), &size, sizeof(size));
+  h->msg_control = &cmsg->hdr;
+  h->msg_controllen = CMSG_SPACE(sizeof(size));
+}
+
+
+static void uv__udp_recv_control(uv_udp_t* handle,
+                                 struct msghdr* h,
+                                 union uv__udp_recv_cmsg* cmsg) {
+  if (handle->flags & UV_HANDLE_UDP_GRO || handle->recv_meta != 0) {
+    h->msg_control = cmsg->buf;
+    h->msg_controllen = sizeof(cmsg->buf);
+  }
+}
+
+
+static void uv__udp_recv_pktinfo(uv_udp_recv_meta_t* meta,
+                                 struct cmsghdr* cmsg) {
+  struct sockaddr_in6* addr6;
+  struct sockaddr_in* addr;
+  struct in6_pktinfo info6;
+  struct in_pktinfo info;
+
+  if (cmsg->cmsg_level == IPPROTO_IP) {
+    memcpy(&info, CMSG_DATA(cmsg), sizeof(info));
+    addr = (struct sockaddr_in*) &meta->local;
+    addr->sin_family = AF_INET;
+    addr->sin_addr = info.ipi_addr;
+    meta->ifindex = info.ipi_ifindex;
+  } else {
+    memcpy(&info6, CMSG_DATA(cmsg), sizeof(info6));
+    addr6 = (struct sockaddr_in6*) &meta->local;
+    addr6->sin6_family = AF_INET6;
+    addr6->sin6_addr = info6.ipi6_addr;
+    meta->ifindex = info6.ipi6_ifindex;
+  }
+
+  meta->flags |= UV_UDP_META_PKTINFO;
+}
+
+
+/* Returns the recv_cb flags for the control messages of a datagram. With
+ * uv_udp_set_recv_meta() on, it fills in `meta` and points `addr` at it.
+ */
+static unsigned int uv__udp_recv_cmsg(uv_udp_t* handle,
+                                      struct msghdr* h,
+                                      uv_udp_recv_meta_t* meta,
+                                      const struct sockaddr** addr) {
+  struct cmsghdr* cmsg;
+  struct timespec ts;
+  unsigned char tos;
+  unsigned int flags;
+  int val;
+
+  flags = 0;
+
+  if (handle->recv_meta != 0) {
+    memset(meta, 0, sizeof(*meta));
+    memcpy(&meta->addr, h->msg_name, h->msg_namelen);
+    meta->tos = -1;
+    *addr = (const struct sockaddr*) meta;
+    flags |= UV_UDP_RECV_META;
+  }
+
+  if (h->msg_controllen == 0)
+    return flags;
+
+  for (cmsg = CMSG_FIRSTHDR(h); cmsg != NULL; cmsg = CMSG_NXTHDR(h, cmsg)) {
+    if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+      memcpy(&val, CMSG_DATA(cmsg), sizeof(val));
+      flags |= UV_UDP_GRO | (unsigned int) val << 16;
+    }
+
+    if (!(flags & UV_UDP_RECV_META))
+      continue;
+
+    if (cmsg->cmsg_level == SOL_SOCKET &&
+        cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+      memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+      meta->timestamp.tv_sec = ts.tv_sec;
+      meta->timestamp.tv_nsec = ts.tv_nsec;
+      meta->flags |= UV_UDP_META_TIMESTAMP;
+    } else if ((cmsg->cmsg_level == IPPROTO_IP &&
+                cmsg->cmsg_type == IP_PKTINFO) ||
+               (cmsg->cmsg_level == IPPROTO_IPV6 &&
+                cmsg->cmsg_type == IPV6_PKTINFO)) {
+      uv__udp_recv_pktinfo(meta, cmsg);
+    } else if (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_TOS) {
+      memcpy(&tos, CMSG_DATA(cmsg), sizeof(tos));
+      meta->tos = tos;
+      meta->flags |= UV_UDP_META_TOS;
+    } else if (cmsg->cmsg_level == IPPROTO_IPV6 &&
+               cmsg->cmsg_type == IPV6_TCLASS) {
+      memcpy(&val, CMSG_DATA(cmsg), sizeof(val));
+      meta->tos = val;
+      meta->flags |= UV_UDP_META_TOS;
+    }
+  }
+
+  return flags;
+}
+#endif  /* defined(__linux__) */
+
+
+static size_t uv__udp_batch_size(const uv_udp_send_batch_t* req) {
+  unsigned int i;
+  size_t size;
+
+  size = 0;
+  for (i = 0; i < req->nmsgs; i++)
+    size += uv__count_bufs(req->msgs[i].bufs, req->msgs[i].nbufs);
+
+  return size;
+}
+
+
+/* Counts a datagram in the handle's uv_udp_stats_t. */
+static void uv__udp_count(uv_udp_t* handle, ssize_t status) {
+  if (status < 0) {
+    handle->stats.dropped_datagrams++;
+  } else {
+    handle->stats.sent_bytes += status;
+    handle->stats.sent_datagrams++;
+  }
+}
+
+
+/* Records the outcome of the next datagram of the batch. */
+static void uv__udp_batch_sent(uv_udp_send_batch_t* req, int status) {
+  uv__udp_count(req->handle, status);
+  req->msgs[req->nsent++].status = status;
+  if (status < 0 && req->status == 0)
+    req->status = status;
+}
+
+
+/* Returns how many requests of the write_queue were queued ahead of the first
+ * unfinished batch and may go out before it.
+ */
+static unsigned int uv__udp_writes_ahead(uv_udp_t* handle) {
+  uv_udp_send_batch_t* req;
+  struct uv__queue* q;
+
+  uv__queue_foreach(q, &handle->batch_queue) {
+    req = uv__queue_data(q, uv_udp_send_batch_t, queue);
+    if (req->nsent < req->nmsgs)
+      return req->write_seq - handle->writes_sent;
+  }
+
+  return UINT_MAX;
+}
+
+
+static void uv__udp_batch_msghdr(struct msghdr* h, const uv_udp_msg_t* m) {
+  memset(h, 0, sizeof(*h));
+  h->msg_iov = (struct iovec*) m->bufs;
+  h->msg_iovlen = m->nbufs;
+
+  if (m->addr == NULL)
+    return;
+
+  h->msg_name = (struct sockaddr*) m->addr;
+  if (m->addr->sa_family == AF_INET6)
+    h->msg_namelen = sizeof(struct sockaddr_in6);
+  else if (m->addr->sa_family == AF_INET)
+    h->msg_namelen = sizeof(struct sockaddr_in);
+  else if (m->addr->sa_family == AF_UNIX)
+    h->msg_namelen = sizeof(struct sockaddr_un);
+  else {
+    assert(0 && "unsupported address family");
+    abort();
+  }
+}
+
+
+/* A token bucket: `tokens` grows by `rate` bytes per second up to `burst`,
+ * every datagram takes its size from it. A send may overdraw it, then the
+ * queue waits for the timer until the debt is paid off.
+ */
+struct uv__udp_pacing {
+  uv_timer_t timer;
+  uv_udp_t* handle;
+  uint64_t rate;
+  int64_t burst;
+  int64_t tokens;
+  uint64_t stamp;
+};
+
+
+static void uv__udp_pacing_close_cb(uv_handle_t* handle) {
+  uv__free(container_of(handle, struct uv__udp_pacing, timer));
+}
+
+
+/* Returns how many bytes the handle may send right now. */
+static int64_t uv__udp_pacing_budget(uv_udp_t* handle) {
+  struct uv__udp_pacing* p;
+  uint64_t now;
+  uint64_t us;
+  uint64_t n;
+
+  p = handle->pacing;
+  if (p == NULL)
+    return INT64_MAX;
+
+  /* Whole microseconds only, and only once they add up to a byte, the
+   * remainder counts towards the next refill.
+   */
+  now = uv__hrtime(UV_CLOCK_PRECISE);
+  us = (now - p->stamp) / 1000;
+  if (us >= 1000000) {
+    p->tokens = p->burst;
+    p->stamp = now;
+  } else {
+    n = p->rate * us / 1000000;
+    if (n > 0) {
+      p->tokens += n;
+      if (p->tokens > p->burst)
+        p->tokens = p->burst;
+      p->stamp += us * 1000;
+    }
+  }
+
+  return p->tokens;
+}
+
+
+static void uv__udp_pacing_consume(uv_udp_t* handle, size_t size) {
+  struct uv__udp_pacing* p;
+
+  p = handle->pacing;
+  if (p != NULL)
+    p->tokens -= size;
+}
+
+
+static int uv__udp_pacing_waiting(uv_udp_t* handle) {
+  struct uv__udp_pacing* p;
+
+  p = handle->pacing;
+  return p != NULL && uv_is_active((uv_handle_t*) &p->timer);
+}
+
+
+static void uv__udp_pacing_cb(uv_timer_t* timer) {
+  struct uv__udp_pacing* p;
+  uv_udp_t* handle;
+
+  p = container_of(timer, struct uv__udp_pacing, timer);
+  handle = p->handle;
+
+  uv__udp_send_queued(handle);
+  uv__udp_run_completed(handle);
+
+  /* Tokens left but the socket is full, wait for it instead. */
+  if (!uv__udp_pacing_waiting(handle) &&
+      (!uv__queue_empty(&handle->write_queue) ||
+       !uv__queue_empty(&handle->batch_queue)))
+    uv__io_start(handle->loop, &handle->io_watcher, POLLOUT);
+}
+
+
+/* Out of tokens, park the send queue until the bucket has some again. */
+static void uv__udp_pacing_wait(uv_udp_t* handle) {
+  struct uv__udp_pacing* p;
+  uint64_t timeout;
+
+  p = handle->pacing;
+  assert(p != NULL && p->tokens <= 0);
+
+  if (uv_is_active((uv_handle_t*) &p->timer))
+    return;
+
+  timeout = (uint64_t) (1 - p->tokens) * 1000 / p->rate + 1;
+  uv__io_stop(handle->loop, &handle->io_watcher, POLLOUT);
+  uv_timer_start(&p->timer, uv__udp_pacing_cb, timeout, 0);
+  handle->stats.paced++;
+}
+
+
+/* Watches for POLLOUT, unless pacing holds the queue back anyway. */
+static void uv__udp_want_write(uv_udp_t* handle) {
+  if (!uv__udp_pacing_waiting(handle))
+    uv__io_start(handle->loop, &handle->io_watcher, POLLOUT);
+}
+
 
 void uv__udp_close(uv_udp_t* handle) {
+  struct uv__udp_pacing* p;
+
   uv__io_close(handle->loop, &handle->io_watcher);
   uv__handle_stop(handle);
 
+  p = handle->pacing;
+  if (p != NULL) {
+    uv_close((uv_handle_t*) &p->timer, uv__udp_pacing_close_cb);
+    handle->pacing = NULL;
+  }
+
   if (handle->io_watcher.fd != -1) {
     uv__close(handle->io_watcher.fd);
     handle->io_watcher.fd = -1;
@@ -61,6 +403,7 @@ void uv__udp_close(uv_udp_t* handle) {
 
 
 void uv__udp_finish_close(uv_udp_t* handle) {
+  uv_udp_send_batch_t* batch;
   uv_udp_send_t* req;
   struct uv__queue* q;
 
@@ -73,7 +416,15 @@ void uv__udp_finish_close(uv_udp_t* handle) {
 
     req = uv__queue_data(q, uv_udp_send_t, queue);
     req->status = UV_ECANCELED;
+    uv__udp_count(handle, req->status);
     uv__queue_insert_tail(&handle->write_completed_queue, &req->queue);
+    handle->writes_sent++;
+  }
+
+  uv__queue_foreach(q, &handle->batch_queue) {
+    batch = uv__queue_data(q, uv_udp_send_batch_t, queue);
+    while (batch->nsent < batch->nmsgs)
+      uv__udp_batch_sent(batch, UV_ECANCELED);
   }
 
   uv__udp_run_completed(handle);
@@ -89,15 +440,41 @@ void uv__udp_finish_close(uv_udp_t* handle) {
 
 
 static void uv__udp_run_completed(uv_udp_t* handle) {
+  uv_udp_send_batch_t* batch;
   uv_udp_send_t* req;
   struct uv__queue* q;
 
   assert(!(handle->flags & UV_HANDLE_UDP_PROCESSING));
   handle->flags |= UV_HANDLE_UDP_PROCESSING;
 
-  while (!uv__queue_empty(&handle->write_completed_queue)) {
+  /* Callbacks run in the order in which the requests were queued. Batches
+   * complete in order, the finished ones are at the head, and a finished
+   * batch only waits for the requests of the write_queue queued ahead of it.
+   */
+  for (;;) {
+    if (!uv__queue_empty(&handle->batch_queue)) {
+      q = uv__queue_head(&handle->batch_queue);
+      batch = uv__queue_data(q, uv_udp_send_batch_t, queue);
+      if (batch->nsent == batch->nmsgs &&
+          batch->write_seq == handle->writes_reported) {
+        uv__queue_remove(q);
+        uv__req_unregister(handle->loop, batch);
+
+        handle->send_queue_size -= uv__udp_batch_size(batch);
+        handle->send_queue_count--;
+
+        if (batch->cb != NULL)
+          batch->cb(batch, batch->status);
+        continue;
+      }
+    }
+
+    if (uv__queue_empty(&handle->write_completed_queue))
+      break;
+
     q = uv__queue_head(&handle->write_completed_queue);
     uv__queue_remove(q);
+    handle->writes_reported++;
 
     req = uv__queue_data(q, uv_udp_send_t, queue);
     uv__req_unregister(handle->loop, req);
@@ -121,7 +498,8 @@ static void uv__udp_run_completed(uv_udp_t* handle) {
       req->send_cb(req, req->status);
   }
 
-  if (uv__queue_empty(&handle->write_queue)) {
+  if (uv__queue_empty(&handle->write_queue) &&
+      uv__queue_empty(&handle->batch_queue)) {
     /* Pending queue and completion queue empty, stop watcher. */
     uv__io_stop(handle->loop, &handle->io_watcher, POLLOUT);
     if (!uv__io_active(&handle->io_watcher, POLLIN))
@@ -142,29 +520,54 @@ static void uv__udp_io(uv_loop_t* loop, uv__io_t* w, unsigned int revents) {
     uv__udp_recvmsg(handle);
 
   if (revents & POLLOUT) {
-    uv__udp_sendmsg(handle);
+    uv__udp_send_queued(handle);
     uv__udp_run_completed(handle);
   }
 }
 
 static int uv__udp_recvmmsg(uv_udp_t* handle, uv_buf_t* buf) {
 #if defined(__linux__) || defined(__FreeBSD__)
-  struct sockaddr_in6 peers[20];
+  struct sockaddr_in6 peers[UV_UDP_RECVMMSG_MAX];
   struct iovec iov[ARRAY_SIZE(peers)];
   struct mmsghdr msgs[ARRAY_SIZE(peers)];
+#if defined(__linux__)
+  union uv__udp_recv_cmsg cmsgs[ARRAY_SIZE(peers)];
+  uv_udp_recv_meta_t meta;
+#endif
+  const struct sockaddr* addr;
   ssize_t nread;
   uv_buf_t chunk_buf;
   size_t chunks;
+  int pooled;
   int flags;
+  int err;
   size_t k;
 
   /* prepare structures for recvmmsg */
-  chunks = buf->len / UV__UDP_DGRAM_MAXSIZE;
-  if (chunks > ARRAY_SIZE(iov))
-    chunks = ARRAY_SIZE(iov);
+  pooled = handle->flags & UV_HANDLE_READ_POOLED;
+  if (pooled) {
+    /* A buffer from the pool for each datagram, lent to recv_cb on its own.
+     * Receive fewer datagrams rather than going to the heap for them.
+     */
+    iov[0].iov_base = buf->base;
+    iov[0].iov_len = buf->len;
+    for (chunks = 1; chunks < handle->recvmmsg_nmsgs; chunks++) {
+      iov[chunks].iov_base = uv__buf_pool_take(handle->loop);
+      iov[chunks].iov_len = buf->len;
+      if (iov[chunks].iov_base == NULL)
+        break;
+    }
+  } else {
+    chunks = buf->len / UV__UDP_DGRAM_MAXSIZE;
+    if (chunks > handle->recvmmsg_nmsgs)
+      chunks = handle->recvmmsg_nmsgs;
+    for (k = 0; k < chunks; ++k) {
+      iov[k].iov_base = buf->base + k * UV__UDP_DGRAM_MAXSIZE;
+      iov[k].iov_len = UV__UDP_DGRAM_MAXSIZE;
+    }
+  }
+
   for (k = 0; k < chunks; ++k) {
-    iov[k].iov_base = buf->base + k * UV__UDP_DGRAM_MAXSIZE;
-    iov[k].iov_len = UV__UDP_DGRAM_MAXSIZE;
     memset(&msgs[k].msg_hdr, 0, sizeof(msgs[k].msg_hdr));
     msgs[k].msg_hdr.msg_iov = iov + k;
     msgs[k].msg_hdr.msg_iovlen = 1;
@@ -173,30 +576,74 @@ static int uv__udp_recvmmsg(uv_udp_t* handle, uv_buf_t* buf) {
     msgs[k].msg_hdr.msg_control = NULL;
     msgs[k].msg_hdr.msg_controllen = 0;
     msgs[k].msg_hdr.msg_flags = 0;
+#if defined(__linux__)
+    uv__udp_recv_control(handle, &msgs[k].msg_hdr, &cmsgs[k]);
+#endif
   }
 
   do
     nread = recvmmsg(handle->io_watcher.fd, msgs, chunks, 0, NULL);
   while (nread == -1 && errno == EINTR);
 
+  if (pooled) {
+    err = errno;
+    k = nread > 0 ? nread : 0;
+    if (k > 1)
+      uv__metrics_inc_buf_pool_hits(handle->loop, k - 1);
+
+    /* Back to the pool with the buffers that stayed empty. */
+    for (; k < chunks; k++) {
+      chunk_buf = uv_buf_init(iov[k].iov_base, iov[k].iov_len);
+      uv_buf_release(handle->loop, &chunk_buf);
+    }
+
+    *buf = uv_buf_init(NULL, 0);
+    errno = err;
+  }
+
   if (nread < 1) {
     if (nread == 0 || errno == EAGAIN || errno == EWOULDBLOCK)
       handle->recv_cb(handle, 0, buf, NULL, 0);
     else
       handle->recv_cb(handle, UV__ERR(errno), buf, NULL, 0);
+  } else if (pooled) {
+    for (k = 0; k < (size_t) nread; k++) {
+      chunk_buf = uv_buf_init(iov[k].iov_base, iov[k].iov_len);
+
+      /* recv_cb stopped receiving, the rest of the datagrams is dropped. */
+      if (handle->recv_cb == NULL) {
+        uv_buf_release(handle->loop, &chunk_buf);
+        continue;
+      }
+
+      flags = 0;
+      if (msgs[k].msg_hdr.msg_flags & MSG_TRUNC)
+        flags |= UV_UDP_PARTIAL;
+      addr = msgs[k].msg_hdr.msg_name;
+#if defined(__linux__)
+      flags |= uv__udp_recv_cmsg(handle, &msgs[k].msg_hdr, &meta, &addr);
+#endif
+
+      if (msgs[k].msg_len == 0) {
+        uv_buf_release(handle->loop, &chunk_buf);
+        chunk_buf = uv_buf_init(NULL, 0);
+      }
+
+      handle->recv_cb(handle, msgs[k].msg_len, &chunk_buf, addr, flags);
+    }
   } else {
     /* pass each chunk to the application */
     for (k = 0; k < (size_t) nread && handle->recv_cb != NULL; k++) {
       flags = UV_UDP_MMSG_CHUNK;
       if (msgs[k].msg_hdr.msg_flags & MSG_TRUNC)
         flags |= UV_UDP_PARTIAL;
+      addr = msgs[k].msg_hdr.msg_name;
+#if defined(__linux__)
+      flags |= uv__udp_recv_cmsg(handle, &msgs[k].msg_hdr, &meta, &addr);
+#endif
 
       chunk_buf = uv_buf_init(iov[k].iov_base, iov[k].iov_len);
-      handle->recv_cb(handle,
-                      msgs[k].msg_len,
-                      &chunk_buf,
-                      msgs[k].msg_hdr.msg_name,
-                      flags);
+      handle->recv_cb(handle, msgs[k].msg_len, &chunk_buf, addr, flags);
     }
 
     /* one last callback so the original buffer is freed */
@@ -212,13 +659,20 @@ static int uv__udp_recvmmsg(uv_udp_t* handle, uv_buf_t* buf) {
 static void uv__udp_recvmsg(uv_udp_t* handle) {
   struct sockaddr_storage peer;
   struct msghdr h;
+#if defined(__linux__)
+  union uv__udp_recv_cmsg cmsg;
+  uv_udp_recv_meta_t meta;
+#endif
+  const struct sockaddr* addr;
   ssize_t nread;
   uv_buf_t buf;
   int flags;
   int count;
+  int err;
 
   assert(handle->recv_cb != NULL);
-  assert(handle->alloc_cb != NULL);
+  assert(handle->alloc_cb != NULL ||
+         handle->flags & UV_HANDLE_READ_POOLED);
 
   /* Prevent loop starvation when the data comes in as fast as (or faster than)
    * we can read it. XXX Need to rearm fd if we switch to edge-triggered I/O.
@@ -227,7 +681,11 @@ static void uv__udp_recvmsg(uv_udp_t* handle) {
 
   do {
     buf = uv_buf_init(NULL, 0);
-    handle->alloc_cb((uv_handle_t*) handle, UV__UDP_DGRAM_MAXSIZE, &buf);
+    if (handle->flags & UV_HANDLE_READ_POOLED)
+      uv__buf_pool_get(handle->loop, &buf);
+    else
+      handle->alloc_cb((uv_handle_t*) handle, UV__UDP_DGRAM_MAXSIZE, &buf);
+
     if (buf.base == NULL || buf.len == 0) {
       handle->recv_cb(handle, UV_ENOBUFS, &buf, NULL, 0);
       return;
@@ -247,6 +705,9 @@ static void uv__udp_recvmsg(uv_udp_t* handle) {
     h.msg_namelen = sizeof(peer);
     h.msg_iov = (struct iovec*) &buf;
     h.msg_iovlen = 1;
+#if defined(__linux__)
+    uv__udp_recv_control(handle, &h, &cmsg);
+#endif
 
     do {
 #if defined(__VMS) && ((defined(__clang__) && (__INITIAL_POINTER_SIZE != 32)) || (__INITIAL_POINTER_SIZE == 64))
@@ -257,6 +718,14 @@ static void uv__udp_recvmsg(uv_udp_t* handle) {
     }
     while (nread == -1 && errno == EINTR);
 
+    /* Pooled receives lend the buffer only when it holds data. */
+    if (nread <= 0 && handle->flags & UV_HANDLE_READ_POOLED) {
+      err = errno;
+      uv_buf_release(handle->loop, &buf);
+      buf = uv_buf_init(NULL, 0);
+      errno = err;
+    }
+
     if (nread == -1) {
       if (errno == EAGAIN || errno == EWOULDBLOCK)
         handle->recv_cb(handle, 0, &buf, NULL, 0);
@@ -267,8 +736,12 @@ static void uv__udp_recvmsg(uv_udp_t* handle) {
       flags = 0;
       if (h.msg_flags & MSG_TRUNC)
         flags |= UV_UDP_PARTIAL;
+      addr = (const struct sockaddr*) &peer;
+#if defined(__linux__)
+      flags |= uv__udp_recv_cmsg(handle, &h, &meta, &addr);
+#endif
 
-      handle->recv_cb(handle, nread, &buf, (const struct sockaddr*) &peer, flags);
+      handle->recv_cb(handle, nread, &buf, addr, flags);
     }
     count--;
   }
@@ -283,8 +756,13 @@ static void uv__udp_sendmsg(uv_udp_t* handle) {
 #if defined(__linux__) || defined(__FreeBSD__)
   uv_udp_send_t* req;
   struct mmsghdr h[20];
+#if defined(__linux__)
+  union uv__udp_cmsg cmsgs[ARRAY_SIZE(h)];
+#endif
   struct mmsghdr* p;
   struct uv__queue* q;
+  unsigned int ahead;
+  int64_t budget;
   ssize_t npkts;
   size_t pkts;
   size_t i;
@@ -292,9 +770,20 @@ static void uv__udp_sendmsg(uv_udp_t* handle) {
   if (uv__queue_empty(&handle->write_queue))
     return;
 
+  ahead = uv__udp_writes_ahead(handle);
+  if (ahead == 0)
+    return;
+
 write_queue_drain:
+  budget = uv__udp_pacing_budget(handle);
+  if (budget <= 0) {
+    uv__udp_pacing_wait(handle);
+    return;
+  }
+
   for (pkts = 0, q = uv__queue_head(&handle->write_queue);
-       pkts < ARRAY_SIZE(h) && q != &handle->write_queue;
+       pkts < ARRAY_SIZE(h) && pkts < ahead &&
+       q != &handle->write_queue && budget > 0;
        ++pkts, q = uv__queue_head(q)) {
     assert(q != NULL);
     req = uv__queue_data(q, uv_udp_send_t, queue);
@@ -320,6 +809,10 @@ write_queue_drain:
     }
     h[pkts].msg_hdr.msg_iov = (struct iovec*) req->bufs;
     h[pkts].msg_hdr.msg_iovlen = req->nbufs;
+#if defined(__linux__)
+    uv__udp_gso(handle, &h[pkts].msg_hdr, &cmsgs[pkts]);
+#endif
+    budget -= uv__count_bufs(req->bufs, req->nbufs);
   }
 
   do
@@ -337,8 +830,10 @@ write_queue_drain:
       assert(req != NULL);
 
       req->status = UV__ERR(errno);
+      uv__udp_count(handle, req->status);
       uv__queue_remove(&req->queue);
       uv__queue_insert_tail(&handle->write_completed_queue, &req->queue);
+      handle->writes_sent++;
     }
     uv__io_feed(handle->loop, &handle->io_watcher);
     return;
@@ -355,6 +850,8 @@ write_queue_drain:
     assert(req != NULL);
 
     req->status = req->bufs[0].len;
+    uv__udp_count(handle, h[i].msg_len);
+    uv__udp_pacing_consume(handle, h[i].msg_len);
 
     /* Sending a datagram is an atomic operation: either all data
      * is written or nothing is (and EMSGSIZE is raised). That is
@@ -363,19 +860,29 @@ write_queue_drain:
      */
     uv__queue_remove(&req->queue);
     uv__queue_insert_tail(&handle->write_completed_queue, &req->queue);
+    handle->writes_sent++;
   }
 
   /* couldn't batch everything, continue sending (jump to avoid stack growth) */
-  if (!uv__queue_empty(&handle->write_queue))
+  ahead -= npkts;
+  if (!uv__queue_empty(&handle->write_queue) && ahead > 0)
     goto write_queue_drain;
   uv__io_feed(handle->loop, &handle->io_watcher);
 #else  /* __linux__ || ____FreeBSD__ */
   uv_udp_send_t* req;
   struct msghdr h;
   struct uv__queue* q;
+  unsigned int ahead;
   ssize_t size;
 
-  while (!uv__queue_empty(&handle->write_queue)) {
+  for (ahead = uv__udp_writes_ahead(handle);
+       ahead > 0 && !uv__queue_empty(&handle->write_queue);
+       ahead--) {
+    if (uv__udp_pacing_budget(handle) <= 0) {
+      uv__udp_pacing_wait(handle);
+      break;
+    }
+
     q = uv__queue_head(&handle->write_queue);
     assert(q != NULL);
 
@@ -416,6 +923,9 @@ write_queue_drain:
     }
 
     req->status = (size == -1 ? UV__ERR(errno) : size);
+    uv__udp_count(handle, req->status);
+    if (size > 0)
+      uv__udp_pacing_consume(handle, size);
 
     /* Sending a datagram is an atomic operation: either all data
      * is written or nothing is (and EMSGSIZE is raised). That is
@@ -424,11 +934,122 @@ write_queue_drain:
      */
     uv__queue_remove(&req->queue);
     uv__queue_insert_tail(&handle->write_completed_queue, &req->queue);
+    handle->writes_sent++;
     uv__io_feed(handle->loop, &handle->io_watcher);
   }
 #endif  /* __linux__ || ____FreeBSD__ */
 }
 
+
+/* Sends the datagrams of the queued batches straight from the caller's
+ * messages. Unlike with the write_queue, a datagram that fails doesn't fail
+ * the ones after it, sendmmsg() stops at it and the next call carries on.
+ *
+ * Stops at a batch with requests of the write_queue ahead of it. Returns
+ * non-zero if it finished a batch and the write_queue is next in line.
+ */
+static int uv__udp_sendmsg_batch(uv_udp_t* handle) {
+  uv_udp_send_batch_t* req;
+  struct uv__queue* q;
+  int finished;
+#if defined(__linux__) || defined(__FreeBSD__)
+  struct mmsghdr h[64];
+#if defined(__linux__)
+  union uv__udp_cmsg cmsgs[ARRAY_SIZE(h)];
+#endif
+  uv_udp_msg_t* m;
+  ssize_t npkts;
+  size_t pkts;
+  size_t i;
+#else
+  struct msghdr h;
+  ssize_t size;
+#endif
+  int64_t budget;
+
+  finished = 0;
+  uv__queue_foreach(q, &handle->batch_queue) {
+    req = uv__queue_data(q, uv_udp_send_batch_t, queue);
+    if (req->nsent == req->nmsgs)
+      continue;
+
+    if (req->write_seq != handle->writes_sent)
+      return finished;
+
+    while (req->nsent < req->nmsgs) {
+      budget = uv__udp_pacing_budget(handle);
+      if (budget <= 0) {
+        uv__udp_pacing_wait(handle);
+        return 0;
+      }
+
+#if defined(__linux__) || defined(__FreeBSD__)
+      for (pkts = 0;
+           pkts < ARRAY_SIZE(h) && req->nsent + pkts < req->nmsgs && budget > 0;
+           pkts++) {
+        m = &req->msgs[req->nsent + pkts];
+        uv__udp_batch_msghdr(&h[pkts].msg_hdr, m);
+        h[pkts].msg_len = 0;
+#if defined(__linux__)
+        uv__udp_gso(handle, &h[pkts].msg_hdr, &cmsgs[pkts]);
+#endif
+        budget -= uv__count_bufs(m->bufs, m->nbufs);
+      }
+
+      do
+        npkts = sendmmsg(handle->io_watcher.fd, h, pkts, 0);
+      while (npkts == -1 && errno == EINTR);
+
+      if (npkts == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)
+          return 0;
+        uv__udp_batch_sent(req, UV__ERR(errno));
+        continue;
+      }
+
+      for (i = 0; i < (size_t) npkts; i++) {
+        uv__udp_pacing_consume(handle, h[i].msg_len);
+        uv__udp_batch_sent(req, h[i].msg_len);
+      }
+#else
+      uv__udp_batch_msghdr(&h, &req->msgs[req->nsent]);
+
+      do {
+#if defined(__VMS) && ((defined(__clang__) && (__INITIAL_POINTER_SIZE != 32)) || (__INITIAL_POINTER_SIZE == 64))
+        size = sendmsg(handle->io_watcher.fd, (__msghdr64*) &h, 0);
+#else
+        size = sendmsg(handle->io_watcher.fd, &h, 0);
+#endif
+      } while (size == -1 && errno == EINTR);
+
+      if (size == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)
+          return 0;
+        uv__udp_batch_sent(req, UV__ERR(errno));
+        continue;
+      }
+
+      uv__udp_pacing_consume(handle, size);
+      uv__udp_batch_sent(req, size);
+#endif
+    }
+
+    finished = 1;
+  }
+
+  return finished && !uv__queue_empty(&handle->write_queue);
+}
+
+
+/* Sends what the write_queue and the batches hold, in the order in which it
+ * was queued, until the socket is full or pacing holds the rest back.
+ */
+static void uv__udp_send_queued(uv_udp_t* handle) {
+  do
+    uv__udp_sendmsg(handle);
+  while (uv__udp_sendmsg_batch(handle));
+}
+
 /* On the BSDs, SO_REUSEPORT implies SO_REUSEADDR but with some additional
  * refinements for programs that use multicast.
  *
@@ -500,7 +1121,8 @@ int uv__udp_bind(uv_udp_t* handle,
   int fd;
 
   /* Check for bad flags. */
-  if (flags & ~(UV_UDP_IPV6ONLY | UV_UDP_REUSEADDR | UV_UDP_LINUX_RECVERR))
+  if (flags & ~(UV_UDP_IPV6ONLY | UV_UDP_REUSEADDR | UV_UDP_LINUX_RECVERR |
+                UV_UDP_REUSEPORT))
     return UV_EINVAL;
 
   /* Cannot set IPv6-only mode on non-IPv6 socket. */
@@ -528,6 +1150,12 @@ int uv__udp_bind(uv_udp_t* handle,
       return err;
   }
 
+  if (flags & UV_UDP_REUSEPORT) {
+    err = uv__sock_reuseport(fd);
+    if (err)
+      return err;
+  }
+
   if (flags & UV_UDP_IPV6ONLY) {
 #ifdef IPV6_V6ONLY
     yes = 1;
@@ -742,6 +1370,7 @@ int uv__udp_send(uv_udp_send_t* req,
   memcpy(req->bufs, bufs, nbufs * sizeof(bufs[0]));
   handle->send_queue_size += uv__count_bufs(req->bufs, req->nbufs);
   handle->send_queue_count++;
+  handle->writes_queued++;
   uv__queue_insert_tail(&handle->write_queue, &req->queue);
   uv__handle_start(handle);
 
@@ -753,15 +1382,65 @@ int uv__udp_send(uv_udp_send_t* req,
      * write.
      */
     if (!uv__queue_empty(&handle->write_queue))
-      uv__io_start(handle->loop, &handle->io_watcher, POLLOUT);
+      uv__udp_want_write(handle);
   } else {
-    uv__io_start(handle->loop, &handle->io_watcher, POLLOUT);
+    uv__udp_want_write(handle);
   }
 
   return 0;
 }
 
 
+int uv__udp_send_batch(uv_udp_send_batch_t* req,
+                       uv_udp_t* handle,
+                       uv_udp_msg_t msgs[],
+                       unsigned int nmsgs,
+                       uv_udp_send_batch_cb cb) {
+  unsigned int i;
+  int empty_queue;
+  int err;
+
+  assert(nmsgs > 0);
+
+  for (i = 0; i < nmsgs; i++) {
+    if (msgs[i].addr != NULL) {
+      err = uv__udp_maybe_deferred_bind(handle, msgs[i].addr->sa_family, 0);
+      if (err)
+        return err;
+    }
+  }
+
+  empty_queue = (handle->send_queue_count == 0);
+
+  uv__req_init(handle->loop, req, UV_UDP_SEND_BATCH);
+  req->handle = handle;
+  req->msgs = msgs;
+  req->nmsgs = nmsgs;
+  req->cb = cb;
+  req->nsent = 0;
+  req->status = 0;
+  req->write_seq = handle->writes_queued;
+
+  handle->send_queue_size += uv__udp_batch_size(req);
+  handle->send_queue_count++;
+  uv__queue_insert_tail(&handle->batch_queue, &req->queue);
+  uv__handle_start(handle);
+
+  /* Nothing ahead of it, send what the socket takes right away. */
+  if (empty_queue && !(handle->flags & UV_HANDLE_UDP_PROCESSING)) {
+    uv__udp_sendmsg_batch(handle);
+
+    if (req->nsent == req->nmsgs) {
+      uv__io_feed(handle->loop, &handle->io_watcher);
+      return 0;
+    }
+  }
+
+  uv__udp_want_write(handle);
+  return 0;
+}
+
+
 int uv__udp_try_send(uv_udp_t* handle,
                      const uv_buf_t bufs[],
                      unsigned int nbufs,
@@ -769,6 +1448,9 @@ int uv__udp_try_send(uv_udp_t* handle,
                      unsigned int addrlen) {
   int err;
   struct msghdr h;
+#if defined(__linux__)
+  union uv__udp_cmsg cmsg;
+#endif
   ssize_t size;
 
   assert(nbufs > 0);
@@ -777,6 +1459,10 @@ int uv__udp_try_send(uv_udp_t* handle,
   if (handle->send_queue_count != 0)
     return UV_EAGAIN;
 
+  /* pacing holds sends back for now */
+  if (uv__udp_pacing_budget(handle) <= 0)
+    return UV_EAGAIN;
+
   if (addr) {
     err = uv__udp_maybe_deferred_bind(handle, addr->sa_family, 0);
     if (err)
@@ -790,6 +1476,9 @@ int uv__udp_try_send(uv_udp_t* handle,
   h.msg_namelen = addrlen;
   h.msg_iov = (struct iovec*) bufs;
   h.msg_iovlen = nbufs;
+#if defined(__linux__)
+  uv__udp_gso(handle, &h, &cmsg);
+#endif
 
   do {
 #if defined(__VMS) && ((defined(__clang__) && (__INITIAL_POINTER_SIZE != 32)) || (__INITIAL_POINTER_SIZE == 64))
@@ -802,10 +1491,12 @@ int uv__udp_try_send(uv_udp_t* handle,
   if (size == -1) {
     if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)
       return UV_EAGAIN;
-    else
-      return UV__ERR(errno);
+    uv__udp_count(handle, UV__ERR(errno));
+    return UV__ERR(errno);
   }
 
+  uv__udp_count(handle, size);
+  uv__udp_pacing_consume(handle, size);
   return size;
 }
 
@@ -1024,9 +1715,18 @@ int uv__udp_init_ex(uv_loop_t* loop,
   handle->recv_cb = NULL;
   handle->send_queue_size = 0;
   handle->send_queue_count = 0;
+  handle->gso_size = 0;
+  handle->recvmmsg_nmsgs = 20;
+  handle->recv_meta = 0;
+  handle->pacing = NULL;
+  memset(&handle->stats, 0, sizeof(handle->stats));
   uv__io_init(&handle->io_watcher, uv__udp_io, fd);
   uv__queue_init(&handle->write_queue);
   uv__queue_init(&handle->write_completed_queue);
+  uv__queue_init(&handle->batch_queue);
+  handle->writes_queued = 0;
+  handle->writes_sent = 0;
+  handle->writes_reported = 0;
 
   return 0;
 }
@@ -1193,6 +1893,184 @@ int uv_udp_set_broadcast(uv_udp_t* handle, int on) {
 }
 
 
+int uv_udp_set_gso(uv_udp_t* handle, unsigned int segment_size) {
+#if defined(__linux__)
+  int size;
+  socklen_t len;
+
+  if (segment_size > UINT16_MAX)
+    return UV_EINVAL;
+
+  /* Kernels without UDP_SEGMENT don't know the option. */
+  len = sizeof(size);
+  if (handle->io_watcher.fd != -1)
+    if (getsockopt(handle->io_watcher.fd, SOL_UDP, UDP_SEGMENT, &size, &len))
+      return UV__ERR(errno);
+
+  handle->gso_size = segment_size;
+  return 0;
+#else
+  return UV_ENOSYS;
+#endif
+}
+
+
+int uv_udp_set_gro(uv_udp_t* handle, int on) {
+#if defined(__linux__)
+  on = !!on;
+  if (setsockopt(handle->io_watcher.fd, SOL_UDP, UDP_GRO, &on, sizeof(on)))
+    return UV__ERR(errno);
+
+  if (on)
+    handle->flags |= UV_HANDLE_UDP_GRO;
+  else
+    handle->flags &= ~UV_HANDLE_UDP_GRO;
+
+  return 0;
+#else
+  return UV_ENOSYS;
+#endif
+}
+
+
+int uv_udp_set_recvmmsg(uv_udp_t* handle, unsigned int nmsgs) {
+#if defined(__linux__) || defined(__FreeBSD__)
+  if (nmsgs == 0 || nmsgs > UV_UDP_RECVMMSG_MAX)
+    return UV_EINVAL;
+
+  handle->recvmmsg_nmsgs = nmsgs;
+  return 0;
+#else
+  return UV_ENOSYS;
+#endif
+}
+
+
+int uv_udp_set_recv_meta(uv_udp_t* handle, unsigned int flags) {
+#if defined(__linux__)
+  struct sockaddr_storage addr;
+  socklen_t len;
+  int level;
+  int tos;
+  int pktinfo;
+  int on;
+
+  if (flags & ~(UV_UDP_META_TIMESTAMP | UV_UDP_META_PKTINFO | UV_UDP_META_TOS))
+    return UV_EINVAL;
+
+  len = sizeof(addr);
+  if (getsockname(handle->io_watcher.fd, (struct sockaddr*) &addr, &len))
+    return UV__ERR(errno);
+
+  if (addr.ss_family == AF_INET6) {
+    level = IPPROTO_IPV6;
+    pktinfo = IPV6_RECVPKTINFO;
+    tos = IPV6_RECVTCLASS;
+  } else if (addr.ss_family == AF_INET) {
+    level = IPPROTO_IP;
+    pktinfo = IP_PKTINFO;
+    tos = IP_RECVTOS;
+  } else {
+    return UV_EINVAL;
+  }
+
+  on = !!(flags & UV_UDP_META_TIMESTAMP);
+  if (setsockopt(handle->io_watcher.fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)))
+    return UV__ERR(errno);
+
+  on = !!(flags & UV_UDP_META_PKTINFO);
+  if (setsockopt(handle->io_watcher.fd, level, pktinfo, &on, sizeof(on)))
+    return UV__ERR(errno);
+
+  on = !!(flags & UV_UDP_META_TOS);
+  if (setsockopt(handle->io_watcher.fd, level, tos, &on, sizeof(on)))
+    return UV__ERR(errno);
+
+  handle->recv_meta = flags;
+  return 0;
+#else
+  return UV_ENOSYS;
+#endif
+}
+
+
+int uv_udp_set_pacing(uv_udp_t* handle, uint64_t rate, size_t burst) {
+  struct uv__udp_pacing* p;
+  int err;
+
+  if (rate != 0 && burst == 0)
+    return UV_EINVAL;
+
+  /* Keeps the refill from overflowing. */
+  if (rate > UINT64_MAX / 1000000)
+    return UV_EINVAL;
+
+  if (uv__is_closing(handle))
+    return UV_EINVAL;
+
+#if defined(SO_MAX_PACING_RATE)
+  /* A hint, the kernel only enforces it with the fq qdisc. */
+  if (handle->io_watcher.fd != -1) {
+    uint64_t max;
+    max = rate != 0 ? rate : ~(uint64_t) 0;
+    setsockopt(handle->io_watcher.fd,
+               SOL_SOCKET,
+               SO_MAX_PACING_RATE,
+               &max,
+               sizeof(max));
+  }
+#endif
+
+  p = handle->pacing;
+
+  if (rate == 0) {
+    if (p == NULL)
+      return 0;
+
+    uv_close((uv_handle_t*) &p->timer, uv__udp_pacing_close_cb);
+    handle->pacing = NULL;
+
+    if (!uv__queue_empty(&handle->write_queue) ||
+        !uv__queue_empty(&handle->batch_queue))
+      uv__io_start(handle->loop, &handle->io_watcher, POLLOUT);
+
+    return 0;
+  }
+
+  if (p == NULL) {
+    p = uv__malloc(sizeof(*p));
+    if (p == NULL)
+      return UV_ENOMEM;
+
+    err = uv_timer_init(handle->loop, &p->timer);
+    if (err < 0) {
+      uv__free(p);
+      return err;
+    }
+
+    p->timer.flags |= UV_HANDLE_INTERNAL;
+    uv__handle_unref(&p->timer);
+    p->handle = handle;
+    p->tokens = burst;
+    p->stamp = uv__hrtime(UV_CLOCK_PRECISE);
+    handle->pacing = p;
+  }
+
+  p->rate = rate;
+  p->burst = burst;
+  if (p->tokens > p->burst)
+    p->tokens = p->burst;
+
+  return 0;
+}
+
+
+int uv_udp_get_stats(const uv_udp_t* handle, uv_udp_stats_t* stats) {
+  *stats = handle->stats;
+  return 0;
+}
+
+
 int uv_udp_set_ttl(uv_udp_t* handle, int ttl) {
   if (ttl < 1 || ttl > 255)
     return UV_EINVAL;
@@ -1364,6 +2242,7 @@ int uv__udp_recv_start(uv_udp_t* handle,
   if (err)
     return err;
 
+  handle->flags &= ~UV_HANDLE_READ_POOLED;
   handle->alloc_cb = alloc_cb;
   handle->recv_cb = recv_cb;
 
@@ -1374,12 +2253,37 @@ int uv__udp_recv_start(uv_udp_t* handle,
 }
 
 
+int uv__udp_recv_start_pooled(uv_udp_t* handle, uv_udp_recv_cb recv_cb) {
+  int err;
+
+  if (uv__get_internal_fields(handle->loop)->buf_pool.count == 0)
+    return UV_EINVAL;  /* No UV_LOOP_BUFFER_POOL. */
+
+  if (uv__io_active(&handle->io_watcher, POLLIN))
+    return UV_EALREADY;
+
+  err = uv__udp_maybe_deferred_bind(handle, AF_INET, 0);
+  if (err)
+    return err;
+
+  handle->flags |= UV_HANDLE_READ_POOLED;
+  handle->alloc_cb = NULL;
+  handle->recv_cb = recv_cb;
+
+  uv__io_start(handle->loop, &handle->io_watcher, POLLIN);
+  uv__handle_start(handle);
+
+  return 0;
+}
+
+
 int uv__udp_recv_stop(uv_udp_t* handle) {
   uv__io_stop(handle->loop, &handle->io_watcher, POLLIN);
 
   if (!uv__io_active(&handle->io_watcher, POLLOUT))
     uv__handle_stop(handle);
 
+  handle->flags &= ~UV_HANDLE_READ_POOLED;
   handle->alloc_cb = NULL;
   handle->recv_cb = NULL;
 
@@ -514,6 +514,31 @@ int uv_udp_try_send(uv_udp_t* handle,
 }
 
 
+int uv_udp_send_batch(uv_udp_send_batch_t* req,
+                      uv_udp_t* handle,
+                      uv_udp_msg_t msgs[],
+                      unsigned int nmsgs,
+                      uv_udp_send_batch_cb cb) {
+  unsigned int i;
+  int addrlen;
+
+  if (nmsgs == 0)
+    return UV_EINVAL;
+
+  /* All or nothing, a bad address fails the batch before anything is sent. */
+  for (i = 0; i < nmsgs; i++) {
+    if (msgs[i].nbufs == 0)
+      return UV_EINVAL;
+
+    addrlen = uv__udp_check_before_send(handle, msgs[i].addr);
+    if (addrlen < 0)
+      return addrlen;
+  }
+
+  return uv__udp_send_batch(req, handle, msgs, nmsgs, cb);
+}
+
+
 int uv_udp_recv_start(uv_udp_t* handle,
                       uv_alloc_cb alloc_cb,
                       uv_udp_recv_cb recv_cb) {
@@ -524,6 +549,14 @@ int uv_udp_recv_start(uv_udp_t* handle,
 }
 
 
+int uv_udp_recv_start_pooled(uv_udp_t* handle, uv_udp_recv_cb recv_cb) {
+  if (handle->type != UV_UDP || recv_cb == NULL)
+    return UV_EINVAL;
+  else
+    return uv__udp_recv_start_pooled(handle, recv_cb);
+}
+
+
 int uv_udp_recv_stop(uv_udp_t* handle) {
   if (handle->type != UV_UDP)
     return UV_EINVAL;
@@ -809,7 +842,14 @@ int uv_loop_configure(uv_loop_t* loop, uv_loop_option option, ...) {
 
   va_start(ap, option);
   /* Any platform-agnostic options should be handled here. */
-  err = uv__loop_configure(loop, option, ap);
+  if (option == UV_LOOP_USE_THREADPOOL || option == UV_LOOP_FS_PRIORITY)
+    err = uv__work_loop_configure(loop, option, ap);
+  else if (option == UV_LOOP_TIMER_WHEEL)
+    err = uv__timer_wheel_init(loop);
+  else if (option == UV_LOOP_TIMER_DHEAP)
+    err = uv__timer_dheap_init(loop);
+  else
+    err = uv__loop_configure(loop, option, ap);
   va_end(ap);
 
   return err;
@@ -864,6 +904,7 @@ int uv_loop_close(uv_loop_t* loop) {
       return UV_EBUSY;
   }
 
+  uv__timer_loop_close(loop);
   uv__loop_close(loop);
 
 #ifndef NDEBUG
@@ -911,6 +952,42 @@ int uv_read_start(uv_stream_t* stream,
 }
 
 
+int uv_read_start_pooled(uv_stream_t* stream, uv_read_cb read_cb) {
+  if (stream == NULL || read_cb == NULL)
+    return UV_EINVAL;
+
+  if (stream->flags & UV_HANDLE_CLOSING)
+    return UV_EINVAL;
+
+  if (stream->flags & UV_HANDLE_READING)
+    return UV_EALREADY;
+
+  if (!(stream->flags & UV_HANDLE_READABLE))
+    return UV_ENOTCONN;
+
+  return uv__read_start_pooled(stream, read_cb);
+}
+
+
+int uv_read_start_bufs(uv_stream_t* stream,
+                       uv_alloc_bufs_cb alloc_cb,
+                       uv_read_bufs_cb read_cb) {
+  if (stream == NULL || alloc_cb == NULL || read_cb == NULL)
+    return UV_EINVAL;
+
+  if (stream->flags & UV_HANDLE_CLOSING)
+    return UV_EINVAL;
+
+  if (stream->flags & UV_HANDLE_READING)
+    return UV_EALREADY;
+
+  if (!(stream->flags & UV_HANDLE_READABLE))
+    return UV_ENOTCONN;
+
+  return uv__read_start_bufs(stream, alloc_cb, read_cb);
+}
+
+
 void uv_os_free_environ(uv_env_item_t* envitems, int count) {
   int i;
 
@@ -86,8 +86,86 @@ extern int snprintf(char*, size_t, const char*, ...);
   atomic_exchange_explicit((_Atomic int*)(p), v, memory_order_relaxed)
 #endif
 
+/* Sequentially consistent operations on plain ints. */
+#ifdef _MSC_VER
+#define uv__load_int(p)                                                       \
+  InterlockedOr((LONG volatile*)(p), 0)
+#define uv__store_int(p, v)                                                   \
+  InterlockedExchange((LONG volatile*)(p), v)
+#define uv__fetch_add_int(p, v)                                               \
+  InterlockedExchangeAdd((LONG volatile*)(p), v)
+#elif defined(__VMS)
+#define uv__load_int(p)                                                       \
+  atomic_load((atomic_int*)(p))
+#define uv__store_int(p, v)                                                   \
+  atomic_store((atomic_int*)(p), v)
+#define uv__fetch_add_int(p, v)                                               \
+  atomic_fetch_add((atomic_int*)(p), v)
+#else
+#define uv__load_int(p)                                                       \
+  atomic_load((_Atomic int*)(p))
+#define uv__store_int(p, v)                                                   \
+  atomic_store((_Atomic int*)(p), v)
+#define uv__fetch_add_int(p, v)                                               \
+  atomic_fetch_add((_Atomic int*)(p), v)
+#endif
+
+/* Stores `desired` in `*p` if `*p` equals `expected`. Returns non-zero
+ * if the store happened.
+ */
+static inline int uv__cas_int(int* p, int expected, int desired) {
+#ifdef _MSC_VER
+  return InterlockedCompareExchange((LONG volatile*) p,
+                                    desired,
+                                    expected) == expected;
+#elif defined(__VMS)
+  return atomic_compare_exchange_strong((atomic_int*) p, &expected, desired);
+#else
+  return atomic_compare_exchange_strong((_Atomic int*) p, &expected, desired);
+#endif
+}
+
+/* Same for pointers. */
+static inline void* uv__load_ptr(void** p) {
+#ifdef _MSC_VER
+  return InterlockedCompareExchangePointer((PVOID volatile*) p, NULL, NULL);
+#elif defined(__VMS)
+  return atomic_load((atomic<void*>*) p);
+#else
+  return atomic_load((_Atomic(void*)*) p);
+#endif
+}
+
+static inline void* uv__exchange_ptr(void** p, void* desired) {
+#ifdef _MSC_VER
+  return InterlockedExchangePointer((PVOID volatile*) p, desired);
+#elif defined(__VMS)
+  return atomic_exchange((atomic<void*>*) p, desired);
+#else
+  return atomic_exchange((_Atomic(void*)*) p, desired);
+#endif
+}
+
+static inline int uv__cas_ptr(void** p, void* expected, void* desired) {
+#ifdef _MSC_VER
+  return InterlockedCompareExchangePointer((PVOID volatile*) p,
+                                           desired,
+                                           expected) == expected;
+#elif defined(__VMS)
+  return atomic_compare_exchange_strong((atomic<void*>*) p,
+                                        &expected,
+                                        desired);
+#else
+  return atomic_compare_exchange_strong((_Atomic(void*)*) p,
+                                        &expected,
+                                        desired);
+#endif
+}
+
 #define UV__UDP_DGRAM_MAXSIZE (64 * 1024)
 
+#define UV__FS_TYPE_MAX (UV_FS_LUTIME + 1)
+
 /* Handle flags. Some flags are specific to Windows or UNIX. */
 enum {
   /* Used by all handles. */
@@ -101,6 +179,7 @@ enum {
   /* Used by streams. */
   UV_HANDLE_LISTENING                   = 0x00000040,
   UV_HANDLE_CONNECTION                  = 0x00000080,
+  UV_HANDLE_READ_BUDGET                 = 0x00000100,
   UV_HANDLE_SHUT                        = 0x00000200,
   UV_HANDLE_READ_PARTIAL                = 0x00000400,
   UV_HANDLE_READ_EOF                    = 0x00000800,
@@ -116,6 +195,9 @@ enum {
   UV_HANDLE_EMULATE_IOCP                = 0x00080000,
   UV_HANDLE_BLOCKING_WRITES             = 0x00100000,
   UV_HANDLE_CANCELLATION_PENDING        = 0x00200000,
+  UV_HANDLE_READ_POOLED                 = 0x00800000,
+  UV_HANDLE_READ_BUFS                   = 0x20000000,
+  UV_HANDLE_CORKED                      = 0x40000000,
 
   /* Used by uv_tcp_t and uv_udp_t handles */
   UV_HANDLE_IPV6                        = 0x00400000,
@@ -131,6 +213,7 @@ enum {
   UV_HANDLE_UDP_PROCESSING              = 0x01000000,
   UV_HANDLE_UDP_CONNECTED               = 0x02000000,
   UV_HANDLE_UDP_RECVMMSG                = 0x04000000,
+  UV_HANDLE_UDP_GRO                     = 0x08000000,
 
   /* Only used by uv_pipe_t handles. */
   UV_HANDLE_NON_OVERLAPPED_PIPE         = 0x01000000,
@@ -161,6 +244,12 @@ int uv__read_start(uv_stream_t* stream,
                    uv_alloc_cb alloc_cb,
                    uv_read_cb read_cb);
 
+int uv__read_start_pooled(uv_stream_t* stream, uv_read_cb read_cb);
+
+int uv__read_start_bufs(uv_stream_t* stream,
+                        uv_alloc_bufs_cb alloc_cb,
+                        uv_read_bufs_cb read_cb);
+
 int uv__tcp_bind(uv_tcp_t* tcp,
                  const struct sockaddr* addr,
                  unsigned int addrlen,
@@ -204,22 +293,33 @@ int uv__udp_try_send(uv_udp_t* handle,
                      const struct sockaddr* addr,
                      unsigned int addrlen);
 
+int uv__udp_send_batch(uv_udp_send_batch_t* req,
+                       uv_udp_t* handle,
+                       uv_udp_msg_t msgs[],
+                       unsigned int nmsgs,
+                       uv_udp_send_batch_cb cb);
+
 int uv__udp_recv_start(uv_udp_t* handle, uv_alloc_cb alloccb,
                        uv_udp_recv_cb recv_cb);
 
+int uv__udp_recv_start_pooled(uv_udp_t* handle, uv_udp_recv_cb recv_cb);
+
 int uv__udp_recv_stop(uv_udp_t* handle);
 
 void uv__fs_poll_close(uv_fs_poll_t* handle);
 
+void uv__channel_close(uv_channel_t* handle);
+
 int uv__getaddrinfo_translate_error(int sys_err);    /* EAI_* error. */
 
 enum uv__work_kind {
-  UV__WORK_CPU,
-  UV__WORK_FAST_IO,
-  UV__WORK_SLOW_IO
+  UV__WORK_CPU = UV_WORK_KIND_CPU,
+  UV__WORK_FAST_IO = UV_WORK_KIND_FAST_IO,
+  UV__WORK_SLOW_IO = UV_WORK_KIND_SLOW_IO
 };
 
 void uv__work_submit(uv_loop_t* loop,
+                     uv_req_t* req,
                      struct uv__work *w,
                      enum uv__work_kind kind,
                      void (*work)(struct uv__work *w),
@@ -227,6 +327,16 @@ void uv__work_submit(uv_loop_t* loop,
 
 void uv__work_done(uv_async_t* handle);
 
+void uv__work_loop_close(uv_loop_t* loop);
+
+int uv__timer_wheel_init(uv_loop_t* loop);
+int uv__timer_dheap_init(uv_loop_t* loop);
+void uv__timer_loop_close(uv_loop_t* loop);
+
+int uv__work_loop_configure(uv_loop_t* loop,
+                            uv_loop_option option,
+                            va_list ap);
+
 size_t uv__count_bufs(const uv_buf_t bufs[], unsigned int nbufs);
 
 int uv__socket_sockopt(uv_handle_t* handle, int optname, int* value);
@@ -387,6 +497,16 @@ void uv__threadpool_cleanup(void);
     uv__get_loop_metrics(loop)->metrics.events_waiting += (e);                \
   } while (0)
 
+#define uv__metrics_inc_buf_pool_hits(loop, n)                                \
+  do {                                                                        \
+    uv__get_loop_metrics(loop)->metrics.buf_pool_hits += (n);                 \
+  } while (0)
+
+#define uv__metrics_inc_buf_pool_misses(loop)                                 \
+  do {                                                                        \
+    uv__get_loop_metrics(loop)->metrics.buf_pool_misses++;                    \
+  } while (0)
+
 /* Allocator prototypes */
 void *uv__calloc(size_t count, size_t size);
 char *uv__strdup(const char* s);
@@ -430,15 +550,57 @@ struct uv__iou {
   uint32_t in_flight;
   uint32_t flags;
 };
+
+/* Buffers the kernel picks from for pooled reads, see unix/linux.c. */
+struct uv__iou_bufs {
+  void* ring;  /* array of struct uv__io_uring_buf, shared with the kernel */
+  char* base;  /* count buffers of size bytes each */
+  size_t ringlen;
+  uint32_t count;
+  uint32_t size;
+  uint32_t lent;  /* Filled by the kernel and not released yet. */
+  uint16_t tail;
+  struct uv__queue waiting;  /* Streams that ran out of buffers. */
+};
 #endif  /* __linux__ */
 
+struct uv__buf_pool {
+  char* base;  /* count buffers of size bytes each */
+  void* free;  /* Linked through the first bytes of each free buffer. */
+  unsigned int count;
+  unsigned int size;
+};
+
 struct uv__loop_internal_fields_s {
   unsigned int flags;
   uv__loop_metrics_t loop_metrics;
   int current_timeout;
+  unsigned int wq_shard;  /* Home thread pool queue + 1, 0 if unassigned. */
+  void* wq_completed;  /* Finished work, see threadpool.c. */
+  uv_threadpool_t* wq_pools[UV_REQ_TYPE_MAX];  /* NULL means default. */
+  unsigned char wq_fs_priority[UV__FS_TYPE_MAX];  /* uv_work_priority */
+  struct uv__timer_wheel* timer_wheel;  /* NULL unless UV_LOOP_TIMER_WHEEL. */
+  struct uv__timer_dheap* timer_dheap;  /* NULL unless UV_LOOP_TIMER_DHEAP. */
+  struct {
+    void* min;
+    unsigned int nelts;
+  } timer_slack_heap, timer_deadline_heap;  /* Timers with slack, see timer.c. */
+  void* async_ready;  /* Signalled uv_async_t handles, see unix/async.c. */
+  void* async_taken;  /* Taken off async_ready, not yet dispatched. */
+  unsigned int async_closed;  /* Closed handles on async_taken. */
+  int async_state;  /* Whether uv_async_send() must wake the loop. */
+  struct uv__buf_pool buf_pool;  /* Only with UV_LOOP_BUFFER_POOL. */
+  struct {
+    unsigned int bytes;
+    uint64_t time;  /* In nanoseconds. */
+    unsigned int tick;  /* Loop iterations, see unix/core.c. */
+    struct uv__queue next;  /* Streams that have had their share. */
+  } read_budget;  /* Per stream and loop iteration, 0 is no limit. */
 #ifdef __linux__
   struct uv__iou ctl;
   struct uv__iou iou;
+  struct uv__iou streams;  /* Only with UV_LOOP_IO_URING_STREAMS. */
+  struct uv__iou_bufs bufs;  /* Only with UV_LOOP_IO_URING_BUFFERS. */
   void* inv;  /* used by uv__platform_invalidate_fd() */
 #endif  /* __linux__ */
 };
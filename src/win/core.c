@@ -357,10 +357,8 @@ void uv__loop_close(uv_loop_t* loop) {
       closesocket(sock);
   }
 
-  uv_mutex_lock(&loop->wq_mutex);
-  assert(uv__queue_empty(&loop->wq) && "thread pool work queue not empty!");
+  uv__work_loop_close(loop);
   assert(!uv__has_active_reqs(loop));
-  uv_mutex_unlock(&loop->wq_mutex);
   uv_mutex_destroy(&loop->wq_mutex);
 
   uv__free(loop->timer_heap);
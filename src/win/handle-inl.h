@@ -156,6 +156,10 @@ INLINE static void uv__process_endgames(uv_loop_t* loop) {
         uv__fs_poll_endgame(loop, (uv_fs_poll_t*) handle);
         break;
 
+      case UV_CHANNEL:
+        uv__channel_endgame(loop, (uv_channel_t*) handle);
+        break;
+
       default:
         assert(0);
         break;
@@ -141,6 +141,11 @@ void uv_close(uv_handle_t* handle, uv_close_cb cb) {
       uv__handle_closing(handle);
       return;
 
+    case UV_CHANNEL:
+      uv__channel_close((uv_channel_t*) handle);
+      uv__handle_closing(handle);
+      return;
+
     default:
       /* Not supported */
       abort();
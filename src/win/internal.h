@@ -248,6 +248,7 @@ void uv__fs_event_endgame(uv_loop_t* loop, uv_fs_event_t* handle);
  * Stat poller.
  */
 void uv__fs_poll_endgame(uv_loop_t* loop, uv_fs_poll_t* handle);
+void uv__channel_endgame(uv_loop_t* loop, uv_channel_t* handle);
 
 
 /*
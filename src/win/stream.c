@@ -91,6 +91,23 @@ int uv__read_start(uv_stream_t* handle,
 }
 
 
+int uv__read_start_pooled(uv_stream_t* handle, uv_read_cb read_cb) {
+  return UV_ENOSYS;
+}
+
+
+int uv__read_start_bufs(uv_stream_t* handle,
+                        uv_alloc_bufs_cb alloc_cb,
+                        uv_read_bufs_cb read_cb) {
+  return UV_ENOSYS;
+}
+
+
+void uv_buf_release(uv_loop_t* loop, const uv_buf_t* buf) {
+  uv__free(buf->base);  /* Never lent, pooled reads fail with UV_ENOSYS. */
+}
+
+
 int uv_read_stop(uv_stream_t* handle) {
   int err;
 
@@ -250,3 +267,8 @@ int uv_stream_set_blocking(uv_stream_t* handle, int blocking) {
 
   return 0;
 }
+
+
+int uv_stream_set_cork(uv_stream_t* handle, int enable) {
+  return UV_ENOSYS;
+}
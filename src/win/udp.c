@@ -335,6 +335,11 @@ int uv__udp_recv_start(uv_udp_t* handle, uv_alloc_cb alloc_cb,
 }
 
 
+int uv__udp_recv_start_pooled(uv_udp_t* handle, uv_udp_recv_cb recv_cb) {
+  return UV_ENOSYS;
+}
+
+
 int uv__udp_recv_stop(uv_udp_t* handle) {
   if (handle->flags & UV_HANDLE_READING) {
     handle->flags &= ~UV_HANDLE_READING;
@@ -890,6 +895,36 @@ int uv_udp_set_broadcast(uv_udp_t* handle, int value) {
 }
 
 
+int uv_udp_set_gso(uv_udp_t* handle, unsigned int segment_size) {
+  return UV_ENOSYS;
+}
+
+
+int uv_udp_set_gro(uv_udp_t* handle, int on) {
+  return UV_ENOSYS;
+}
+
+
+int uv_udp_set_recvmmsg(uv_udp_t* handle, unsigned int nmsgs) {
+  return UV_ENOSYS;
+}
+
+
+int uv_udp_set_recv_meta(uv_udp_t* handle, unsigned int flags) {
+  return UV_ENOSYS;
+}
+
+
+int uv_udp_set_pacing(uv_udp_t* handle, uint64_t rate, size_t burst) {
+  return UV_ENOSYS;
+}
+
+
+int uv_udp_get_stats(const uv_udp_t* handle, uv_udp_stats_t* stats) {
+  return UV_ENOSYS;
+}
+
+
 int uv__udp_is_bound(uv_udp_t* handle) {
   struct sockaddr_storage addr;
   int addrlen;
@@ -999,6 +1034,9 @@ int uv__udp_bind(uv_udp_t* handle,
                  unsigned int flags) {
   int err;
 
+  if (flags & UV_UDP_REUSEPORT)
+    return UV_ENOTSUP;
+
   err = uv__udp_maybe_bind(handle, addr, addrlen, flags);
   if (err)
     return uv_translate_sys_error(err);
@@ -1135,3 +1173,12 @@ int uv__udp_try_send(uv_udp_t* handle,
 
   return bytes;
 }
+
+
+int uv__udp_send_batch(uv_udp_send_batch_t* req,
+                       uv_udp_t* handle,
+                       uv_udp_msg_t msgs[],
+                       unsigned int nmsgs,
+                       uv_udp_send_batch_cb cb) {
+  return UV_ENOSYS;
+}
@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define NUM_PINGS (1000 * 1000)
 
@@ -40,6 +41,41 @@ struct ctx {
 };
 
 
+/* Counts the read() and write() family syscalls made by the whole process,
+ * i.e. mostly eventfd traffic. Returns -1 if the platform doesn't tell.
+ */
+static int syscall_counts(uint64_t* reads, uint64_t* writes) {
+#if defined(__linux__)
+  unsigned long long val;
+  char name[32];
+  FILE* fp;
+  int found;
+
+  fp = fopen("/proc/self/io", "r");
+  if (fp == NULL)
+    return -1;
+
+  found = 0;
+  while (fscanf(fp, "%31[^:]: %llu\n", name, &val) == 2) {
+    if (strcmp(name, "syscr") == 0) {
+      *reads = val;
+      found |= 1;
+    } else if (strcmp(name, "syscw") == 0) {
+      *writes = val;
+      found |= 2;
+    }
+  }
+
+  fclose(fp);
+  return found == 3 ? 0 : -1;
+#else
+  (void) reads;
+  (void) writes;
+  return -1;
+#endif
+}
+
+
 static void worker_async_cb(uv_async_t* handle) {
   struct ctx* ctx = container_of(handle, struct ctx, worker_async);
 
@@ -76,7 +112,10 @@ static int test_async(int nthreads) {
   char fmtbuf[32];
   struct ctx* threads;
   struct ctx* ctx;
+  uint64_t reads[2];
+  uint64_t writes[2];
   uint64_t time;
+  int counted;
   int i;
 
   threads = (struct ctx*) calloc(nthreads, sizeof(threads[0]));
@@ -93,6 +132,7 @@ static int test_async(int nthreads) {
     ASSERT_OK(uv_thread_create(&ctx->thread, worker, ctx));
   }
 
+  counted = syscall_counts(&reads[0], &writes[0]) == 0;
   time = uv_hrtime();
 
   ASSERT_OK(uv_run(uv_default_loop(), UV_RUN_DEFAULT));
@@ -101,6 +141,7 @@ static int test_async(int nthreads) {
     ASSERT_OK(uv_thread_join(&threads[i].thread));
 
   time = uv_hrtime() - time;
+  counted = counted && syscall_counts(&reads[1], &writes[1]) == 0;
 
   for (i = 0; i < nthreads; i++) {
     ctx = threads + i;
@@ -115,6 +156,13 @@ static int test_async(int nthreads) {
          time / 1e9,
          fmt(&fmtbuf, NUM_PINGS / (time / 1e9)));
 
+  /* Each ping is two uv_async_send() calls, one in each direction. */
+  if (counted)
+    printf("async%d: %.3f writes and %.3f reads per uv_async_send()\n",
+           nthreads,
+           (writes[1] - writes[0]) / (2.0 * nthreads * NUM_PINGS),
+           (reads[1] - reads[0]) / (2.0 * nthreads * NUM_PINGS));
+
   free(threads);
 
   MAKE_VALGRIND_HAPPY(uv_default_loop());
@@ -0,0 +1,113 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "task.h"
+#include "uv.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_MESSAGES            (4 * 1000 * 1000)
+#define CHANNEL_CAPACITY        1024
+
+static unsigned int messages;
+static unsigned int batches;
+static unsigned int per_producer;
+
+
+static void channel_cb(uv_channel_t* handle, void** msgs, unsigned int nmsgs) {
+  batches++;
+  messages += nmsgs;
+
+  if (messages == per_producer * *(int*) handle->data)
+    uv_close((uv_handle_t*) handle, NULL);
+}
+
+
+static void producer(void* arg) {
+  uv_channel_t* handle;
+  uintptr_t i;
+
+  handle = (uv_channel_t*) arg;
+
+  /* Back off when the loop thread falls behind. */
+  for (i = 0; i < per_producer; i++)
+    while (uv_channel_try_send(handle, (void*) i) == UV_EAGAIN)
+      uv_sleep(0);
+}
+
+
+static int test_channel(int nthreads) {
+  char fmtbuf[3][32];
+  uv_thread_t* tids;
+  uv_channel_t handle;
+  uint64_t time;
+  int i;
+
+  tids = (uv_thread_t*) calloc(nthreads, sizeof(tids[0]));
+  ASSERT_NOT_NULL(tids);
+
+  per_producer = NUM_MESSAGES / nthreads;
+  ASSERT_OK(uv_channel_init(uv_default_loop(),
+                            &handle,
+                            CHANNEL_CAPACITY,
+                            channel_cb));
+  handle.data = &nthreads;
+
+  time = uv_hrtime();
+
+  for (i = 0; i < nthreads; i++)
+    ASSERT_OK(uv_thread_create(tids + i, producer, &handle));
+
+  ASSERT_OK(uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+
+  time = uv_hrtime() - time;
+
+  for (i = 0; i < nthreads; i++)
+    ASSERT_OK(uv_thread_join(tids + i));
+
+  printf("channel_%d: %s messages in %.2f seconds (%s/sec, %s per callback)\n",
+         nthreads,
+         fmt(&fmtbuf[0], messages),
+         time / 1e9,
+         fmt(&fmtbuf[1], messages / (time / 1e9)),
+         fmt(&fmtbuf[2], (double) messages / batches));
+
+  free(tids);
+
+  MAKE_VALGRIND_HAPPY(uv_default_loop());
+  return 0;
+}
+
+
+BENCHMARK_IMPL(channel_1) {
+  return test_channel(1);
+}
+
+
+BENCHMARK_IMPL(channel_4) {
+  return test_channel(4);
+}
+
+
+BENCHMARK_IMPL(channel_16) {
+  return test_channel(16);
+}
@@ -38,7 +38,8 @@ static void close_cb(uv_handle_t* handle) {
 }
 
 
-BENCHMARK_IMPL(million_timers) {
+/* `option` selects the timer backend, -1 is the default heap. */
+static int million_timers(int option) {
   uv_timer_t* timers;
   uv_loop_t* loop;
   uint64_t before_all;
@@ -54,6 +55,9 @@ BENCHMARK_IMPL(million_timers) {
   loop = uv_default_loop();
   timeout = 0;
 
+  if (option != -1)
+    ASSERT_OK(uv_loop_configure(loop, (uv_loop_option) option));
+
   before_all = uv_hrtime();
   for (i = 0; i < NUM_TIMERS; i++) {
     if (i % 1000 == 0) timeout++;
@@ -84,3 +88,18 @@ BENCHMARK_IMPL(million_timers) {
   MAKE_VALGRIND_HAPPY(loop);
   return 0;
 }
+
+
+BENCHMARK_IMPL(million_timers) {
+  return million_timers(-1);
+}
+
+
+BENCHMARK_IMPL(million_timers_wheel) {
+  return million_timers(UV_LOOP_TIMER_WHEEL);
+}
+
+
+BENCHMARK_IMPL(million_timers_dheap) {
+  return million_timers(UV_LOOP_TIMER_DHEAP);
+}
@@ -28,6 +28,8 @@
 
 static int TARGET_CONNECTIONS;
 #define WRITE_BUFFER_SIZE           8192
+#define LARGE_WRITE_BUFFER_SIZE     (256 * 1024)
+#define LARGE_WRITES_IN_FLIGHT      4
 #define MAX_SIMULTANEOUS_CONNECTS   100
 
 #define PRINT_STATS                 0
@@ -66,7 +68,13 @@ static int64_t nsent_total = 0;
 
 static int stats_left = 0;
 
-static char write_buffer[WRITE_BUFFER_SIZE];
+static char write_buffer[LARGE_WRITE_BUFFER_SIZE];
+static size_t write_size = WRITE_BUFFER_SIZE;
+static int writes_in_flight = 1;
+static size_t zerocopy_threshold = 0;  /* uv_tcp_zerocopy() */
+static const char* variant = "";
+
+static uv_rusage_t start_rusage;
 
 /* Make this as large as you need. */
 #define MAX_WRITE_HANDLES 1000
@@ -85,6 +93,21 @@ static double gbit(int64_t bytes, int64_t passed_ms) {
 }
 
 
+static uint64_t cpu_usec(const uv_rusage_t* ru) {
+  return (ru->ru_utime.tv_sec + ru->ru_stime.tv_sec) * (uint64_t) 1e6 +
+         ru->ru_utime.tv_usec + ru->ru_stime.tv_usec;
+}
+
+
+/* User and system time of this process per byte written. */
+static double cpu_ns_per_byte(int64_t bytes) {
+  uv_rusage_t ru;
+
+  ASSERT_OK(uv_getrusage(&ru));
+  return (cpu_usec(&ru) - cpu_usec(&start_rusage)) * 1e3 / bytes;
+}
+
+
 static void show_stats(uv_timer_t* handle) {
   int64_t diff;
   int i;
@@ -102,10 +125,12 @@ static void show_stats(uv_timer_t* handle) {
     uv_update_time(loop);
     diff = uv_now(loop) - start_time;
 
-    fprintf(stderr, "%s_pump%d_client: %.1f gbit/s\n",
+    fprintf(stderr, "%s_pump%d_client%s: %.1f gbit/s, %.3f ns cpu/byte\n",
             type == TCP ? "tcp" : "pipe",
             write_sockets,
-            gbit(nsent_total, diff));
+            variant,
+            gbit(nsent_total, diff),
+            cpu_ns_per_byte(nsent_total));
     fflush(stderr);
 
     for (i = 0; i < write_sockets; i++) {
@@ -165,6 +190,7 @@ static void start_stats_collection(void) {
 
   uv_update_time(loop);
   start_time = uv_now(loop);
+  ASSERT_OK(uv_getrusage(&start_rusage));
 }
 
 
@@ -192,8 +218,8 @@ static void write_cb(uv_write_t* req, int status) {
 
   req_free((uv_req_t*) req);
 
-  nsent += sizeof write_buffer;
-  nsent_total += sizeof write_buffer;
+  nsent += write_size;
+  nsent_total += write_size;
 
   do_write((uv_stream_t*) req->handle);
 }
@@ -205,7 +231,7 @@ static void do_write(uv_stream_t* stream) {
   int r;
 
   buf.base = (char*) &write_buffer;
-  buf.len = sizeof write_buffer;
+  buf.len = write_size;
 
   req = (uv_write_t*) req_alloc();
   r = uv_write(req, stream, &buf, 1, write_cb);
@@ -215,6 +241,7 @@ static void do_write(uv_stream_t* stream) {
 
 static void connect_cb(uv_connect_t* req, int status) {
   int i;
+  int j;
 
   if (status) {
     fprintf(stderr, "%s", uv_strerror(status));
@@ -232,10 +259,12 @@ static void connect_cb(uv_connect_t* req, int status) {
 
     /* Yay! start writing */
     for (i = 0; i < write_sockets; i++) {
-      if (type == TCP)
-        do_write((uv_stream_t*) &tcp_write_handles[i]);
-      else
-        do_write((uv_stream_t*) &pipe_write_handles[i]);
+      for (j = 0; j < writes_in_flight; j++) {
+        if (type == TCP)
+          do_write((uv_stream_t*) &tcp_write_handles[i]);
+        else
+          do_write((uv_stream_t*) &pipe_write_handles[i]);
+      }
     }
   }
 }
@@ -255,6 +284,11 @@ static void maybe_connect_some(void) {
       r = uv_tcp_init(loop, tcp);
       ASSERT_OK(r);
 
+      if (zerocopy_threshold != 0) {
+        r = uv_tcp_zerocopy(tcp, zerocopy_threshold);
+        ASSERT_OK(r);
+      }
+
       req = (uv_connect_t*) req_alloc();
       r = uv_tcp_connect(req,
                          tcp,
@@ -466,6 +500,28 @@ BENCHMARK_IMPL(tcp_pump1_client) {
 }
 
 
+/* Same as tcp_pump1_client with 256 kB writes, to compare with the zero-copy
+ * variant below.
+ */
+BENCHMARK_IMPL(tcp_pump1_client_256k) {
+  write_size = LARGE_WRITE_BUFFER_SIZE;
+  writes_in_flight = LARGE_WRITES_IN_FLIGHT;
+  variant = "_256k";
+  tcp_pump(1);
+  return 0;
+}
+
+
+BENCHMARK_IMPL(tcp_pump1_client_zerocopy) {
+  write_size = LARGE_WRITE_BUFFER_SIZE;
+  writes_in_flight = LARGE_WRITES_IN_FLIGHT;
+  zerocopy_threshold = LARGE_WRITE_BUFFER_SIZE;
+  variant = "_zerocopy";
+  tcp_pump(1);
+  return 0;
+}
+
+
 BENCHMARK_IMPL(pipe_pump100_client) {
   pipe_pump(100);
   return 0;
@@ -22,6 +22,8 @@
 #include "task.h"
 #include "uv.h"
 
+#include <stdlib.h>
+
 static int done = 0;
 static unsigned events = 0;
 static unsigned result;
@@ -45,6 +47,102 @@ static void after_work_cb(uv_work_t* req, int status) {
 
 static void timer_cb(uv_timer_t* handle) { done = 1; }
 
+static void batch_work_cb(uv_work_t* req) {
+}
+
+static void batch_after_work_cb(uv_work_t* req, int status) {
+  events++;
+  if (!done)
+    ASSERT_OK(uv_queue_work(req->loop, req, batch_work_cb,
+                            batch_after_work_cb));
+}
+
+#define FLOOD_SIZE 256
+#define MAX_PROBES 100000
+
+static uv_work_options_t flood_options;
+static uv_work_options_t probe_options;
+static uint64_t probe_queued;
+static uint64_t probe_started;
+static uint64_t probe_latency[MAX_PROBES];
+static unsigned int nprobes;
+
+static void flood_work_cb(uv_work_t* req) {
+  uint64_t start;
+
+  /* About 20 us worth of bulk work. */
+  start = uv_hrtime();
+  while (uv_hrtime() - start < 20000)
+    ;
+}
+
+static void flood_after_work_cb(uv_work_t* req, int status) {
+  if (!done)
+    ASSERT_OK(uv_queue_work_ex(req->loop, req, flood_work_cb,
+                               flood_after_work_cb, &flood_options));
+}
+
+static void probe_work_cb(uv_work_t* req) {
+  probe_started = uv_hrtime();
+}
+
+static void probe_after_work_cb(uv_work_t* req, int status) {
+  probe_latency[nprobes++] = probe_started - probe_queued;
+  if (done || nprobes == MAX_PROBES)
+    return;
+
+  probe_queued = uv_hrtime();
+  ASSERT_OK(uv_queue_work_ex(req->loop, req, probe_work_cb,
+                             probe_after_work_cb, &probe_options));
+}
+
+static int compare_latency(const void* a, const void* b) {
+  uint64_t x = *(const uint64_t*) a;
+  uint64_t y = *(const uint64_t*) b;
+  return x < y ? -1 : x > y;
+}
+
+/* Measures how long a probe job waits for a thread while the pool is
+ * flooded with bulk jobs.
+ */
+static void run_priority(uv_loop_t* loop,
+                         uv_work_priority flood_priority,
+                         uv_work_priority probe_priority,
+                         const char* name) {
+  static uv_work_t flood[FLOOD_SIZE];
+  uv_timer_t timer_handle;
+  uv_work_t probe;
+  size_t i;
+
+  done = 0;
+  nprobes = 0;
+  flood_options.priority = flood_priority;
+  probe_options.priority = probe_priority;
+
+  ASSERT_OK(uv_timer_init(loop, &timer_handle));
+  ASSERT_OK(uv_timer_start(&timer_handle, timer_cb, 2000, 0));
+
+  for (i = 0; i < ARRAY_SIZE(flood); i++)
+    ASSERT_OK(uv_queue_work_ex(loop, &flood[i], flood_work_cb,
+                               flood_after_work_cb, &flood_options));
+
+  probe_queued = uv_hrtime();
+  ASSERT_OK(uv_queue_work_ex(loop, &probe, probe_work_cb,
+                             probe_after_work_cb, &probe_options));
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_GT(nprobes, 0);
+  qsort(probe_latency, nprobes, sizeof(probe_latency[0]), compare_latency);
+  printf("%s: %u probes, p50 %.1f us, p99 %.1f us\n",
+         name,
+         nprobes,
+         probe_latency[nprobes / 2] / 1e3,
+         probe_latency[nprobes * 99 / 100] / 1e3);
+
+  uv_close((uv_handle_t*) &timer_handle, NULL);
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+}
+
 BENCHMARK_IMPL(queue_work) {
   char fmtbuf[2][32];
   uv_timer_t timer_handle;
@@ -69,3 +167,58 @@ BENCHMARK_IMPL(queue_work) {
   MAKE_VALGRIND_HAPPY(loop);
   return 0;
 }
+
+
+/* Keeps many small jobs in flight so that completions pile up while the
+ * loop is busy, and reports how many loop iterations it took to deliver
+ * them.
+ */
+BENCHMARK_IMPL(queue_work_batch) {
+  char fmtbuf[2][32];
+  uv_timer_t timer_handle;
+  uv_work_t work[1024];
+  uv_metrics_t metrics;
+  uv_loop_t* loop;
+  size_t i;
+  int timeout;
+
+  loop = uv_default_loop();
+  timeout = 5000;
+
+  ASSERT_OK(uv_timer_init(loop, &timer_handle));
+  ASSERT_OK(uv_timer_start(&timer_handle, timer_cb, timeout, 0));
+
+  for (i = 0; i < ARRAY_SIZE(work); i++)
+    ASSERT_OK(uv_queue_work(loop, &work[i], batch_work_cb,
+                            batch_after_work_cb));
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+  ASSERT_OK(uv_metrics_info(loop, &metrics));
+
+  printf("%s completions in %.1f seconds (%s/s), "
+         "%.4f wakeups per completion\n",
+         fmt(&fmtbuf[0], events),
+         timeout / 1000.,
+         fmt(&fmtbuf[1], events / (timeout / 1000.)),
+         (double) metrics.loop_count / events);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
+
+
+BENCHMARK_IMPL(queue_work_priority) {
+  uv_loop_t* loop;
+
+  loop = uv_default_loop();
+  run_priority(loop,
+               UV_WORK_PRIORITY_NORMAL,
+               UV_WORK_PRIORITY_NORMAL,
+               "normal probes, normal flood");
+  run_priority(loop,
+               UV_WORK_PRIORITY_BACKGROUND,
+               UV_WORK_PRIORITY_HIGH,
+               "high probes, background flood");
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
@@ -39,6 +39,8 @@ static uv_tcp_t tcp_client;
 static uv_connect_t connect_req;
 static uv_shutdown_t shutdown_req;
 
+static int cork;
+
 static int shutdown_cb_called = 0;
 static int connect_cb_called = 0;
 static int write_cb_called = 0;
@@ -57,6 +59,12 @@ static void connect_cb(uv_connect_t* req, int status) {
 
   ASSERT_PTR_EQ(req->handle, (uv_stream_t*)&tcp_client);
 
+  /* Writes go out together when the pending callbacks run. */
+  if (cork) {
+    r = uv_stream_set_cork(req->handle, 1);
+    ASSERT_OK(r);
+  }
+
   for (i = 0; i < NUM_WRITE_REQS; i++) {
     w = &write_reqs[i];
     r = uv_write(&w->req, req->handle, &w->buf, 1, write_cb);
@@ -94,7 +102,7 @@ static void close_cb(uv_handle_t* handle) {
 }
 
 
-BENCHMARK_IMPL(tcp_write_batch) {
+static int tcp_write_batch(int corked) {
   struct sockaddr_in addr;
   uv_loop_t* loop;
   uint64_t start;
@@ -102,6 +110,8 @@ BENCHMARK_IMPL(tcp_write_batch) {
   int i;
   int r;
 
+  cork = corked;
+
   write_reqs = (write_req*) malloc(sizeof(*write_reqs) * NUM_WRITE_REQS);
   ASSERT_NOT_NULL(write_reqs);
 
@@ -135,10 +145,21 @@ BENCHMARK_IMPL(tcp_write_batch) {
   ASSERT_EQ(1, shutdown_cb_called);
   ASSERT_EQ(1, close_cb_called);
 
-  printf("%ld write requests in %.2fs.\n",
+  printf("%ld write requests in %.2fs%s.\n",
          (long)NUM_WRITE_REQS,
-         (stop - start) / 1e9);
+         (stop - start) / 1e9,
+         corked ? " (corked)" : "");
 
   MAKE_VALGRIND_HAPPY(loop);
   return 0;
 }
+
+
+BENCHMARK_IMPL(tcp_write_batch) {
+  return tcp_write_batch(0);
+}
+
+
+BENCHMARK_IMPL(tcp_write_batch_cork) {
+  return tcp_write_batch(1);
+}
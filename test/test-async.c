@@ -132,3 +132,130 @@ TEST_IMPL(async) {
   MAKE_VALGRIND_HAPPY(uv_default_loop());
   return 0;
 }
+
+
+#define MANY_ASYNC 64
+
+static uv_async_t many_handles[MANY_ASYNC];
+static int many_cb_called[MANY_ASYNC];
+static int many_round;
+static int many_close_cb_called;
+
+
+static void many_thread_cb(void* arg) {
+  int i;
+
+  for (i = 0; i < MANY_ASYNC; i++)
+    ASSERT_OK(uv_async_send(&many_handles[i]));
+}
+
+
+static void many_close_cb(uv_handle_t* handle) {
+  many_close_cb_called++;
+}
+
+
+static void many_async_cb(uv_async_t* handle) {
+  int i;
+
+  i = handle - many_handles;
+  ASSERT_GE(i, 0);
+  ASSERT_LT(i, MANY_ASYNC);
+  many_cb_called[i]++;
+
+  if (many_round == 0) {
+    for (i = 0; i < MANY_ASYNC; i++)
+      if (many_cb_called[i] == 0)
+        return;
+
+    /* Every handle seen once. Signal them all again, then close them from
+     * the first callback of the next round while the rest are pending.
+     */
+    ASSERT_OK(uv_thread_join(&thread));
+    many_round = 1;
+    for (i = 0; i < MANY_ASYNC; i++)
+      ASSERT_OK(uv_async_send(&many_handles[i]));
+    return;
+  }
+
+  for (i = 0; i < MANY_ASYNC; i++)
+    uv_close((uv_handle_t*) &many_handles[i], many_close_cb);
+}
+
+
+TEST_IMPL(async_many_pending) {
+  int calls;
+  int i;
+
+  for (i = 0; i < MANY_ASYNC; i++)
+    ASSERT_OK(uv_async_init(uv_default_loop(),
+                            &many_handles[i],
+                            many_async_cb));
+
+  ASSERT_OK(uv_thread_create(&thread, many_thread_cb, NULL));
+  ASSERT_OK(uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+
+  /* Exactly one handle ran in the second round; the others were closed
+   * while pending and must not have been called.
+   */
+  calls = 0;
+  for (i = 0; i < MANY_ASYNC; i++) {
+    ASSERT_GE(many_cb_called[i], 1);
+    ASSERT_LE(many_cb_called[i], 2);
+    calls += many_cb_called[i];
+  }
+  ASSERT_EQ(MANY_ASYNC + 1, calls);
+  ASSERT_EQ(MANY_ASYNC, many_close_cb_called);
+
+  MAKE_VALGRIND_HAPPY(uv_default_loop());
+  return 0;
+}
+
+
+static uv_timer_t send_close_timer;
+static uv_async_t send_close_handles[2];
+static int send_close_cb_called;
+static int send_close_close_cb_called;
+
+
+static void send_close_close_cb(uv_handle_t* handle) {
+  send_close_close_cb_called++;
+}
+
+
+static void send_close_async_cb(uv_async_t* handle) {
+  ASSERT_PTR_EQ(handle, &send_close_handles[0]);
+  send_close_cb_called++;
+  uv_close((uv_handle_t*) handle, send_close_close_cb);
+}
+
+
+static void send_close_timer_cb(uv_timer_t* handle) {
+  /* The loop is awake after polling, so neither send writes the eventfd.
+   * Closing the second handle takes both off the ready list; the first must
+   * still run.
+   */
+  ASSERT_OK(uv_async_send(&send_close_handles[1]));
+  ASSERT_OK(uv_async_send(&send_close_handles[0]));
+  uv_close((uv_handle_t*) &send_close_handles[1], send_close_close_cb);
+  uv_close((uv_handle_t*) handle, send_close_close_cb);
+}
+
+
+TEST_IMPL(async_send_close_pending) {
+  uv_loop_t* loop;
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_async_init(loop, &send_close_handles[0], send_close_async_cb));
+  ASSERT_OK(uv_async_init(loop, &send_close_handles[1], send_close_async_cb));
+  ASSERT_OK(uv_timer_init(loop, &send_close_timer));
+  ASSERT_OK(uv_timer_start(&send_close_timer, send_close_timer_cb, 1, 0));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(1, send_close_cb_called);
+  ASSERT_EQ(3, send_close_close_cb_called);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
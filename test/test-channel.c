@@ -0,0 +1,153 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#define NUM_PRODUCERS 4
+#define NUM_MESSAGES 10000
+
+static uv_channel_t channel;
+static uv_thread_t producers[NUM_PRODUCERS];
+static unsigned int channel_cb_called;
+static unsigned int msgs_received;
+static unsigned int close_cb_called;
+static uintptr_t next_msg[NUM_PRODUCERS];
+
+
+static void close_cb(uv_handle_t* handle) {
+  ASSERT_PTR_EQ(handle, &channel);
+  close_cb_called++;
+}
+
+
+static void basic_cb(uv_channel_t* handle, void** msgs, unsigned int nmsgs) {
+  unsigned int i;
+
+  ASSERT_PTR_EQ(handle, &channel);
+  ASSERT_EQ(4, nmsgs);
+
+  for (i = 0; i < nmsgs; i++)
+    ASSERT_EQ(i + 1, (uintptr_t) msgs[i]);
+
+  channel_cb_called++;
+  msgs_received += nmsgs;
+
+  /* There's room again now that the batch has been drained. */
+  ASSERT_OK(uv_channel_try_send(handle, (void*) 42));
+  uv_close((uv_handle_t*) handle, close_cb);
+}
+
+
+TEST_IMPL(channel_basic) {
+  uv_loop_t* loop;
+  uintptr_t i;
+
+  loop = uv_default_loop();
+
+  ASSERT_EQ(UV_EINVAL, uv_channel_init(loop, &channel, 0, basic_cb));
+  ASSERT_EQ(UV_EINVAL, uv_channel_init(loop, &channel, 4, NULL));
+  ASSERT_EQ(UV_EINVAL, uv_channel_init(loop, &channel, ~0u, basic_cb));
+
+  ASSERT_OK(uv_channel_init(loop, &channel, 3, basic_cb));
+  ASSERT_EQ(4, uv_channel_capacity(&channel));
+  ASSERT_EQ(UV_CHANNEL, uv_handle_get_type((uv_handle_t*) &channel));
+  ASSERT_EQ(1, uv_is_active((uv_handle_t*) &channel));
+
+  for (i = 1; i <= 4; i++)
+    ASSERT_OK(uv_channel_try_send(&channel, (void*) i));
+  ASSERT_EQ(UV_EAGAIN, uv_channel_try_send(&channel, (void*) i));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  /* The message sent from the callback was discarded by uv_close(). */
+  ASSERT_EQ(1, channel_cb_called);
+  ASSERT_EQ(4, msgs_received);
+  ASSERT_EQ(1, close_cb_called);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
+
+
+static void producer(void* arg) {
+  uintptr_t id;
+  uintptr_t i;
+
+  id = (uintptr_t) arg;
+
+  /* Encode the producer in the low bits so the loop thread can check that
+   * every producer's messages arrive in order.
+   */
+  for (i = 0; i < NUM_MESSAGES; i++)
+    while (uv_channel_try_send(&channel, (void*) (i * NUM_PRODUCERS + id)))
+      uv_sleep(0);
+}
+
+
+static void producers_cb(uv_channel_t* handle,
+                         void** msgs,
+                         unsigned int nmsgs) {
+  uintptr_t msg;
+  unsigned int i;
+
+  ASSERT_GT(nmsgs, 0);
+  ASSERT_LE(nmsgs, uv_channel_capacity(handle));
+  channel_cb_called++;
+
+  for (i = 0; i < nmsgs; i++) {
+    msg = (uintptr_t) msgs[i];
+    ASSERT_EQ(next_msg[msg % NUM_PRODUCERS], msg / NUM_PRODUCERS);
+    next_msg[msg % NUM_PRODUCERS]++;
+  }
+
+  msgs_received += nmsgs;
+  if (msgs_received == NUM_PRODUCERS * NUM_MESSAGES)
+    uv_close((uv_handle_t*) handle, close_cb);
+}
+
+
+TEST_IMPL(channel_producers) {
+  uv_loop_t* loop;
+  uintptr_t i;
+
+  loop = uv_default_loop();
+
+  /* A small capacity makes the producers run into UV_EAGAIN. */
+  ASSERT_OK(uv_channel_init(loop, &channel, 16, producers_cb));
+
+  for (i = 0; i < NUM_PRODUCERS; i++)
+    ASSERT_OK(uv_thread_create(&producers[i], producer, (void*) i));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  for (i = 0; i < NUM_PRODUCERS; i++) {
+    ASSERT_OK(uv_thread_join(&producers[i]));
+    ASSERT_EQ(NUM_MESSAGES, next_msg[i]);
+  }
+
+  ASSERT_EQ(NUM_PRODUCERS * NUM_MESSAGES, msgs_received);
+  ASSERT_LE(channel_cb_called, msgs_received);
+  ASSERT_EQ(1, close_cb_called);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
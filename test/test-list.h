@@ -98,6 +98,8 @@ TEST_DECLARE   (tcp6_ping_pong)
 TEST_DECLARE   (tcp6_ping_pong_vec)
 TEST_DECLARE   (pipe_ping_pong)
 TEST_DECLARE   (pipe_ping_pong_vec)
+TEST_DECLARE   (tcp_ping_pong_io_uring)
+TEST_DECLARE   (pipe_ping_pong_io_uring)
 TEST_DECLARE   (delayed_accept)
 TEST_DECLARE   (multiple_listen)
 #ifndef _WIN32
@@ -109,6 +111,7 @@ TEST_DECLARE   (tcp_try_write)
 TEST_DECLARE   (tcp_write_in_a_row)
 TEST_DECLARE   (tcp_try_write_error)
 TEST_DECLARE   (tcp_write_queue_order)
+TEST_DECLARE   (tcp_write_cork)
 TEST_DECLARE   (tcp_open)
 TEST_DECLARE   (tcp_open_twice)
 TEST_DECLARE   (tcp_open_bound)
@@ -146,6 +149,7 @@ TEST_DECLARE   (tcp_create_early_bad_domain)
 TEST_DECLARE   (tcp_create_early_accept)
 #ifndef _WIN32
 TEST_DECLARE   (tcp_close_accept)
+TEST_DECLARE   (tcp_close_accept_io_uring)
 TEST_DECLARE   (tcp_oob)
 #endif
 TEST_DECLARE   (tcp_flags)
@@ -153,6 +157,16 @@ TEST_DECLARE   (tcp_write_to_half_open_connection)
 TEST_DECLARE   (tcp_unexpected_read)
 TEST_DECLARE   (tcp_read_stop)
 TEST_DECLARE   (tcp_read_stop_start)
+TEST_DECLARE   (tcp_read_pooled)
+TEST_DECLARE   (tcp_read_pooled_config)
+TEST_DECLARE   (tcp_read_pooled_slab)
+TEST_DECLARE   (tcp_write_zerocopy)
+TEST_DECLARE   (tcp_read_edge_triggered)
+TEST_DECLARE   (tcp_read_budget)
+TEST_DECLARE   (tcp_read_bufs)
+TEST_DECLARE   (tcp_read_bufs_ipc)
+TEST_DECLARE   (tcp_reuseport)
+TEST_DECLARE   (tcp_reuseport_cpu)
 TEST_DECLARE   (tcp_rst)
 TEST_DECLARE   (tcp_bind6_error_addrinuse)
 TEST_DECLARE   (tcp_bind6_error_addrnotavail)
@@ -163,12 +177,15 @@ TEST_DECLARE   (tcp_write_ready)
 TEST_DECLARE   (udp_alloc_cb_fail)
 TEST_DECLARE   (udp_bind)
 TEST_DECLARE   (udp_bind_reuseaddr)
+TEST_DECLARE   (udp_bind_reuseport)
 TEST_DECLARE   (udp_connect)
 TEST_DECLARE   (udp_connect6)
 TEST_DECLARE   (udp_create_early)
 TEST_DECLARE   (udp_create_early_bad_bind)
 TEST_DECLARE   (udp_create_early_bad_domain)
 TEST_DECLARE   (udp_send_and_recv)
+TEST_DECLARE   (udp_send_batch)
+TEST_DECLARE   (udp_send_batch_order)
 TEST_DECLARE   (udp_send_hang_loop)
 TEST_DECLARE   (udp_send_immediate)
 TEST_DECLARE   (udp_send_unreachable)
@@ -179,6 +196,7 @@ TEST_DECLARE   (udp_multicast_ttl)
 TEST_DECLARE   (udp_multicast_interface)
 TEST_DECLARE   (udp_multicast_interface6)
 TEST_DECLARE   (udp_dgram_too_big)
+TEST_DECLARE   (udp_gso)
 TEST_DECLARE   (udp_dual_stack)
 TEST_DECLARE   (udp_ipv6_only)
 TEST_DECLARE   (udp_options)
@@ -188,7 +206,12 @@ TEST_DECLARE   (udp_open)
 TEST_DECLARE   (udp_open_twice)
 TEST_DECLARE   (udp_open_bound)
 TEST_DECLARE   (udp_open_connect)
+TEST_DECLARE   (udp_pacing)
 TEST_DECLARE   (udp_recv_in_a_row)
+TEST_DECLARE   (udp_recv_meta)
+TEST_DECLARE   (udp_recv_meta_mmsg)
+TEST_DECLARE   (udp_recv_pooled)
+TEST_DECLARE   (udp_recv_pooled_mmsg)
 #ifndef _WIN32
 TEST_DECLARE   (udp_send_unix)
 #endif
@@ -237,6 +260,9 @@ TEST_DECLARE   (timer_early_check)
 TEST_DECLARE   (timer_no_double_call_once)
 TEST_DECLARE   (timer_no_double_call_nowait)
 TEST_DECLARE   (timer_no_run_on_unref)
+TEST_DECLARE   (timer_wheel)
+TEST_DECLARE   (timer_dheap)
+TEST_DECLARE   (timer_slack)
 TEST_DECLARE   (idle_starvation)
 TEST_DECLARE   (idle_check)
 TEST_DECLARE   (loop_handles)
@@ -277,6 +303,10 @@ TEST_DECLARE   (active)
 TEST_DECLARE   (embed)
 TEST_DECLARE   (async)
 TEST_DECLARE   (async_null_cb)
+TEST_DECLARE   (async_many_pending)
+TEST_DECLARE   (async_send_close_pending)
+TEST_DECLARE   (channel_basic)
+TEST_DECLARE   (channel_producers)
 TEST_DECLARE   (eintr_handling)
 TEST_DECLARE   (get_currentexe)
 TEST_DECLARE   (process_title)
@@ -450,6 +480,13 @@ TEST_DECLARE   (strscpy)
 TEST_DECLARE   (strtok)
 TEST_DECLARE   (threadpool_queue_work_simple)
 TEST_DECLARE   (threadpool_queue_work_einval)
+TEST_DECLARE   (threadpool_work_stealing)
+TEST_DECLARE   (threadpool_named_pool)
+TEST_DECLARE   (threadpool_resize)
+TEST_DECLARE   (threadpool_resize_stealing)
+TEST_DECLARE   (threadpool_loop_configure)
+TEST_DECLARE   (threadpool_priority)
+TEST_DECLARE   (threadpool_stats)
 TEST_DECLARE   (threadpool_multiple_event_loops)
 TEST_DECLARE   (threadpool_cancel_getaddrinfo)
 TEST_DECLARE   (threadpool_cancel_getnameinfo)
@@ -676,6 +713,12 @@ TASK_LIST_START
   TEST_ENTRY  (pipe_ping_pong_vec)
   TEST_HELPER (pipe_ping_pong_vec, pipe_echo_server)
 
+  TEST_ENTRY  (tcp_ping_pong_io_uring)
+  TEST_HELPER (tcp_ping_pong_io_uring, tcp4_echo_server)
+
+  TEST_ENTRY  (pipe_ping_pong_io_uring)
+  TEST_HELPER (pipe_ping_pong_io_uring, pipe_echo_server)
+
   TEST_ENTRY  (delayed_accept)
   TEST_ENTRY  (multiple_listen)
 
@@ -698,6 +741,7 @@ TASK_LIST_START
   TEST_ENTRY  (tcp_try_write_error)
 
   TEST_ENTRY  (tcp_write_queue_order)
+  TEST_ENTRY  (tcp_write_cork)
 
   TEST_ENTRY  (tcp_open)
   TEST_HELPER (tcp_open, tcp4_echo_server)
@@ -748,6 +792,7 @@ TASK_LIST_START
   TEST_ENTRY  (tcp_create_early_accept)
 #ifndef _WIN32
   TEST_ENTRY  (tcp_close_accept)
+  TEST_ENTRY  (tcp_close_accept_io_uring)
   TEST_ENTRY  (tcp_oob)
 #endif
   TEST_ENTRY  (tcp_flags)
@@ -758,6 +803,17 @@ TASK_LIST_START
   TEST_HELPER (tcp_read_stop, tcp4_echo_server)
 
   TEST_ENTRY  (tcp_read_stop_start)
+  TEST_ENTRY  (tcp_read_pooled)
+  TEST_ENTRY  (tcp_read_pooled_config)
+  TEST_ENTRY  (tcp_read_pooled_slab)
+  TEST_ENTRY  (tcp_write_zerocopy)
+  TEST_ENTRY  (tcp_read_edge_triggered)
+  TEST_ENTRY  (tcp_read_budget)
+  TEST_ENTRY  (tcp_read_bufs)
+  TEST_ENTRY  (tcp_read_bufs_ipc)
+
+  TEST_ENTRY  (tcp_reuseport)
+  TEST_ENTRY  (tcp_reuseport_cpu)
 
   TEST_ENTRY  (tcp_rst)
   TEST_HELPER (tcp_rst, tcp4_echo_server)
@@ -771,16 +827,20 @@ TASK_LIST_START
   TEST_ENTRY  (udp_alloc_cb_fail)
   TEST_ENTRY  (udp_bind)
   TEST_ENTRY  (udp_bind_reuseaddr)
+  TEST_ENTRY  (udp_bind_reuseport)
   TEST_ENTRY  (udp_connect)
   TEST_ENTRY  (udp_connect6)
   TEST_ENTRY  (udp_create_early)
   TEST_ENTRY  (udp_create_early_bad_bind)
   TEST_ENTRY  (udp_create_early_bad_domain)
   TEST_ENTRY  (udp_send_and_recv)
+  TEST_ENTRY  (udp_send_batch)
+  TEST_ENTRY  (udp_send_batch_order)
   TEST_ENTRY  (udp_send_hang_loop)
   TEST_ENTRY  (udp_send_immediate)
   TEST_ENTRY  (udp_send_unreachable)
   TEST_ENTRY  (udp_dgram_too_big)
+  TEST_ENTRY  (udp_gso)
   TEST_ENTRY  (udp_dual_stack)
   TEST_ENTRY  (udp_ipv6_only)
   TEST_ENTRY  (udp_options)
@@ -795,11 +855,16 @@ TASK_LIST_START
   TEST_ENTRY  (udp_sendmmsg_error)
   TEST_ENTRY  (udp_try_send)
   TEST_ENTRY  (udp_recv_in_a_row)
+  TEST_ENTRY  (udp_recv_meta)
+  TEST_ENTRY  (udp_recv_meta_mmsg)
+  TEST_ENTRY  (udp_recv_pooled)
+  TEST_ENTRY  (udp_recv_pooled_mmsg)
 
   TEST_ENTRY  (udp_open)
   TEST_ENTRY  (udp_open_twice)
   TEST_ENTRY  (udp_open_bound)
   TEST_ENTRY  (udp_open_connect)
+  TEST_ENTRY  (udp_pacing)
 #ifndef _WIN32
   TEST_ENTRY  (udp_send_unix)
 #endif
@@ -858,6 +923,9 @@ TASK_LIST_START
   TEST_ENTRY  (timer_no_double_call_once)
   TEST_ENTRY  (timer_no_double_call_nowait)
   TEST_ENTRY  (timer_no_run_on_unref)
+  TEST_ENTRY  (timer_wheel)
+  TEST_ENTRY  (timer_dheap)
+  TEST_ENTRY  (timer_slack)
 
   TEST_ENTRY  (idle_starvation)
   TEST_ENTRY  (idle_check)
@@ -904,6 +972,10 @@ TASK_LIST_START
 
   TEST_ENTRY  (async)
   TEST_ENTRY  (async_null_cb)
+  TEST_ENTRY  (async_many_pending)
+  TEST_ENTRY  (async_send_close_pending)
+  TEST_ENTRY  (channel_basic)
+  TEST_ENTRY  (channel_producers)
   TEST_ENTRY  (eintr_handling)
 
   TEST_ENTRY  (get_currentexe)
@@ -1147,6 +1219,13 @@ TASK_LIST_START
   TEST_ENTRY  (strtok)
   TEST_ENTRY  (threadpool_queue_work_simple)
   TEST_ENTRY  (threadpool_queue_work_einval)
+  TEST_ENTRY  (threadpool_work_stealing)
+  TEST_ENTRY  (threadpool_named_pool)
+  TEST_ENTRY  (threadpool_resize)
+  TEST_ENTRY  (threadpool_resize_stealing)
+  TEST_ENTRY  (threadpool_loop_configure)
+  TEST_ENTRY  (threadpool_priority)
+  TEST_ENTRY  (threadpool_stats)
   TEST_ENTRY_CUSTOM (threadpool_multiple_event_loops, 0, 0, 60000)
   TEST_ENTRY  (threadpool_cancel_getaddrinfo)
   TEST_ENTRY  (threadpool_cancel_getnameinfo)
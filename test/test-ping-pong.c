@@ -437,3 +437,39 @@ TEST_IMPL(pipe_ping_pong_vec) {
   pipe2_pinger_new(1);
   return run_ping_pong_test();
 }
+
+
+TEST_IMPL(tcp_ping_pong_io_uring) {
+  int r;
+
+  r = uv_loop_configure(uv_default_loop(), UV_LOOP_IO_URING_STREAMS);
+  if (r == UV_ENOSYS)
+    RETURN_SKIP("io_uring not supported");
+  ASSERT_OK(r);
+
+  tcp_pinger_new(1);
+  run_ping_pong_test();
+
+  ASSERT_OK(uv_loop_configure(uv_default_loop(), UV_LOOP_IO_URING_STREAMS));
+  completed_pingers = 0;
+  socketpair_pinger_new(1);
+  return run_ping_pong_test();
+}
+
+
+TEST_IMPL(pipe_ping_pong_io_uring) {
+  int r;
+
+  r = uv_loop_configure(uv_default_loop(), UV_LOOP_IO_URING_STREAMS);
+  if (r == UV_ENOSYS)
+    RETURN_SKIP("io_uring not supported");
+  ASSERT_OK(r);
+
+  pipe_pinger_new(0);
+  run_ping_pong_test();
+
+  ASSERT_OK(uv_loop_configure(uv_default_loop(), UV_LOOP_IO_URING_STREAMS));
+  completed_pingers = 0;
+  pipe2_pinger_new(0);
+  return run_ping_pong_test();
+}
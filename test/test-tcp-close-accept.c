@@ -139,10 +139,11 @@ static void connection_cb(uv_stream_t* server, int status) {
   }
 }
 
-TEST_IMPL(tcp_close_accept) {
+static int close_accept(int io_uring) {
   unsigned int i;
   uv_loop_t* loop;
   uv_tcp_t* client;
+  int r;
 
   /*
    * A little explanation of what goes on below:
@@ -164,6 +165,13 @@ TEST_IMPL(tcp_close_accept) {
   loop = uv_default_loop();
   ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
 
+  if (io_uring) {
+    r = uv_loop_configure(loop, UV_LOOP_IO_URING_STREAMS);
+    if (r == UV_ENOSYS)
+      RETURN_SKIP("io_uring not supported");
+    ASSERT_OK(r);
+  }
+
   ASSERT_OK(uv_tcp_init(loop, &tcp_server));
   ASSERT_OK(uv_tcp_bind(&tcp_server, (const struct sockaddr*) &addr, 0));
   ASSERT_OK(uv_listen((uv_stream_t*) &tcp_server,
@@ -191,6 +199,14 @@ TEST_IMPL(tcp_close_accept) {
   return 0;
 }
 
+TEST_IMPL(tcp_close_accept) {
+  return close_accept(0);
+}
+
+TEST_IMPL(tcp_close_accept_io_uring) {
+  return close_accept(1);
+}
+
 #else
 
 typedef int file_has_no_tests; /* ISO C forbids an empty translation unit. */
@@ -0,0 +1,176 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "uv.h"
+#include "task.h"
+
+#include <string.h>
+
+#define NUM_CLIENTS 2
+#define BUF_SIZE 1024
+#define BUDGET (4 * BUF_SIZE)
+#define DATA_SIZE (1024 * 1024)
+
+typedef struct {
+  uv_tcp_t client;
+  uv_tcp_t connection;
+  uv_connect_t connect_req;
+  uv_write_t write_req;
+  uv_shutdown_t shutdown_req;
+  size_t received;
+  size_t received_this_tick;
+} conn_t;
+
+static uv_tcp_t server;
+static uv_check_t check_handle;
+static conn_t conns[NUM_CLIENTS];
+static unsigned int naccepted;
+static char data[DATA_SIZE];
+static char slab[BUF_SIZE];
+static size_t max_per_tick;
+static int eof_cb_called;
+
+
+static void alloc_cb(uv_handle_t* handle, size_t size, uv_buf_t* buf) {
+  buf->base = slab;
+  buf->len = sizeof(slab);
+}
+
+
+static void check_cb(uv_check_t* handle) {
+  unsigned int i;
+
+  /* A loop iteration is over. */
+  for (i = 0; i < NUM_CLIENTS; i++)
+    conns[i].received_this_tick = 0;
+}
+
+
+static void read_cb(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+  conn_t* conn;
+
+  conn = stream->data;
+
+  if (nread == UV_EOF) {
+    ASSERT_EQ(conn->received, DATA_SIZE);
+    uv_close((uv_handle_t*) stream, NULL);
+    if (++eof_cb_called == NUM_CLIENTS) {
+      uv_close((uv_handle_t*) &server, NULL);
+      uv_close((uv_handle_t*) &check_handle, NULL);
+    }
+    return;
+  }
+
+  ASSERT_GT(nread, 0);
+  ASSERT_LE(conn->received + nread, DATA_SIZE);
+  ASSERT_OK(memcmp(buf->base, data + conn->received, nread));
+  conn->received += nread;
+  conn->received_this_tick += nread;
+
+  if (conn->received_this_tick > max_per_tick)
+    max_per_tick = conn->received_this_tick;
+}
+
+
+static void connection_cb(uv_stream_t* handle, int status) {
+  conn_t* conn;
+
+  ASSERT_OK(status);
+  ASSERT_LT(naccepted, NUM_CLIENTS);
+
+  conn = &conns[naccepted++];
+  ASSERT_OK(uv_tcp_init(handle->loop, &conn->connection));
+  ASSERT_OK(uv_accept(handle, (uv_stream_t*) &conn->connection));
+  conn->connection.data = conn;
+  ASSERT_OK(uv_read_start((uv_stream_t*) &conn->connection, alloc_cb, read_cb));
+}
+
+
+static void shutdown_cb(uv_shutdown_t* req, int status) {
+  ASSERT_OK(status);
+  uv_close((uv_handle_t*) req->handle, NULL);
+}
+
+
+static void write_cb(uv_write_t* req, int status) {
+  ASSERT_OK(status);
+}
+
+
+static void connect_cb(uv_connect_t* req, int status) {
+  uv_buf_t buf;
+  conn_t* conn;
+
+  ASSERT_OK(status);
+  conn = req->data;
+
+  buf = uv_buf_init(data, sizeof(data));
+  ASSERT_OK(uv_write(&conn->write_req, req->handle, &buf, 1, write_cb));
+  ASSERT_OK(uv_shutdown(&conn->shutdown_req, req->handle, shutdown_cb));
+}
+
+
+TEST_IMPL(tcp_read_budget) {
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+  unsigned int i;
+  int r;
+
+  loop = uv_default_loop();
+
+  r = uv_loop_configure(loop, UV_LOOP_READ_BUDGET, BUDGET, 0);
+  if (r == UV_ENOSYS)
+    RETURN_SKIP("read budget not supported");
+  ASSERT_OK(r);
+
+  for (i = 0; i < sizeof(data); i++)
+    data[i] = i % 251;
+
+  ASSERT_OK(uv_check_init(loop, &check_handle));
+  ASSERT_OK(uv_check_start(&check_handle, check_cb));
+
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+  ASSERT_OK(uv_tcp_init(loop, &server));
+  ASSERT_OK(uv_tcp_bind(&server, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_listen((uv_stream_t*) &server, NUM_CLIENTS, connection_cb));
+
+  for (i = 0; i < NUM_CLIENTS; i++) {
+    conns[i].connect_req.data = &conns[i];
+    ASSERT_OK(uv_tcp_init(loop, &conns[i].client));
+    ASSERT_OK(uv_tcp_connect(&conns[i].connect_req,
+                             &conns[i].client,
+                             (const struct sockaddr*) &addr,
+                             connect_cb));
+  }
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(eof_cb_called, NUM_CLIENTS);
+  ASSERT_EQ(naccepted, NUM_CLIENTS);
+
+  /* Never more than the budget in one loop iteration. */
+  ASSERT_GT(max_per_tick, 0);
+  ASSERT_LE(max_per_tick, BUDGET);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
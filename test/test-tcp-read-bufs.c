@@ -0,0 +1,224 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "uv.h"
+#include "task.h"
+
+#include <string.h>
+
+#ifndef _WIN32
+# include <unistd.h>
+#endif
+
+#define DATA_SIZE (64 * 1024)
+
+/* A small header and a body, like a protocol that reads both in one go. */
+static const size_t buf_sizes[] = { 5, 123, 1000 };
+
+static uv_tcp_t server;
+static uv_tcp_t connection;
+static uv_tcp_t client;
+static uv_pipe_t ipc;
+static uv_connect_t connect_req;
+static uv_write_t write_req;
+static uv_shutdown_t shutdown_req;
+static char data[DATA_SIZE];
+static char storage[5 + 123 + 1000];
+static size_t nexpected;
+static size_t nreceived;
+static int spread_cb_called;
+static int eof_cb_called;
+
+
+static void alloc_bufs_cb(uv_handle_t* handle,
+                          size_t suggested_size,
+                          uv_buf_t bufs[],
+                          unsigned int* nbufs) {
+  char* base;
+  unsigned int i;
+
+  ASSERT_GE(*nbufs, ARRAY_SIZE(buf_sizes));
+
+  base = storage;
+  for (i = 0; i < ARRAY_SIZE(buf_sizes); i++) {
+    bufs[i] = uv_buf_init(base, buf_sizes[i]);
+    base += buf_sizes[i];
+  }
+
+  *nbufs = ARRAY_SIZE(buf_sizes);
+}
+
+
+static void read_bufs_cb(uv_stream_t* stream,
+                         ssize_t nread,
+                         const uv_buf_t bufs[],
+                         unsigned int nbufs) {
+  unsigned int i;
+  size_t n;
+
+  if (nread == UV_EOF) {
+    ASSERT_EQ(nreceived, nexpected);
+    uv_close((uv_handle_t*) stream, NULL);
+    if (stream != (uv_stream_t*) &ipc)
+      uv_close((uv_handle_t*) &server, NULL);
+    eof_cb_called++;
+    return;
+  }
+
+  ASSERT_GE(nread, 0);
+  ASSERT_LE(nreceived + nread, nexpected);
+  ASSERT_EQ(nbufs, ARRAY_SIZE(buf_sizes));
+
+  /* The data fills the buffers in order. */
+  for (i = 0; i < nbufs && nread > 0; i++) {
+    n = bufs[i].len;
+    if (n > (size_t) nread)
+      n = nread;
+
+    ASSERT_OK(memcmp(bufs[i].base, data + nreceived, n));
+    nreceived += n;
+    nread -= n;
+
+    if (i > 0)
+      spread_cb_called++;
+  }
+}
+
+
+static void connection_cb(uv_stream_t* handle, int status) {
+  ASSERT_OK(status);
+  ASSERT_OK(uv_tcp_init(handle->loop, &connection));
+  ASSERT_OK(uv_accept(handle, (uv_stream_t*) &connection));
+  ASSERT_OK(uv_read_start_bufs((uv_stream_t*) &connection,
+                               alloc_bufs_cb,
+                               read_bufs_cb));
+}
+
+
+static void shutdown_cb(uv_shutdown_t* req, int status) {
+  ASSERT_OK(status);
+  uv_close((uv_handle_t*) req->handle, NULL);
+}
+
+
+static void write_cb(uv_write_t* req, int status) {
+  ASSERT_OK(status);
+}
+
+
+static void connect_cb(uv_connect_t* req, int status) {
+  uv_buf_t buf;
+
+  ASSERT_OK(status);
+
+  buf = uv_buf_init(data, sizeof(data));
+  ASSERT_OK(uv_write(&write_req, req->handle, &buf, 1, write_cb));
+  ASSERT_OK(uv_shutdown(&shutdown_req, req->handle, shutdown_cb));
+}
+
+
+static void init_data(void) {
+  size_t i;
+
+  for (i = 0; i < sizeof(data); i++)
+    data[i] = i % 251;
+}
+
+
+TEST_IMPL(tcp_read_bufs) {
+#ifdef _WIN32
+  RETURN_SKIP("vectored reads not supported");
+#else
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+  int r;
+
+  loop = uv_default_loop();
+  init_data();
+  nexpected = DATA_SIZE;
+
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+  ASSERT_OK(uv_tcp_init(loop, &server));
+  ASSERT_OK(uv_tcp_bind(&server, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_listen((uv_stream_t*) &server, 1, connection_cb));
+
+  ASSERT_OK(uv_tcp_init(loop, &client));
+  r = uv_read_start_bufs((uv_stream_t*) &client, alloc_bufs_cb, read_bufs_cb);
+  ASSERT_EQ(r, UV_ENOTCONN);
+
+  ASSERT_OK(uv_tcp_connect(&connect_req,
+                           &client,
+                           (const struct sockaddr*) &addr,
+                           connect_cb));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(1, eof_cb_called);
+  ASSERT_EQ(nreceived, DATA_SIZE);
+  ASSERT_GT(spread_cb_called, 0);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+#endif
+}
+
+
+TEST_IMPL(tcp_read_bufs_ipc) {
+#ifdef _WIN32
+  RETURN_SKIP("vectored reads not supported");
+#else
+  uv_os_sock_t fds[2];
+  uv_loop_t* loop;
+  size_t off;
+  ssize_t n;
+
+  loop = uv_default_loop();
+  init_data();
+  nexpected = 16 * 1024;
+
+  ASSERT_OK(uv_socketpair(SOCK_STREAM, 0, fds, UV_NONBLOCK_PIPE, 0));
+  ASSERT_OK(uv_pipe_init(loop, &ipc, 1));
+  ASSERT_OK(uv_pipe_open(&ipc, fds[0]));
+  ASSERT_OK(uv_read_start_bufs((uv_stream_t*) &ipc,
+                               alloc_bufs_cb,
+                               read_bufs_cb));
+  ASSERT_EQ(UV_EALREADY, uv_read_start_bufs((uv_stream_t*) &ipc,
+                                            alloc_bufs_cb,
+                                            read_bufs_cb));
+
+  /* Less than the socket buffer, the peer doesn't block. */
+  for (off = 0; off < nexpected; off += n) {
+    n = write(fds[1], data + off, nexpected - off);
+    ASSERT_GT(n, 0);
+  }
+  ASSERT_OK(close(fds[1]));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(1, eof_cb_called);
+  ASSERT_EQ(nreceived, nexpected);
+  ASSERT_GT(spread_cb_called, 0);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+#endif
+}
@@ -0,0 +1,199 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "uv.h"
+#include "task.h"
+
+#include <string.h>
+
+#define DATA_SIZE (1024 * 1024)
+
+static uv_tcp_t server;
+static uv_tcp_t connection;
+static uv_tcp_t client;
+static uv_timer_t restart_timer;
+static uv_connect_t connect_req;
+static uv_write_t write_req;
+static uv_write_t reply_req;
+static uv_shutdown_t shutdown_req;
+static uv_shutdown_t reply_shutdown_req;
+static char data[DATA_SIZE];
+static char slab[1024];
+static size_t server_received;
+static size_t client_received;
+static int stopped;
+static int restart_cb_called;
+static int write_cb_called;
+static int shutdown_cb_called;
+static int eof_cb_called;
+
+
+static void alloc_cb(uv_handle_t* handle, size_t size, uv_buf_t* buf) {
+  /* Small buffers, to run out of reads before the socket runs dry. */
+  buf->base = slab;
+  buf->len = sizeof(slab);
+}
+
+
+static void restart_cb(uv_timer_t* handle);
+
+
+static void write_cb(uv_write_t* req, int status) {
+  ASSERT_OK(status);
+  write_cb_called++;
+}
+
+
+static void shutdown_cb(uv_shutdown_t* req, int status) {
+  ASSERT_OK(status);
+  shutdown_cb_called++;
+
+  if (req == &reply_shutdown_req)
+    uv_close((uv_handle_t*) req->handle, NULL);
+}
+
+
+static void check_eof(ssize_t nread, size_t received) {
+  ASSERT_EQ(nread, UV_EOF);
+  ASSERT_EQ(received, DATA_SIZE);
+  eof_cb_called++;
+}
+
+
+static void client_read_cb(uv_stream_t* stream,
+                           ssize_t nread,
+                           const uv_buf_t* buf) {
+  if (nread < 0) {
+    check_eof(nread, client_received);
+    uv_close((uv_handle_t*) stream, NULL);
+    return;
+  }
+
+  ASSERT_LE(client_received + nread, DATA_SIZE);
+  ASSERT_OK(memcmp(buf->base, data + client_received, nread));
+  client_received += nread;
+}
+
+
+static void server_read_cb(uv_stream_t* stream,
+                           ssize_t nread,
+                           const uv_buf_t* buf) {
+  uv_buf_t reply;
+
+  if (nread < 0) {
+    check_eof(nread, server_received);
+    reply = uv_buf_init(data, sizeof(data));
+    ASSERT_OK(uv_write(&reply_req, stream, &reply, 1, write_cb));
+    ASSERT_OK(uv_shutdown(&reply_shutdown_req, stream, shutdown_cb));
+    uv_close((uv_handle_t*) &server, NULL);
+    uv_close((uv_handle_t*) &restart_timer, NULL);
+    return;
+  }
+
+  ASSERT_LE(server_received + nread, DATA_SIZE);
+  ASSERT_OK(memcmp(buf->base, data + server_received, nread));
+  server_received += nread;
+
+  /* Stop and start again from a timer. What's left in the socket has been
+   * reported already and must not get lost.
+   */
+  if (stopped == 0 && nread > 0) {
+    stopped = 1;
+    ASSERT_OK(uv_read_stop(stream));
+    ASSERT_OK(uv_timer_start(&restart_timer, restart_cb, 0, 0));
+  }
+}
+
+
+static void restart_cb(uv_timer_t* handle) {
+  ASSERT_EQ(1, stopped);
+  stopped = 0;
+  restart_cb_called++;
+  ASSERT_OK(uv_read_start((uv_stream_t*) &connection,
+                          alloc_cb,
+                          server_read_cb));
+}
+
+
+static void connection_cb(uv_stream_t* handle, int status) {
+  ASSERT_OK(status);
+  ASSERT_OK(uv_tcp_init(handle->loop, &connection));
+  ASSERT_OK(uv_accept(handle, (uv_stream_t*) &connection));
+  ASSERT_OK(uv_read_start((uv_stream_t*) &connection,
+                          alloc_cb,
+                          server_read_cb));
+}
+
+
+static void connect_cb(uv_connect_t* req, int status) {
+  uv_buf_t buf;
+
+  ASSERT_OK(status);
+
+  buf = uv_buf_init(data, sizeof(data));
+  ASSERT_OK(uv_write(&write_req, req->handle, &buf, 1, write_cb));
+  ASSERT_OK(uv_shutdown(&shutdown_req, req->handle, shutdown_cb));
+  ASSERT_OK(uv_read_start(req->handle, alloc_cb, client_read_cb));
+}
+
+
+TEST_IMPL(tcp_read_edge_triggered) {
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+  size_t i;
+  int r;
+
+  loop = uv_default_loop();
+
+  r = uv_loop_configure(loop, UV_LOOP_EDGE_TRIGGERED);
+  if (r == UV_ENOSYS)
+    RETURN_SKIP("edge-triggered I/O not supported");
+  ASSERT_OK(r);
+
+  for (i = 0; i < sizeof(data); i++)
+    data[i] = i % 251;
+
+  ASSERT_OK(uv_timer_init(loop, &restart_timer));
+
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+  ASSERT_OK(uv_tcp_init(loop, &server));
+  ASSERT_OK(uv_tcp_bind(&server, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_listen((uv_stream_t*) &server, 1, connection_cb));
+
+  ASSERT_OK(uv_tcp_init(loop, &client));
+  ASSERT_OK(uv_tcp_connect(&connect_req,
+                           &client,
+                           (const struct sockaddr*) &addr,
+                           connect_cb));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(2, eof_cb_called);
+  ASSERT_EQ(2, write_cb_called);
+  ASSERT_EQ(2, shutdown_cb_called);
+  ASSERT_GT(restart_cb_called, 0);
+  ASSERT_EQ(server_received, DATA_SIZE);
+  ASSERT_EQ(client_received, DATA_SIZE);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
@@ -0,0 +1,226 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <string.h>
+
+#define NUM_BUFS 4
+#define BUF_SIZE 1024
+#define DATA_SIZE (256 * 1024)
+
+static uv_tcp_t server;
+static uv_tcp_t connection;
+static uv_tcp_t client;
+static uv_timer_t release_timer;
+static uv_connect_t connect_req;
+static uv_write_t write_req;
+static uv_shutdown_t shutdown_req;
+static char data[DATA_SIZE];
+static uv_buf_t held[NUM_BUFS];
+static unsigned int nheld;
+static size_t nreceived;
+static int restarted;
+static int read_cb_called;
+static int release_cb_called;
+static int eof_cb_called;
+
+
+static void release_held(void) {
+  while (nheld > 0)
+    uv_buf_release(connection.loop, &held[--nheld]);
+}
+
+
+static void release_cb(uv_timer_t* handle) {
+  release_held();
+  release_cb_called++;
+}
+
+
+static void read_cb(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+  if (nread == UV_EOF) {
+    ASSERT_NULL(buf->base);
+    ASSERT_EQ(nreceived, DATA_SIZE);
+    release_held();
+    uv_close((uv_handle_t*) stream, NULL);
+    uv_close((uv_handle_t*) &server, NULL);
+    uv_close((uv_handle_t*) &release_timer, NULL);
+    eof_cb_called++;
+    return;
+  }
+
+  ASSERT_GT(nread, 0);
+  ASSERT_LE(nreceived + nread, DATA_SIZE);
+  ASSERT_OK(memcmp(buf->base, data + nreceived, nread));
+  nreceived += nread;
+  read_cb_called++;
+
+  /* Stop and start again, the data that arrives in between is kept. */
+  if (!restarted && nreceived >= DATA_SIZE / 2) {
+    restarted = 1;
+    uv_buf_release(stream->loop, buf);
+    ASSERT_OK(uv_read_stop(stream));
+    ASSERT_OK(uv_read_start_pooled(stream, read_cb));
+    return;
+  }
+
+  /* Hang on to the buffers until the pool runs out of them. */
+  if (nheld == NUM_BUFS) {
+    uv_buf_release(stream->loop, buf);
+    return;
+  }
+
+  held[nheld++] = *buf;
+  if (nheld == NUM_BUFS)
+    ASSERT_OK(uv_timer_start(&release_timer, release_cb, 1, 0));
+}
+
+
+static void connection_cb(uv_stream_t* handle, int status) {
+  ASSERT_OK(status);
+  ASSERT_OK(uv_tcp_init(handle->loop, &connection));
+  ASSERT_OK(uv_accept(handle, (uv_stream_t*) &connection));
+  ASSERT_OK(uv_read_start_pooled((uv_stream_t*) &connection, read_cb));
+}
+
+
+static void shutdown_cb(uv_shutdown_t* req, int status) {
+  ASSERT_OK(status);
+  uv_close((uv_handle_t*) req->handle, NULL);
+}
+
+
+static void write_cb(uv_write_t* req, int status) {
+  ASSERT_OK(status);
+}
+
+
+static void connect_cb(uv_connect_t* req, int status) {
+  uv_buf_t buf;
+
+  ASSERT_OK(status);
+
+  buf = uv_buf_init(data, sizeof(data));
+  ASSERT_OK(uv_write(&write_req, req->handle, &buf, 1, write_cb));
+  ASSERT_OK(uv_shutdown(&shutdown_req, req->handle, shutdown_cb));
+}
+
+
+static void run_pooled(uv_loop_t* loop) {
+  struct sockaddr_in addr;
+  size_t i;
+
+  for (i = 0; i < sizeof(data); i++)
+    data[i] = i % 251;
+
+  ASSERT_OK(uv_timer_init(loop, &release_timer));
+
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+  ASSERT_OK(uv_tcp_init(loop, &server));
+  ASSERT_OK(uv_tcp_bind(&server, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_listen((uv_stream_t*) &server, 1, connection_cb));
+
+  ASSERT_OK(uv_tcp_init(loop, &client));
+  ASSERT_OK(uv_tcp_connect(&connect_req,
+                           &client,
+                           (const struct sockaddr*) &addr,
+                           connect_cb));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(1, eof_cb_called);
+  ASSERT_EQ(1, restarted);
+  ASSERT_GE(read_cb_called, DATA_SIZE / BUF_SIZE);
+  ASSERT_EQ(nreceived, DATA_SIZE);
+}
+
+
+TEST_IMPL(tcp_read_pooled) {
+  uv_loop_t* loop;
+  int r;
+
+  loop = uv_default_loop();
+
+  r = uv_loop_configure(loop, UV_LOOP_IO_URING_BUFFERS, NUM_BUFS, BUF_SIZE);
+  if (r == UV_ENOSYS)
+    RETURN_SKIP("io_uring provided buffers not supported");
+  ASSERT_OK(r);
+
+  ASSERT_EQ(UV_EBUSY, uv_loop_configure(loop,
+                                        UV_LOOP_IO_URING_BUFFERS,
+                                        NUM_BUFS,
+                                        BUF_SIZE));
+
+  run_pooled(loop);
+
+  /* The stream waited for the buffers. */
+  ASSERT_GT(release_cb_called, 0);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
+
+
+TEST_IMPL(tcp_read_pooled_slab) {
+  uv_metrics_t metrics;
+  uv_loop_t* loop;
+  int r;
+
+  loop = uv_default_loop();
+
+  r = uv_loop_configure(loop, UV_LOOP_BUFFER_POOL, NUM_BUFS, BUF_SIZE);
+  if (r == UV_ENOSYS)
+    RETURN_SKIP("loop buffer pool not supported");
+  ASSERT_OK(r);
+
+  ASSERT_EQ(UV_EBUSY, uv_loop_configure(loop,
+                                        UV_LOOP_BUFFER_POOL,
+                                        NUM_BUFS,
+                                        BUF_SIZE));
+
+  run_pooled(loop);
+
+  ASSERT_OK(uv_metrics_info(loop, &metrics));
+  ASSERT_GE(metrics.buf_pool_hits, NUM_BUFS);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
+
+
+TEST_IMPL(tcp_read_pooled_config) {
+  int r;
+
+  /* Not a power of two. */
+  r = uv_loop_configure(uv_default_loop(), UV_LOOP_IO_URING_BUFFERS, 3, 1024);
+  if (r == UV_ENOSYS)
+    RETURN_SKIP("io_uring provided buffers not supported");
+  ASSERT_EQ(r, UV_EINVAL);
+
+  /* Too small to link the free buffers. */
+  r = uv_loop_configure(uv_default_loop(), UV_LOOP_BUFFER_POOL, 4, 1);
+  ASSERT_EQ(r, UV_EINVAL);
+
+  MAKE_VALGRIND_HAPPY(uv_default_loop());
+  return 0;
+}
@@ -0,0 +1,165 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "uv.h"
+#include "task.h"
+
+#include <string.h>
+
+#define NUM_LOOPS 2
+#define NUM_CLIENTS 16
+
+static uv_loop_t loop2;
+static uv_loop_t* loops[NUM_LOOPS];
+static uv_tcp_t servers[NUM_LOOPS];
+static uv_tcp_t conns[NUM_CLIENTS];
+static uv_tcp_t clients[NUM_CLIENTS];
+static uv_connect_t connect_reqs[NUM_CLIENTS];
+static int accepted[NUM_LOOPS];
+static int connection_cb_called;
+static int connect_cb_called;
+
+
+static void connection_cb(uv_stream_t* server, int status) {
+  uv_tcp_t* conn;
+
+  ASSERT_OK(status);
+  ASSERT_LT(connection_cb_called, NUM_CLIENTS);
+
+  conn = &conns[connection_cb_called++];
+  ASSERT_OK(uv_tcp_init(server->loop, conn));
+  ASSERT_OK(uv_accept(server, (uv_stream_t*) conn));
+  uv_close((uv_handle_t*) conn, NULL);
+
+  accepted[(uv_tcp_t*) server - servers]++;
+}
+
+
+static void connect_cb(uv_connect_t* req, int status) {
+  ASSERT_OK(status);
+  uv_close((uv_handle_t*) req->handle, NULL);
+  connect_cb_called++;
+}
+
+
+static void run_reuseport(unsigned int flags) {
+  struct sockaddr_in addr;
+  struct sockaddr_in name;
+  uv_loop_t* loop;
+  int namelen;
+  int total;
+  int i;
+  int r;
+
+  loop = uv_default_loop();
+  loops[0] = loop;
+  loops[1] = &loop2;
+  ASSERT_OK(uv_loop_init(&loop2));
+
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", 0, &addr));
+
+  ASSERT_EQ(UV_EINVAL, uv_tcp_listen_reuseport(loops,
+                                               servers,
+                                               0,
+                                               (const struct sockaddr*) &addr,
+                                               flags,
+                                               NUM_CLIENTS,
+                                               connection_cb));
+
+  r = uv_tcp_listen_reuseport(loops,
+                              servers,
+                              NUM_LOOPS,
+                              (const struct sockaddr*) &addr,
+                              flags,
+                              NUM_CLIENTS,
+                              connection_cb);
+  if (r == UV_ENOTSUP) {
+    ASSERT_OK(uv_loop_close(&loop2));
+    return;
+  }
+  ASSERT_OK(r);
+
+  /* The kernel picked the port for the first one, the other shares it. */
+  namelen = sizeof(name);
+  ASSERT_OK(uv_tcp_getsockname(&servers[1],
+                               (struct sockaddr*) &name,
+                               &namelen));
+  addr.sin_port = name.sin_port;
+  namelen = sizeof(name);
+  ASSERT_OK(uv_tcp_getsockname(&servers[0],
+                               (struct sockaddr*) &name,
+                               &namelen));
+  ASSERT_EQ(addr.sin_port, name.sin_port);
+
+  for (i = 0; i < NUM_CLIENTS; i++) {
+    ASSERT_OK(uv_tcp_init(loop, &clients[i]));
+    ASSERT_OK(uv_tcp_connect(&connect_reqs[i],
+                             &clients[i],
+                             (const struct sockaddr*) &addr,
+                             connect_cb));
+  }
+
+  while (connection_cb_called < NUM_CLIENTS ||
+         connect_cb_called < NUM_CLIENTS) {
+    uv_run(loops[0], UV_RUN_NOWAIT);
+    uv_run(loops[1], UV_RUN_NOWAIT);
+  }
+
+  total = 0;
+  for (i = 0; i < NUM_LOOPS; i++) {
+    total += accepted[i];
+    uv_close((uv_handle_t*) &servers[i], NULL);
+  }
+  ASSERT_EQ(total, NUM_CLIENTS);
+
+  ASSERT_OK(uv_run(loops[1], UV_RUN_DEFAULT));
+  ASSERT_OK(uv_loop_close(&loop2));
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+}
+
+
+TEST_IMPL(tcp_reuseport) {
+#ifdef _WIN32
+  RETURN_SKIP("SO_REUSEPORT is not supported on Windows");
+#endif
+
+  run_reuseport(0);
+  if (connection_cb_called == 0)
+    RETURN_SKIP("SO_REUSEPORT load balancing is not supported");
+
+  MAKE_VALGRIND_HAPPY(uv_default_loop());
+  return 0;
+}
+
+
+TEST_IMPL(tcp_reuseport_cpu) {
+#ifdef _WIN32
+  RETURN_SKIP("SO_REUSEPORT is not supported on Windows");
+#endif
+
+  run_reuseport(UV_TCP_REUSEPORT_CPU);
+  if (connection_cb_called == 0)
+    RETURN_SKIP("SO_REUSEPORT load balancing is not supported");
+
+  MAKE_VALGRIND_HAPPY(uv_default_loop());
+  return 0;
+}
@@ -0,0 +1,155 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "uv.h"
+#include "task.h"
+
+#include <string.h>
+
+/* More than fits in one writev(). */
+#define NUM_WRITES 3000
+#define CHUNK_SIZE 4
+
+static uv_tcp_t server;
+static uv_tcp_t connection;
+static uv_tcp_t client;
+static uv_connect_t connect_req;
+static uv_write_t write_reqs[NUM_WRITES];
+static uv_shutdown_t shutdown_req;
+static char data[NUM_WRITES * CHUNK_SIZE];
+static char received[NUM_WRITES * CHUNK_SIZE + 1];  /* Room for EOF. */
+static size_t nreceived;
+static int write_cb_called;
+static int eof_cb_called;
+
+
+static void alloc_cb(uv_handle_t* handle, size_t size, uv_buf_t* buf) {
+  buf->base = received + nreceived;
+  buf->len = sizeof(received) - nreceived;
+}
+
+
+static void read_cb(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+  if (nread == UV_EOF) {
+    ASSERT_EQ(nreceived, sizeof(data));
+    ASSERT_OK(memcmp(received, data, sizeof(data)));
+    uv_close((uv_handle_t*) stream, NULL);
+    uv_close((uv_handle_t*) &server, NULL);
+    eof_cb_called++;
+    return;
+  }
+
+  ASSERT_GE(nread, 0);
+  nreceived += nread;
+}
+
+
+static void connection_cb(uv_stream_t* handle, int status) {
+  ASSERT_OK(status);
+  ASSERT_OK(uv_tcp_init(handle->loop, &connection));
+  ASSERT_OK(uv_accept(handle, (uv_stream_t*) &connection));
+  ASSERT_OK(uv_read_start((uv_stream_t*) &connection, alloc_cb, read_cb));
+}
+
+
+static void shutdown_cb(uv_shutdown_t* req, int status) {
+  ASSERT_OK(status);
+  uv_close((uv_handle_t*) req->handle, NULL);
+}
+
+
+static void write_cb(uv_write_t* req, int status) {
+  ASSERT_OK(status);
+  /* In order. */
+  ASSERT_PTR_EQ(req, &write_reqs[write_cb_called]);
+  write_cb_called++;
+}
+
+
+static void write_chunks(uv_stream_t* stream, int first, int last) {
+  uv_buf_t buf;
+  int i;
+
+  for (i = first; i < last; i++) {
+    buf = uv_buf_init(data + i * CHUNK_SIZE, CHUNK_SIZE);
+    ASSERT_OK(uv_write(&write_reqs[i], stream, &buf, 1, write_cb));
+  }
+}
+
+
+static void connect_cb(uv_connect_t* req, int status) {
+  uv_stream_t* stream;
+
+  ASSERT_OK(status);
+  stream = req->handle;
+
+  /* Nothing goes out until the pending callbacks run, or until uncorked. */
+  ASSERT_OK(uv_stream_set_cork(stream, 1));
+  write_chunks(stream, 0, NUM_WRITES / 2);
+  ASSERT_EQ(uv_stream_get_write_queue_size(stream),
+            NUM_WRITES / 2 * CHUNK_SIZE);
+
+  ASSERT_OK(uv_stream_set_cork(stream, 0));
+  ASSERT_OK(uv_stream_get_write_queue_size(stream));
+
+  ASSERT_OK(uv_stream_set_cork(stream, 1));
+  write_chunks(stream, NUM_WRITES / 2, NUM_WRITES);
+  ASSERT_GT(uv_stream_get_write_queue_size(stream), 0);
+
+  ASSERT_OK(uv_shutdown(&shutdown_req, stream, shutdown_cb));
+}
+
+
+TEST_IMPL(tcp_write_cork) {
+#ifdef _WIN32
+  RETURN_SKIP("corked writes not supported");
+#else
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+  size_t i;
+
+  for (i = 0; i < sizeof(data); i++)
+    data[i] = i % 251;
+
+  loop = uv_default_loop();
+
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+  ASSERT_OK(uv_tcp_init(loop, &server));
+  ASSERT_OK(uv_tcp_bind(&server, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_listen((uv_stream_t*) &server, 1, connection_cb));
+
+  ASSERT_OK(uv_tcp_init(loop, &client));
+  ASSERT_OK(uv_tcp_connect(&connect_req,
+                           &client,
+                           (const struct sockaddr*) &addr,
+                           connect_cb));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(write_cb_called, NUM_WRITES);
+  ASSERT_EQ(1, eof_cb_called);
+  ASSERT_EQ(nreceived, sizeof(data));
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+#endif
+}
@@ -0,0 +1,148 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <string.h>
+
+#define THRESHOLD (64 * 1024)
+#define DATA_SIZE (1024 * 1024)
+#define TOTAL_SIZE (2 * DATA_SIZE + sizeof(tail))
+
+static uv_tcp_t server;
+static uv_tcp_t connection;
+static uv_tcp_t client;
+static uv_connect_t connect_req;
+static uv_write_t write_reqs[3];
+static uv_shutdown_t shutdown_req;
+static char data[DATA_SIZE];
+static char tail[] = "tail";
+static char received[TOTAL_SIZE + 1];  /* Room to read EOF. */
+static size_t nreceived;
+static int write_cb_called;
+static int eof_cb_called;
+
+
+static void alloc_cb(uv_handle_t* handle, size_t size, uv_buf_t* buf) {
+  ASSERT_LE(nreceived, TOTAL_SIZE);
+  *buf = uv_buf_init(received + nreceived, sizeof(received) - nreceived);
+}
+
+
+static void read_cb(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+  if (nread == UV_EOF) {
+    ASSERT_EQ(nreceived, TOTAL_SIZE);
+    ASSERT_OK(memcmp(received, data, DATA_SIZE));
+    ASSERT_OK(memcmp(received + DATA_SIZE, data, DATA_SIZE));
+    ASSERT_OK(memcmp(received + 2 * DATA_SIZE, tail, sizeof(tail)));
+    uv_close((uv_handle_t*) stream, NULL);
+    uv_close((uv_handle_t*) &server, NULL);
+    eof_cb_called++;
+    return;
+  }
+
+  ASSERT_GE(nread, 0);
+  nreceived += nread;
+}
+
+
+static void connection_cb(uv_stream_t* handle, int status) {
+  ASSERT_OK(status);
+  ASSERT_OK(uv_tcp_init(handle->loop, &connection));
+  ASSERT_OK(uv_accept(handle, (uv_stream_t*) &connection));
+  ASSERT_OK(uv_read_start((uv_stream_t*) &connection, alloc_cb, read_cb));
+}
+
+
+static void shutdown_cb(uv_shutdown_t* req, int status) {
+  ASSERT_OK(status);
+  uv_close((uv_handle_t*) req->handle, NULL);
+}
+
+
+static void write_cb(uv_write_t* req, int status) {
+  ASSERT_OK(status);
+
+  /* In order, the small write waits for the zero-copy ones. */
+  ASSERT_PTR_EQ(req, &write_reqs[write_cb_called]);
+  write_cb_called++;
+
+  /* Not before, closing doesn't wait for the kernel to finish sending. */
+  if (write_cb_called == ARRAY_SIZE(write_reqs))
+    ASSERT_OK(uv_shutdown(&shutdown_req, req->handle, shutdown_cb));
+}
+
+
+static void connect_cb(uv_connect_t* req, int status) {
+  uv_buf_t buf;
+  int i;
+
+  ASSERT_OK(status);
+
+  buf = uv_buf_init(data, sizeof(data));
+  for (i = 0; i < 2; i++)
+    ASSERT_OK(uv_write(&write_reqs[i], req->handle, &buf, 1, write_cb));
+
+  buf = uv_buf_init(tail, sizeof(tail));
+  ASSERT_OK(uv_write(&write_reqs[2], req->handle, &buf, 1, write_cb));
+}
+
+
+TEST_IMPL(tcp_write_zerocopy) {
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+  size_t i;
+  int r;
+
+  loop = uv_default_loop();
+
+  for (i = 0; i < sizeof(data); i++)
+    data[i] = i % 251;
+
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+  ASSERT_OK(uv_tcp_init(loop, &server));
+  ASSERT_OK(uv_tcp_bind(&server, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_listen((uv_stream_t*) &server, 1, connection_cb));
+
+  /* Before the socket exists, applied when it's created. */
+  ASSERT_OK(uv_tcp_init(loop, &client));
+  r = uv_tcp_zerocopy(&client, THRESHOLD);
+  if (r == UV_ENOSYS)
+    RETURN_SKIP("MSG_ZEROCOPY not supported");
+  ASSERT_OK(r);
+
+  r = uv_tcp_connect(&connect_req,
+                     &client,
+                     (const struct sockaddr*) &addr,
+                     connect_cb);
+  if (r == UV_ENOPROTOOPT)
+    RETURN_SKIP("SO_ZEROCOPY not supported by the kernel");
+  ASSERT_OK(r);
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(3, write_cb_called);
+  ASSERT_EQ(1, eof_cb_called);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
@@ -74,3 +74,515 @@ TEST_IMPL(threadpool_queue_work_einval) {
   MAKE_VALGRIND_HAPPY(uv_default_loop());
   return 0;
 }
+
+
+static uv_work_t steal_reqs[4];
+static uv_work_t steal_cancel_req;
+static uv_barrier_t steal_barrier;
+static uv_sem_t steal_sem;
+static int steal_done_cb_called;
+static int steal_cancel_cb_called;
+
+
+static void steal_work_cb(uv_work_t* req) {
+  uv_barrier_wait(&steal_barrier);
+  uv_sem_wait(&steal_sem);
+}
+
+
+static void steal_done_cb(uv_work_t* req, int status) {
+  ASSERT_OK(status);
+  steal_done_cb_called++;
+}
+
+
+static void steal_cancel_cb(uv_work_t* req, int status) {
+  ASSERT_EQ(status, UV_ECANCELED);
+  steal_cancel_cb_called++;
+}
+
+
+TEST_IMPL(threadpool_work_stealing) {
+  static char size_env[] = "UV_THREADPOOL_SIZE=4";
+  static char stealing_env[] = "UV_THREADPOOL_STEALING=1";
+  uv_loop_t* loop;
+  size_t i;
+
+  ASSERT_OK(putenv(size_env));
+  ASSERT_OK(putenv(stealing_env));
+
+  /* All requests go to the loop's home queue. They can only run at the
+   * same time if the other threads steal them.
+   */
+  loop = uv_default_loop();
+  ASSERT_OK(uv_barrier_init(&steal_barrier, ARRAY_SIZE(steal_reqs) + 1));
+  ASSERT_OK(uv_sem_init(&steal_sem, 0));
+  for (i = 0; i < ARRAY_SIZE(steal_reqs); i++)
+    ASSERT_OK(uv_queue_work(loop,
+                            steal_reqs + i,
+                            steal_work_cb,
+                            steal_done_cb));
+  uv_barrier_wait(&steal_barrier);
+
+  /* Every thread is busy so this one is still queued. */
+  ASSERT_OK(uv_queue_work(loop,
+                          &steal_cancel_req,
+                          steal_work_cb,
+                          steal_cancel_cb));
+  ASSERT_OK(uv_cancel((uv_req_t*) &steal_cancel_req));
+
+  for (i = 0; i < ARRAY_SIZE(steal_reqs); i++)
+    uv_sem_post(&steal_sem);
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(steal_done_cb_called, ARRAY_SIZE(steal_reqs));
+  ASSERT_EQ(1, steal_cancel_cb_called);
+
+  uv_barrier_destroy(&steal_barrier);
+  uv_sem_destroy(&steal_sem);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
+
+
+static int pool_done_cb_called;
+
+
+static void pool_work_cb(uv_work_t* req) {
+  uv_barrier_t* barrier;
+
+  barrier = (uv_barrier_t*) req->data;
+  if (barrier != NULL)
+    uv_barrier_wait(barrier);
+}
+
+
+static void pool_done_cb(uv_work_t* req, int status) {
+  ASSERT_OK(status);
+  pool_done_cb_called++;
+}
+
+
+TEST_IMPL(threadpool_named_pool) {
+  uv_threadpool_stats_t stats;
+  uv_work_options_t options;
+  uv_threadpool_t* other;
+  uv_threadpool_t* pool;
+  uv_work_t reqs[4];
+  uv_loop_t* loop;
+  size_t i;
+
+  ASSERT_OK(uv_threadpool_new(&pool, "named", 2, 0));
+  ASSERT_PTR_EQ(pool, uv_threadpool_get("named"));
+  ASSERT_OK(strcmp("named", uv_threadpool_get_name(pool)));
+  ASSERT_EQ(UV_EEXIST, uv_threadpool_new(&other, "named", 1, 0));
+  ASSERT_EQ(UV_EINVAL, uv_threadpool_new(&other, "other", 0, 0));
+  ASSERT_EQ(UV_EINVAL, uv_threadpool_delete(uv_threadpool_get("default")));
+
+  loop = uv_default_loop();
+  memset(&options, 0, sizeof(options));
+  options.pool = pool;
+  for (i = 0; i < ARRAY_SIZE(reqs); i++) {
+    reqs[i].data = NULL;
+    ASSERT_OK(uv_queue_work_ex(loop,
+                               reqs + i,
+                               pool_work_cb,
+                               pool_done_cb,
+                               &options));
+  }
+  ASSERT_EQ(UV_EBUSY, uv_threadpool_delete(pool));
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(pool_done_cb_called, ARRAY_SIZE(reqs));
+
+  ASSERT_OK(uv_threadpool_stats(pool, &stats));
+  ASSERT_EQ(2, stats.size);
+  ASSERT_EQ(ARRAY_SIZE(reqs), stats.submitted);
+  ASSERT_EQ(ARRAY_SIZE(reqs), stats.completed);
+  ASSERT_OK(stats.cancelled);
+
+  ASSERT_OK(uv_threadpool_delete(pool));
+  ASSERT_NULL(uv_threadpool_get("named"));
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
+
+
+TEST_IMPL(threadpool_resize) {
+  uv_threadpool_stats_t stats;
+  uv_work_options_t options;
+  uv_threadpool_t* pool;
+  uv_barrier_t barrier;
+  uv_work_t reqs[3];
+  uv_loop_t* loop;
+  size_t i;
+
+  ASSERT_OK(uv_threadpool_new(&pool,
+                              "resize",
+                              1,
+                              UV_THREADPOOL_WORK_STEALING));
+  ASSERT_EQ(UV_EINVAL, uv_threadpool_resize(pool, 0));
+  ASSERT_OK(uv_threadpool_resize(pool, ARRAY_SIZE(reqs)));
+  ASSERT_OK(uv_threadpool_stats(pool, &stats));
+  ASSERT_EQ(stats.size, ARRAY_SIZE(reqs));
+
+  /* The requests can only get past the barrier if they run concurrently. */
+  loop = uv_default_loop();
+  memset(&options, 0, sizeof(options));
+  options.pool = pool;
+  ASSERT_OK(uv_barrier_init(&barrier, ARRAY_SIZE(reqs)));
+  for (i = 0; i < ARRAY_SIZE(reqs); i++) {
+    reqs[i].data = &barrier;
+    ASSERT_OK(uv_queue_work_ex(loop,
+                               reqs + i,
+                               pool_work_cb,
+                               pool_done_cb,
+                               &options));
+  }
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(pool_done_cb_called, ARRAY_SIZE(reqs));
+  uv_barrier_destroy(&barrier);
+
+  ASSERT_OK(uv_threadpool_resize(pool, 1));
+  ASSERT_OK(uv_threadpool_stats(pool, &stats));
+  ASSERT_EQ(1, stats.size);
+
+  /* The remaining thread still runs work. */
+  reqs[0].data = NULL;
+  ASSERT_OK(uv_queue_work_ex(loop,
+                             reqs,
+                             pool_work_cb,
+                             pool_done_cb,
+                             &options));
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(pool_done_cb_called, ARRAY_SIZE(reqs) + 1);
+
+  ASSERT_OK(uv_threadpool_delete(pool));
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
+
+
+static uv_loop_t shrink_loops[4];
+static uv_work_t shrink_busy_reqs[2];
+static uv_work_t shrink_reqs[ARRAY_SIZE(shrink_loops)];
+static uv_work_options_t shrink_options;
+static int shrink_busy_rounds;
+static int shrink_done_cb_called;
+
+
+static void shrink_busy_work_cb(uv_work_t* req) {
+  uv_sleep(1);
+}
+
+
+static void shrink_busy_done_cb(uv_work_t* req, int status) {
+  ASSERT_OK(status);
+
+  /* Keep the remaining thread's own queue from running dry, so it never
+   * goes idle and steals.
+   */
+  if (shrink_done_cb_called == ARRAY_SIZE(shrink_reqs) - 1)
+    return;
+  if (++shrink_busy_rounds == 1000)
+    return;
+
+  ASSERT_OK(uv_queue_work_ex(req->loop,
+                             req,
+                             shrink_busy_work_cb,
+                             shrink_busy_done_cb,
+                             &shrink_options));
+}
+
+
+static void shrink_work_cb(uv_work_t* req) {
+}
+
+
+static void shrink_done_cb(uv_work_t* req, int status) {
+  ASSERT_OK(status);
+  shrink_done_cb_called++;
+}
+
+
+TEST_IMPL(threadpool_resize_stealing) {
+  uv_threadpool_stats_t stats;
+  uv_threadpool_t* pool;
+  int alive;
+  size_t i;
+
+  ASSERT_OK(uv_threadpool_new(&pool,
+                              "shrink",
+                              ARRAY_SIZE(shrink_loops),
+                              UV_THREADPOOL_WORK_STEALING));
+  ASSERT_OK(uv_threadpool_resize(pool, 1));
+
+  memset(&shrink_options, 0, sizeof(shrink_options));
+  shrink_options.pool = pool;
+  for (i = 0; i < ARRAY_SIZE(shrink_loops); i++)
+    ASSERT_OK(uv_loop_init(shrink_loops + i));
+
+  /* The loops get a queue each, round-robin. The first one keeps the last
+   * thread busy, the queues of the others lost their threads.
+   */
+  for (i = 0; i < ARRAY_SIZE(shrink_busy_reqs); i++)
+    ASSERT_OK(uv_queue_work_ex(shrink_loops,
+                               shrink_busy_reqs + i,
+                               shrink_busy_work_cb,
+                               shrink_busy_done_cb,
+                               &shrink_options));
+  for (i = 1; i < ARRAY_SIZE(shrink_loops); i++)
+    ASSERT_OK(uv_queue_work_ex(shrink_loops + i,
+                               shrink_reqs + i,
+                               shrink_work_cb,
+                               shrink_done_cb,
+                               &shrink_options));
+
+  do {
+    alive = 0;
+    for (i = 0; i < ARRAY_SIZE(shrink_loops); i++)
+      alive |= uv_run(shrink_loops + i, UV_RUN_NOWAIT);
+  } while (alive);
+
+  ASSERT_EQ(shrink_done_cb_called, ARRAY_SIZE(shrink_reqs) - 1);
+  ASSERT_LT(shrink_busy_rounds, 1000);
+
+  ASSERT_OK(uv_threadpool_stats(pool, &stats));
+  ASSERT_EQ(1, stats.size);
+  ASSERT_EQ(stats.submitted, stats.completed);
+  ASSERT_OK(stats.queued);
+
+  for (i = 0; i < ARRAY_SIZE(shrink_loops); i++)
+    ASSERT_OK(uv_loop_close(shrink_loops + i));
+  ASSERT_OK(uv_threadpool_delete(pool));
+
+  MAKE_VALGRIND_HAPPY(uv_default_loop());
+  return 0;
+}
+
+
+static void pool_random_cb(uv_random_t* req, int status, void* buf, size_t n) {
+  ASSERT_OK(status);
+  pool_done_cb_called++;
+}
+
+
+TEST_IMPL(threadpool_loop_configure) {
+  uv_threadpool_stats_t stats;
+  uv_threadpool_t* pool;
+  uv_random_t req;
+  uv_loop_t* loop;
+  char buf[16];
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_threadpool_new(&pool, "random", 1, 0));
+  ASSERT_EQ(UV_EINVAL,
+            uv_loop_configure(loop, UV_LOOP_USE_THREADPOOL, UV_WRITE, pool));
+  ASSERT_OK(uv_loop_configure(loop, UV_LOOP_USE_THREADPOOL, UV_RANDOM, pool));
+
+  ASSERT_OK(uv_random(loop, &req, buf, sizeof(buf), 0, pool_random_cb));
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(1, pool_done_cb_called);
+
+  ASSERT_OK(uv_threadpool_stats(pool, &stats));
+  ASSERT_EQ(1, stats.submitted);
+  ASSERT_EQ(1, stats.completed);
+
+  /* The loop holds on to the pool until it is reconfigured. */
+  ASSERT_EQ(UV_EBUSY, uv_threadpool_delete(pool));
+  ASSERT_OK(uv_loop_configure(loop, UV_LOOP_USE_THREADPOOL, UV_RANDOM, NULL));
+  ASSERT_OK(uv_threadpool_delete(pool));
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
+
+
+static uv_work_t* priority_order[32];
+static unsigned int priority_order_len;
+static uv_sem_t priority_sem;
+
+
+static void priority_block_cb(uv_work_t* req) {
+  uv_sem_wait(&priority_sem);
+}
+
+
+static void priority_work_cb(uv_work_t* req) {
+  priority_order[priority_order_len++] = req;
+}
+
+
+TEST_IMPL(threadpool_priority) {
+  uv_work_options_t options;
+  uv_threadpool_t* pool;
+  uv_work_t background;
+  uv_work_t normal;
+  uv_work_t high[20];
+  uv_work_t block;
+  uv_loop_t* loop;
+  size_t i;
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_threadpool_new(&pool, "priority", 1, 0));
+  ASSERT_OK(uv_sem_init(&priority_sem, 0));
+
+  memset(&options, 0, sizeof(options));
+  options.pool = pool;
+  options.priority = (uv_work_priority) 42;
+  ASSERT_EQ(UV_EINVAL, uv_queue_work_ex(loop,
+                                        &block,
+                                        priority_work_cb,
+                                        NULL,
+                                        &options));
+  ASSERT_EQ(UV_EINVAL,
+            uv_loop_configure(loop, UV_LOOP_FS_PRIORITY, UV_FS_UNKNOWN, 0));
+  ASSERT_OK(uv_loop_configure(loop,
+                              UV_LOOP_FS_PRIORITY,
+                              UV_FS_STAT,
+                              UV_WORK_PRIORITY_HIGH));
+
+  /* Keep the only thread busy until everything is queued. */
+  options.priority = UV_WORK_PRIORITY_NORMAL;
+  ASSERT_OK(uv_queue_work_ex(loop, &block, priority_block_cb, NULL, &options));
+
+  options.priority = UV_WORK_PRIORITY_BACKGROUND;
+  ASSERT_OK(uv_queue_work_ex(loop,
+                             &background,
+                             priority_work_cb,
+                             NULL,
+                             &options));
+  options.priority = UV_WORK_PRIORITY_NORMAL;
+  ASSERT_OK(uv_queue_work_ex(loop, &normal, priority_work_cb, NULL, &options));
+  options.priority = UV_WORK_PRIORITY_HIGH;
+  for (i = 0; i < ARRAY_SIZE(high); i++)
+    ASSERT_OK(uv_queue_work_ex(loop,
+                               high + i,
+                               priority_work_cb,
+                               NULL,
+                               &options));
+
+  /* Cancelling queued work still works. */
+  ASSERT_OK(uv_cancel((uv_req_t*) &high[19]));
+
+  uv_sem_post(&priority_sem);
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  /* High priority work goes first, but the other classes get a turn before
+   * the high priority backlog is gone.
+   */
+  ASSERT_EQ(21, priority_order_len);
+  for (i = 0; i < 16; i++)
+    ASSERT_PTR_EQ(priority_order[i], high + i);
+  ASSERT_PTR_EQ(priority_order[16], &normal);
+  ASSERT_PTR_EQ(priority_order[17], &background);
+  for (i = 16; i < 19; i++)
+    ASSERT_PTR_EQ(priority_order[i + 2], high + i);
+
+  uv_sem_destroy(&priority_sem);
+  ASSERT_OK(uv_loop_configure(loop,
+                              UV_LOOP_FS_PRIORITY,
+                              UV_FS_STAT,
+                              UV_WORK_PRIORITY_NORMAL));
+  ASSERT_OK(uv_threadpool_delete(pool));
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
+
+
+/* Counts the durations from 2^(first-1) us up. */
+static uint64_t histogram_sum(const uint64_t* buckets, size_t first) {
+  uint64_t sum;
+  size_t i;
+
+  sum = 0;
+  for (i = first; i < UV_THREADPOOL_HISTOGRAM_BUCKETS; i++)
+    sum += buckets[i];
+
+  return sum;
+}
+
+
+static void stats_fs_cb(uv_fs_t* req) {
+  ASSERT_OK(req->result);
+  uv_fs_req_cleanup(req);
+  pool_done_cb_called++;
+}
+
+
+TEST_IMPL(threadpool_stats) {
+  uv_threadpool_stats_t stats;
+  uv_work_options_t options;
+  uv_threadpool_t* pool;
+  uv_work_t reqs[3];
+  uv_fs_t fs_req;
+  uv_loop_t* loop;
+  size_t i;
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_threadpool_new(&pool, "stats", 1, 0));
+  ASSERT_OK(uv_sem_init(&priority_sem, 0));
+
+  memset(&options, 0, sizeof(options));
+  options.pool = pool;
+  ASSERT_OK(uv_queue_work_ex(loop,
+                             reqs,
+                             priority_block_cb,
+                             pool_done_cb,
+                             &options));
+  for (i = 1; i < ARRAY_SIZE(reqs); i++) {
+    reqs[i].data = NULL;
+    ASSERT_OK(uv_queue_work_ex(loop,
+                               reqs + i,
+                               pool_work_cb,
+                               pool_done_cb,
+                               &options));
+  }
+
+  /* Wait for the thread to pick up the blocking request. */
+  do {
+    ASSERT_OK(uv_threadpool_stats(pool, &stats));
+    if (stats.busy_threads == 0)
+      uv_sleep(1);
+  } while (stats.busy_threads == 0);
+
+  ASSERT_EQ(1, stats.busy_threads);
+  ASSERT_EQ(ARRAY_SIZE(reqs) - 1, stats.queued);
+  ASSERT_OK(stats.slow_io_queued);
+
+  uv_sleep(10);
+  uv_sem_post(&priority_sem);
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(pool_done_cb_called, ARRAY_SIZE(reqs));
+
+  ASSERT_OK(uv_loop_configure(loop, UV_LOOP_USE_THREADPOOL, UV_FS, pool));
+  ASSERT_OK(uv_fs_realpath(loop, &fs_req, ".", stats_fs_cb));
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(pool_done_cb_called, ARRAY_SIZE(reqs) + 1);
+  ASSERT_OK(uv_loop_configure(loop, UV_LOOP_USE_THREADPOOL, UV_FS, NULL));
+
+  ASSERT_OK(uv_threadpool_stats(pool, &stats));
+  ASSERT_OK(stats.busy_threads);
+  ASSERT_OK(stats.queued);
+  ASSERT_EQ(ARRAY_SIZE(reqs),
+            histogram_sum(stats.wait_time[UV_WORK_KIND_CPU], 0));
+  ASSERT_EQ(ARRAY_SIZE(reqs),
+            histogram_sum(stats.run_time[UV_WORK_KIND_CPU], 0));
+  ASSERT_EQ(1, histogram_sum(stats.run_time[UV_WORK_KIND_FAST_IO], 0));
+  ASSERT_OK(histogram_sum(stats.run_time[UV_WORK_KIND_SLOW_IO], 0));
+
+  /* The blocking request ran for more than 8 ms, the others waited for it
+   * at least as long.
+   */
+  ASSERT_EQ(1, histogram_sum(stats.run_time[UV_WORK_KIND_CPU], 14));
+  ASSERT_EQ(2, histogram_sum(stats.wait_time[UV_WORK_KIND_CPU], 14));
+
+  uv_sem_destroy(&priority_sem);
+  ASSERT_OK(uv_threadpool_delete(pool));
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
@@ -425,3 +425,185 @@ TEST_IMPL(timer_no_run_on_unref) {
   MAKE_VALGRIND_HAPPY(uv_default_loop());
   return 0;
 }
+
+
+static uv_timer_t wheel_timers[200];
+static uint64_t wheel_timeouts[ARRAY_SIZE(wheel_timers)];
+static unsigned int wheel_seqs[ARRAY_SIZE(wheel_timers)];
+static unsigned int wheel_seq;
+static uint64_t wheel_last_timeout;
+static unsigned int wheel_last_seq;
+static unsigned int wheel_cb_called;
+
+
+static void wheel_start(uv_timer_t* handle, uv_timer_cb cb, uint64_t timeout) {
+  size_t i;
+
+  i = handle - wheel_timers;
+  wheel_timeouts[i] = uv_now(handle->loop) + timeout;
+  wheel_seqs[i] = wheel_seq++;
+  ASSERT_OK(uv_timer_start(handle, cb, timeout, 0));
+}
+
+
+static void wheel_cb(uv_timer_t* handle) {
+  size_t i;
+
+  /* Timers fire in order of timeout, then in the order they were started. */
+  i = handle - wheel_timers;
+  if (wheel_cb_called > 0) {
+    ASSERT_LE(wheel_last_timeout, wheel_timeouts[i]);
+    if (wheel_last_timeout == wheel_timeouts[i])
+      ASSERT_LT(wheel_last_seq, wheel_seqs[i]);
+  }
+
+  wheel_last_timeout = wheel_timeouts[i];
+  wheel_last_seq = wheel_seqs[i];
+  wheel_cb_called++;
+}
+
+
+static void wheel_restart_cb(uv_timer_t* handle) {
+  wheel_cb(handle);
+
+  /* A timer started from a callback with a zero timeout fires without
+   * waiting for the next loop iteration.
+   */
+  wheel_start(handle, wheel_cb, 0);
+}
+
+
+static int timer_backend(uv_loop_option option) {
+  uv_timer_t huge_timers[2];
+  uv_loop_t loop;
+  size_t i;
+
+  wheel_seq = 0;
+  wheel_cb_called = 0;
+
+  ASSERT_OK(uv_loop_init(&loop));
+  ASSERT_OK(uv_timer_init(&loop, huge_timers));
+  ASSERT_OK(uv_timer_start(huge_timers, wheel_cb, 1, 0));
+  ASSERT_EQ(UV_EBUSY, uv_loop_configure(&loop, option));
+  ASSERT_OK(uv_timer_stop(huge_timers));
+  ASSERT_OK(uv_loop_configure(&loop, option));
+
+  /* The wheel and the array heap are mutually exclusive. */
+  if (option == UV_LOOP_TIMER_WHEEL)
+    ASSERT_EQ(UV_EINVAL, uv_loop_configure(&loop, UV_LOOP_TIMER_DHEAP));
+  else
+    ASSERT_EQ(UV_EINVAL, uv_loop_configure(&loop, UV_LOOP_TIMER_WHEEL));
+
+  /* Timers far out land in the upper levels of the wheel. */
+  ASSERT_OK(uv_timer_init(&loop, huge_timers + 1));
+  ASSERT_OK(uv_timer_start(huge_timers, wheel_cb, (uint64_t) 1 << 40, 0));
+  ASSERT_OK(uv_timer_start(huge_timers + 1, wheel_cb, (uint64_t) -1, 0));
+  ASSERT_EQ((uint64_t) 1 << 40, uv_timer_get_due_in(huge_timers));
+  uv_unref((uv_handle_t*) huge_timers);
+  uv_unref((uv_handle_t*) (huge_timers + 1));
+
+  for (i = 0; i < ARRAY_SIZE(wheel_timers); i++) {
+    ASSERT_OK(uv_timer_init(&loop, wheel_timers + i));
+    wheel_start(wheel_timers + i, wheel_cb, (i * 37) % 150);
+  }
+
+  /* Restarting a timer moves it behind the others with the same timeout. */
+  wheel_start(wheel_timers, wheel_cb, 0);
+  wheel_start(wheel_timers + 1, wheel_restart_cb, 70);
+  ASSERT_OK(uv_timer_stop(wheel_timers + 2));
+
+  /* One timer is stopped, one fires twice. */
+  ASSERT_OK(uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(wheel_cb_called, ARRAY_SIZE(wheel_timers));
+
+  ASSERT_OK(uv_timer_stop(huge_timers));
+  ASSERT_OK(uv_timer_stop(huge_timers + 1));
+  for (i = 0; i < ARRAY_SIZE(wheel_timers); i++)
+    uv_close((uv_handle_t*) (wheel_timers + i), NULL);
+  uv_close((uv_handle_t*) huge_timers, NULL);
+  uv_close((uv_handle_t*) (huge_timers + 1), NULL);
+  ASSERT_OK(uv_run(&loop, UV_RUN_DEFAULT));
+
+  MAKE_VALGRIND_HAPPY(&loop);
+  return 0;
+}
+
+
+TEST_IMPL(timer_wheel) {
+  return timer_backend(UV_LOOP_TIMER_WHEEL);
+}
+
+
+TEST_IMPL(timer_dheap) {
+  return timer_backend(UV_LOOP_TIMER_DHEAP);
+}
+
+
+static uv_timer_t slack_timers[10];
+static unsigned int slack_iteration;
+static unsigned int slack_fired_iteration;
+static unsigned int slack_precise_iteration;
+static unsigned int slack_cb_called;
+
+
+static void slack_prepare_cb(uv_prepare_t* handle) {
+  slack_iteration++;
+}
+
+
+static void slack_cb(uv_timer_t* handle) {
+  size_t i;
+
+  /* Timers with slack fire together, in order, but never early. */
+  i = handle - slack_timers;
+  ASSERT_EQ(i, slack_cb_called);
+  ASSERT_GE(uv_now(handle->loop), (uint64_t) (uintptr_t) handle->data);
+  if (slack_cb_called > 0)
+    ASSERT_EQ(slack_fired_iteration, slack_iteration);
+
+  slack_fired_iteration = slack_iteration;
+  slack_cb_called++;
+}
+
+
+static void slack_precise_cb(uv_timer_t* handle) {
+  ASSERT_OK(slack_cb_called);
+  slack_precise_iteration = slack_iteration;
+}
+
+
+TEST_IMPL(timer_slack) {
+  uv_timer_t precise;
+  uv_prepare_t prepare;
+  uv_loop_t* loop;
+  size_t i;
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_prepare_init(loop, &prepare));
+  ASSERT_OK(uv_prepare_start(&prepare, slack_prepare_cb));
+  uv_unref((uv_handle_t*) &prepare);
+
+  ASSERT_OK(uv_timer_init(loop, &precise));
+  ASSERT_OK(uv_timer_start_ex(&precise, slack_precise_cb, 5, 0, 0));
+
+  for (i = 0; i < ARRAY_SIZE(slack_timers); i++) {
+    ASSERT_OK(uv_timer_init(loop, slack_timers + i));
+    slack_timers[i].data = (void*) (uintptr_t) (uv_now(loop) + 10 + i);
+    ASSERT_OK(uv_timer_start_ex(slack_timers + i, slack_cb, 10 + i, 0, 50));
+  }
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(slack_cb_called, ARRAY_SIZE(slack_timers));
+
+  /* The timer without slack woke up the loop on its own. */
+  ASSERT_LT(slack_precise_iteration, slack_fired_iteration);
+
+  uv_close((uv_handle_t*) &prepare, NULL);
+  uv_close((uv_handle_t*) &precise, NULL);
+  for (i = 0; i < ARRAY_SIZE(slack_timers); i++)
+    uv_close((uv_handle_t*) (slack_timers + i), NULL);
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
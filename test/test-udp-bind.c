@@ -91,3 +91,43 @@ TEST_IMPL(udp_bind_reuseaddr) {
   MAKE_VALGRIND_HAPPY(loop);
   return 0;
 }
+
+
+TEST_IMPL(udp_bind_reuseport) {
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+  uv_udp_t h1, h2;
+  int r;
+
+  ASSERT_OK(uv_ip4_addr("0.0.0.0", TEST_PORT, &addr));
+
+  loop = uv_default_loop();
+
+  r = uv_udp_init(loop, &h1);
+  ASSERT_OK(r);
+
+  r = uv_udp_init(loop, &h2);
+  ASSERT_OK(r);
+
+  r = uv_udp_bind(&h1, (const struct sockaddr*) &addr, UV_UDP_REUSEPORT);
+  if (r == UV_ENOTSUP) {
+    uv_close((uv_handle_t*) &h1, NULL);
+    uv_close((uv_handle_t*) &h2, NULL);
+    ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+    MAKE_VALGRIND_HAPPY(loop);
+    RETURN_SKIP("SO_REUSEPORT load balancing is not supported");
+  }
+  ASSERT_OK(r);
+
+  r = uv_udp_bind(&h2, (const struct sockaddr*) &addr, UV_UDP_REUSEPORT);
+  ASSERT_OK(r);
+
+  uv_close((uv_handle_t*) &h1, NULL);
+  uv_close((uv_handle_t*) &h2, NULL);
+
+  r = uv_run(loop, UV_RUN_DEFAULT);
+  ASSERT_OK(r);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
@@ -0,0 +1,138 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <string.h>
+
+#define SEGMENT_SIZE 100
+#define DATA_SIZE 950
+
+static uv_udp_t server;
+static uv_udp_t client;
+static uv_udp_send_t send_req;
+static char data[DATA_SIZE];
+static char storage[64 * 1024];
+static size_t nreceived;
+static int gro_cb_called;
+static int send_cb_called;
+static int close_cb_called;
+
+
+static void alloc_cb(uv_handle_t* handle,
+                     size_t suggested_size,
+                     uv_buf_t* buf) {
+  buf->base = storage;
+  buf->len = sizeof(storage);
+}
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void recv_cb(uv_udp_t* handle,
+                    ssize_t nread,
+                    const uv_buf_t* buf,
+                    const struct sockaddr* addr,
+                    unsigned flags) {
+  ASSERT_GE(nread, 0);
+  if (nread == 0)
+    return;
+
+  ASSERT_NOT_NULL(addr);
+  ASSERT_LE(nreceived + nread, DATA_SIZE);
+  ASSERT_OK(memcmp(buf->base, data + nreceived, nread));
+  nreceived += nread;
+
+  /* Whether the kernel coalesces the segments again is up to it. */
+  if (flags & UV_UDP_GRO) {
+    ASSERT_EQ(SEGMENT_SIZE, UV_UDP_GRO_SEGMENT_SIZE(flags));
+    gro_cb_called++;
+  } else {
+    ASSERT_EQ(0, UV_UDP_GRO_SEGMENT_SIZE(flags));
+    ASSERT_LE(nread, SEGMENT_SIZE);
+  }
+
+  if (nreceived == DATA_SIZE) {
+    uv_close((uv_handle_t*) &server, close_cb);
+    uv_close((uv_handle_t*) &client, close_cb);
+  }
+}
+
+
+static void send_cb(uv_udp_send_t* req, int status) {
+  ASSERT_OK(status);
+  send_cb_called++;
+}
+
+
+TEST_IMPL(udp_gso) {
+#ifdef _WIN32
+  RETURN_SKIP("UDP segmentation offload is not supported on Windows");
+#else
+  struct sockaddr_in addr;
+  uv_buf_t buf;
+  size_t i;
+  int r;
+
+  for (i = 0; i < sizeof(data); i++)
+    data[i] = i % 251;
+
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_udp_init(uv_default_loop(), &server));
+  ASSERT_OK(uv_udp_bind(&server, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_udp_init(uv_default_loop(), &client));
+
+  r = uv_udp_set_gso(&client, SEGMENT_SIZE);
+  if (r == UV_ENOSYS || r == UV_ENOPROTOOPT)
+    RETURN_SKIP("UDP_SEGMENT not supported");
+  ASSERT_OK(r);
+  ASSERT_EQ(UV_EINVAL, uv_udp_set_gso(&client, 65536));
+
+  r = uv_udp_set_gro(&server, 1);
+  if (r == UV_ENOSYS || r == UV_ENOPROTOOPT)
+    RETURN_SKIP("UDP_GRO not supported");
+  ASSERT_OK(r);
+
+  ASSERT_OK(uv_udp_recv_start(&server, alloc_cb, recv_cb));
+
+  buf = uv_buf_init(data, sizeof(data));
+  ASSERT_OK(uv_udp_send(&send_req,
+                        &client,
+                        &buf,
+                        1,
+                        (const struct sockaddr*) &addr,
+                        send_cb));
+
+  ASSERT_OK(uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+
+  ASSERT_EQ(1, send_cb_called);
+  ASSERT_EQ(2, close_cb_called);
+  ASSERT_EQ(DATA_SIZE, nreceived);
+
+  MAKE_VALGRIND_HAPPY(uv_default_loop());
+  return 0;
+#endif
+}
@@ -0,0 +1,150 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_SENDS 20
+#define DGRAM_SIZE 1000
+#define RATE 100000
+#define BURST 1000
+
+static uv_udp_t server;
+static uv_udp_t client;
+static uv_udp_send_t send_reqs[NUM_SENDS];
+static char data[DGRAM_SIZE];
+static char slab[64 * 1024];
+static uint64_t start_time;
+static uint64_t last_recv_time;
+static int recv_cb_called;
+static int send_cb_called;
+static int close_cb_called;
+
+
+static void alloc_cb(uv_handle_t* handle,
+                     size_t suggested_size,
+                     uv_buf_t* buf) {
+  buf->base = slab;
+  buf->len = sizeof(slab);
+}
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void recv_cb(uv_udp_t* handle,
+                    ssize_t nread,
+                    const uv_buf_t* buf,
+                    const struct sockaddr* addr,
+                    unsigned flags) {
+  ASSERT_GE(nread, 0);
+  if (nread == 0)
+    return;
+
+  ASSERT_EQ(DGRAM_SIZE, nread);
+  last_recv_time = uv_hrtime();
+
+  if (++recv_cb_called == NUM_SENDS) {
+    uv_close((uv_handle_t*) &server, close_cb);
+    uv_close((uv_handle_t*) &client, close_cb);
+  }
+}
+
+
+static void send_cb(uv_udp_send_t* req, int status) {
+  ASSERT_OK(status);
+  send_cb_called++;
+}
+
+
+TEST_IMPL(udp_pacing) {
+#ifdef _WIN32
+  RETURN_SKIP("uv_udp_set_pacing is not supported on Windows");
+#else
+  struct sockaddr_in addr;
+  uv_udp_stats_t stats;
+  uv_buf_t buf;
+  char* big;
+  int i;
+
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_udp_init(uv_default_loop(), &server));
+  ASSERT_OK(uv_udp_bind(&server, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_udp_recv_start(&server, alloc_cb, recv_cb));
+  ASSERT_OK(uv_udp_init(uv_default_loop(), &client));
+
+  /* A datagram that can't be sent counts as dropped. */
+  big = malloc(70 * 1024);
+  ASSERT_NOT_NULL(big);
+  buf = uv_buf_init(big, 70 * 1024);
+  ASSERT_EQ(UV_EMSGSIZE,
+            uv_udp_try_send(&client, &buf, 1, (const struct sockaddr*) &addr));
+  free(big);
+
+  ASSERT_EQ(UV_EINVAL, uv_udp_set_pacing(&client, RATE, 0));
+
+  /* The burst goes out right away, the next datagram has to wait. Slowly,
+   * so that the bucket doesn't refill in between.
+   */
+  ASSERT_OK(uv_udp_set_pacing(&client, 1000, BURST));
+  buf = uv_buf_init(data, sizeof(data));
+  ASSERT_EQ(DGRAM_SIZE,
+            uv_udp_try_send(&client, &buf, 1, (const struct sockaddr*) &addr));
+  ASSERT_EQ(UV_EAGAIN,
+            uv_udp_try_send(&client, &buf, 1, (const struct sockaddr*) &addr));
+
+  ASSERT_OK(uv_udp_set_pacing(&client, RATE, BURST));
+
+  start_time = uv_hrtime();
+  for (i = 1; i < NUM_SENDS; i++)
+    ASSERT_OK(uv_udp_send(&send_reqs[i],
+                          &client,
+                          &buf,
+                          1,
+                          (const struct sockaddr*) &addr,
+                          send_cb));
+
+  ASSERT_OK(uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+
+  ASSERT_EQ(NUM_SENDS - 1, send_cb_called);
+  ASSERT_EQ(NUM_SENDS, recv_cb_called);
+  ASSERT_EQ(2, close_cb_called);
+
+  /* 19 more kB at 100 kB/s. */
+  ASSERT_GE(last_recv_time - start_time, 150 * 1000 * 1000);
+  ASSERT_LT(last_recv_time - start_time, 5000ull * 1000 * 1000);
+
+  ASSERT_OK(uv_udp_get_stats(&client, &stats));
+  ASSERT_EQ(NUM_SENDS, stats.sent_datagrams);
+  ASSERT_EQ(NUM_SENDS * DGRAM_SIZE, stats.sent_bytes);
+  ASSERT_EQ(1, stats.dropped_datagrams);
+  ASSERT_GT(stats.paced, 0);
+
+  MAKE_VALGRIND_HAPPY(uv_default_loop());
+  return 0;
+#endif
+}
@@ -0,0 +1,182 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <string.h>
+
+#ifndef _WIN32
+# include <netinet/in.h>
+#endif
+
+#define NUM_SENDS 10
+#define TOS 0x28
+
+static uv_udp_t server;
+static uv_udp_t client;
+static uv_udp_send_t send_reqs[NUM_SENDS];
+static struct sockaddr_in client_addr;
+static char slab[4 * 64 * 1024];
+static int recv_cb_called;
+static int close_cb_called;
+
+
+static void alloc_cb(uv_handle_t* handle,
+                     size_t suggested_size,
+                     uv_buf_t* buf) {
+  buf->base = slab;
+  buf->len = sizeof(slab);
+}
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void recv_cb(uv_udp_t* handle,
+                    ssize_t nread,
+                    const uv_buf_t* buf,
+                    const struct sockaddr* addr,
+                    unsigned flags) {
+  const uv_udp_recv_meta_t* meta;
+  const struct sockaddr_in* peer;
+  const struct sockaddr_in* local;
+  uv_timespec64_t now;
+
+  ASSERT_GE(nread, 0);
+  if (nread == 0) {
+    ASSERT_NULL(addr);
+    return;
+  }
+
+  ASSERT_EQ(4, nread);
+  ASSERT_OK(memcmp(buf->base, "PING", 4));
+
+  ASSERT(flags & UV_UDP_RECV_META);
+  meta = (const uv_udp_recv_meta_t*) addr;
+  ASSERT_PTR_EQ(addr, &meta->addr);
+
+  peer = (const struct sockaddr_in*) &meta->addr;
+  ASSERT_EQ(AF_INET, peer->sin_family);
+  ASSERT_EQ(client_addr.sin_port, peer->sin_port);
+
+  ASSERT_EQ(meta->flags, UV_UDP_META_TIMESTAMP |
+                         UV_UDP_META_PKTINFO |
+                         UV_UDP_META_TOS);
+
+  ASSERT_OK(uv_clock_gettime(UV_CLOCK_REALTIME, &now));
+  ASSERT_LE(meta->timestamp.tv_sec, now.tv_sec);
+  ASSERT_GE(meta->timestamp.tv_sec, now.tv_sec - 60);
+
+  local = (const struct sockaddr_in*) &meta->local;
+  ASSERT_EQ(AF_INET, local->sin_family);
+  ASSERT_EQ(htonl(INADDR_LOOPBACK), local->sin_addr.s_addr);
+  ASSERT_GT(meta->ifindex, 0);
+
+  ASSERT_EQ(TOS, meta->tos);
+
+  if (++recv_cb_called == NUM_SENDS) {
+    uv_close((uv_handle_t*) &server, close_cb);
+    uv_close((uv_handle_t*) &client, close_cb);
+  }
+}
+
+
+static void send_cb(uv_udp_send_t* req, int status) {
+  ASSERT_OK(status);
+}
+
+
+static int run_recv_meta(unsigned int flags) {
+#ifdef _WIN32
+  RETURN_SKIP("uv_udp_set_recv_meta is not supported on Windows");
+#else
+  struct sockaddr_in addr;
+  uv_os_fd_t fd;
+  uv_buf_t buf;
+  int namelen;
+  int tos;
+  int r;
+  int i;
+
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_udp_init_ex(uv_default_loop(), &server, AF_INET | flags));
+  ASSERT_OK(uv_udp_bind(&server, (const struct sockaddr*) &addr, 0));
+
+  r = uv_udp_set_recv_meta(&server, UV_UDP_META_TIMESTAMP |
+                                    UV_UDP_META_PKTINFO |
+                                    UV_UDP_META_TOS);
+  if (r == UV_ENOSYS)
+    RETURN_SKIP("uv_udp_set_recv_meta is not supported");
+  ASSERT_OK(r);
+  ASSERT_EQ(UV_EINVAL, uv_udp_set_recv_meta(&server, 8));
+
+  if (flags & UV_UDP_RECVMMSG) {
+    ASSERT_EQ(UV_EINVAL, uv_udp_set_recvmmsg(&server, 0));
+    ASSERT_EQ(UV_EINVAL, uv_udp_set_recvmmsg(&server, UV_UDP_RECVMMSG_MAX + 1));
+    ASSERT_OK(uv_udp_set_recvmmsg(&server, 4));
+  }
+
+  ASSERT_OK(uv_udp_recv_start(&server, alloc_cb, recv_cb));
+
+  ASSERT_OK(uv_udp_init(uv_default_loop(), &client));
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", 0, &client_addr));
+  ASSERT_OK(uv_udp_bind(&client, (const struct sockaddr*) &client_addr, 0));
+  namelen = sizeof(client_addr);
+  ASSERT_OK(uv_udp_getsockname(&client,
+                               (struct sockaddr*) &client_addr,
+                               &namelen));
+
+  ASSERT_OK(uv_fileno((uv_handle_t*) &client, &fd));
+  tos = TOS;
+  ASSERT_OK(setsockopt(fd, IPPROTO_IP, IP_TOS, &tos, sizeof(tos)));
+
+  buf = uv_buf_init("PING", 4);
+  for (i = 0; i < NUM_SENDS; i++)
+    ASSERT_OK(uv_udp_send(&send_reqs[i],
+                          &client,
+                          &buf,
+                          1,
+                          (const struct sockaddr*) &addr,
+                          send_cb));
+
+  ASSERT_OK(uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+
+  ASSERT_EQ(NUM_SENDS, recv_cb_called);
+  ASSERT_EQ(2, close_cb_called);
+
+  MAKE_VALGRIND_HAPPY(uv_default_loop());
+  return 0;
+#endif
+}
+
+
+TEST_IMPL(udp_recv_meta) {
+  return run_recv_meta(0);
+}
+
+
+TEST_IMPL(udp_recv_meta_mmsg) {
+  return run_recv_meta(UV_UDP_RECVMMSG);
+}
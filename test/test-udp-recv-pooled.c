@@ -0,0 +1,133 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <string.h>
+
+#define NUM_BUFS 4
+#define BUF_SIZE 64
+#define NUM_SENDS 6
+
+static uv_udp_t recver;
+static uv_udp_t sender;
+static uv_buf_t held[NUM_SENDS];
+static int received_datagrams;
+static int close_cb_called;
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void recv_cb(uv_udp_t* handle,
+                    ssize_t nread,
+                    const uv_buf_t* rcvbuf,
+                    const struct sockaddr* addr,
+                    unsigned flags) {
+  int i;
+
+  ASSERT_GE(nread, 0);
+  ASSERT_OK(flags);
+
+  if (nread == 0) {
+    /* Nothing to read, the buffer went back to the pool. */
+    ASSERT_NULL(addr);
+    ASSERT_NULL(rcvbuf->base);
+    return;
+  }
+
+  ASSERT_EQ(4, nread);
+  ASSERT_EQ(BUF_SIZE, rcvbuf->len);
+  ASSERT_NOT_NULL(addr);
+  ASSERT_MEM_EQ("PING", rcvbuf->base, nread);
+
+  /* Hang on to all of them, the pool runs out. */
+  held[received_datagrams++] = *rcvbuf;
+  if (received_datagrams < NUM_SENDS)
+    return;
+
+  for (i = 0; i < NUM_SENDS; i++)
+    uv_buf_release(handle->loop, &held[i]);
+
+  uv_close((uv_handle_t*) handle, close_cb);
+  uv_close((uv_handle_t*) &sender, close_cb);
+}
+
+
+static int run_recv_pooled(unsigned int flags) {
+  struct sockaddr_in addr;
+  uv_metrics_t metrics;
+  uv_loop_t* loop;
+  uv_buf_t buf;
+  int i;
+  int r;
+
+  loop = uv_default_loop();
+
+  ASSERT_OK(uv_udp_init_ex(loop, &recver, AF_UNSPEC | flags));
+
+  r = uv_udp_recv_start_pooled(&recver, recv_cb);
+  if (r == UV_ENOSYS)
+    RETURN_SKIP("loop buffer pool not supported");
+  ASSERT_EQ(r, UV_EINVAL);  /* No pool yet. */
+
+  ASSERT_OK(uv_loop_configure(loop, UV_LOOP_BUFFER_POOL, NUM_BUFS, BUF_SIZE));
+
+  ASSERT_OK(uv_ip4_addr("0.0.0.0", TEST_PORT, &addr));
+  ASSERT_OK(uv_udp_bind(&recver, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_udp_recv_start_pooled(&recver, recv_cb));
+  ASSERT_EQ(UV_EALREADY, uv_udp_recv_start_pooled(&recver, recv_cb));
+
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+  ASSERT_OK(uv_udp_init(loop, &sender));
+
+  buf = uv_buf_init("PING", 4);
+  for (i = 0; i < NUM_SENDS; i++)
+    ASSERT_EQ(4, uv_udp_try_send(&sender,
+                                 &buf,
+                                 1,
+                                 (const struct sockaddr*) &addr));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(2, close_cb_called);
+  ASSERT_EQ(NUM_SENDS, received_datagrams);
+
+  ASSERT_OK(uv_metrics_info(loop, &metrics));
+  ASSERT_GE(metrics.buf_pool_hits, NUM_BUFS);
+  ASSERT_GE(metrics.buf_pool_misses, NUM_SENDS - NUM_BUFS);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
+
+
+TEST_IMPL(udp_recv_pooled) {
+  return run_recv_pooled(0);
+}
+
+
+TEST_IMPL(udp_recv_pooled_mmsg) {
+  return run_recv_pooled(UV_UDP_RECVMMSG);
+}
@@ -0,0 +1,276 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_MSGS 100
+#define BAD_MSG 50
+#define BIG_SIZE (70 * 1024)
+
+static uv_udp_t server;
+static uv_udp_t client;
+static uv_udp_send_batch_t batch_req;
+static uv_udp_msg_t msgs[NUM_MSGS];
+static uv_buf_t bufs[NUM_MSGS];
+static unsigned int ids[NUM_MSGS];
+static char seen[NUM_MSGS];
+static char* big;
+static int received;
+static int batch_cb_called;
+static int close_cb_called;
+
+
+static void alloc_cb(uv_handle_t* handle,
+                     size_t suggested_size,
+                     uv_buf_t* buf) {
+  static char slab[64];
+  buf->base = slab;
+  buf->len = sizeof(slab);
+}
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void maybe_close(void) {
+  if (batch_cb_called == 1 && received == NUM_MSGS - 1) {
+    uv_close((uv_handle_t*) &server, close_cb);
+    uv_close((uv_handle_t*) &client, close_cb);
+  }
+}
+
+
+static void recv_cb(uv_udp_t* handle,
+                    ssize_t nread,
+                    const uv_buf_t* buf,
+                    const struct sockaddr* addr,
+                    unsigned flags) {
+  unsigned int id;
+
+  ASSERT_GE(nread, 0);
+  if (nread == 0)
+    return;
+
+  ASSERT_EQ(nread, sizeof(id));
+  memcpy(&id, buf->base, sizeof(id));
+  ASSERT_LT(id, NUM_MSGS);
+  ASSERT_NE(id, BAD_MSG);
+  ASSERT_OK(seen[id]);
+  seen[id] = 1;
+  received++;
+
+  maybe_close();
+}
+
+
+static void batch_cb(uv_udp_send_batch_t* req, int status) {
+  unsigned int i;
+
+  ASSERT_PTR_EQ(req, &batch_req);
+  ASSERT_PTR_EQ(req->handle, &client);
+  ASSERT_EQ(status, UV_EMSGSIZE);
+  ASSERT_EQ(0, client.send_queue_count);
+  ASSERT_EQ(0, client.send_queue_size);
+
+  /* Only the oversized datagram failed, the ones after it went out. */
+  for (i = 0; i < NUM_MSGS; i++) {
+    if (i == BAD_MSG)
+      ASSERT_EQ(msgs[i].status, UV_EMSGSIZE);
+    else
+      ASSERT_EQ(msgs[i].status, sizeof(ids[i]));
+  }
+
+  batch_cb_called++;
+  maybe_close();
+}
+
+
+TEST_IMPL(udp_send_batch) {
+#ifdef _WIN32
+  RETURN_SKIP("uv_udp_send_batch is not supported on Windows");
+#else
+  struct sockaddr_in addr;
+  uv_udp_msg_t bad;
+  unsigned int i;
+
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_udp_init(uv_default_loop(), &server));
+  ASSERT_OK(uv_udp_bind(&server, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_udp_recv_start(&server, alloc_cb, recv_cb));
+  ASSERT_OK(uv_udp_init(uv_default_loop(), &client));
+
+  big = malloc(BIG_SIZE);
+  ASSERT_NOT_NULL(big);
+  memset(big, 0, BIG_SIZE);
+
+  for (i = 0; i < NUM_MSGS; i++) {
+    ids[i] = i;
+    bufs[i] = uv_buf_init((char*) &ids[i], sizeof(ids[i]));
+    if (i == BAD_MSG)
+      bufs[i] = uv_buf_init(big, BIG_SIZE);
+    msgs[i].addr = (const struct sockaddr*) &addr;
+    msgs[i].bufs = &bufs[i];
+    msgs[i].nbufs = 1;
+  }
+
+  /* Rejected up front, nothing is sent. */
+  ASSERT_EQ(UV_EINVAL, uv_udp_send_batch(&batch_req, &client, msgs, 0, NULL));
+  bad = msgs[0];
+  bad.addr = NULL;
+  ASSERT_EQ(UV_EDESTADDRREQ,
+            uv_udp_send_batch(&batch_req, &client, &bad, 1, batch_cb));
+
+  ASSERT_OK(uv_udp_send_batch(&batch_req, &client, msgs, NUM_MSGS, batch_cb));
+  ASSERT_OK(batch_cb_called);
+  ASSERT_EQ(1, client.send_queue_count);
+
+  ASSERT_OK(uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+
+  ASSERT_EQ(1, batch_cb_called);
+  ASSERT_EQ(2, close_cb_called);
+  ASSERT_EQ(NUM_MSGS - 1, received);
+
+  free(big);
+
+  MAKE_VALGRIND_HAPPY(uv_default_loop());
+  return 0;
+#endif
+}
+
+
+/* Requests of uv_udp_send() and uv_udp_send_batch() go out, and their
+ * callbacks run, in the order in which they were queued. Pacing holds each
+ * batch back part way so that later requests pile up behind it.
+ */
+#define ORDER_DGRAMS 9
+
+static uv_udp_send_t order_sends[3];
+static uv_udp_send_batch_t order_batches[2];
+static uv_udp_msg_t order_msgs[ORDER_DGRAMS];
+static uv_buf_t order_bufs[ORDER_DGRAMS];
+static unsigned int order_ids[ORDER_DGRAMS];
+static unsigned int order_received;
+static unsigned int order_done[5];
+static unsigned int order_ndone;
+
+
+static void order_maybe_close(void) {
+  if (order_received == ORDER_DGRAMS &&
+      order_ndone == ARRAY_SIZE(order_done)) {
+    uv_close((uv_handle_t*) &server, close_cb);
+    uv_close((uv_handle_t*) &client, close_cb);
+  }
+}
+
+
+static void order_recv_cb(uv_udp_t* handle,
+                          ssize_t nread,
+                          const uv_buf_t* buf,
+                          const struct sockaddr* addr,
+                          unsigned flags) {
+  unsigned int id;
+
+  ASSERT_GE(nread, 0);
+  if (nread == 0)
+    return;
+
+  ASSERT_EQ(nread, sizeof(id));
+  memcpy(&id, buf->base, sizeof(id));
+  ASSERT_EQ(id, order_received);
+  order_received++;
+
+  order_maybe_close();
+}
+
+
+static void order_send_cb(uv_udp_send_t* req, int status) {
+  ASSERT_OK(status);
+  order_done[order_ndone++] = 100 + (unsigned int) (req - order_sends);
+  order_maybe_close();
+}
+
+
+static void order_batch_cb(uv_udp_send_batch_t* req, int status) {
+  ASSERT_OK(status);
+  order_done[order_ndone++] = 200 + (unsigned int) (req - order_batches);
+  order_maybe_close();
+}
+
+
+TEST_IMPL(udp_send_batch_order) {
+#ifdef _WIN32
+  RETURN_SKIP("uv_udp_send_batch is not supported on Windows");
+#else
+  static const unsigned int expected[] = { 100, 200, 101, 201, 102 };
+  const struct sockaddr* sa;
+  struct sockaddr_in addr;
+  unsigned int i;
+
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+  sa = (const struct sockaddr*) &addr;
+
+  ASSERT_OK(uv_udp_init(uv_default_loop(), &server));
+  ASSERT_OK(uv_udp_bind(&server, sa, 0));
+  ASSERT_OK(uv_udp_recv_start(&server, alloc_cb, order_recv_cb));
+  ASSERT_OK(uv_udp_init(uv_default_loop(), &client));
+
+  for (i = 0; i < ORDER_DGRAMS; i++) {
+    order_ids[i] = i;
+    order_bufs[i] = uv_buf_init((char*) &order_ids[i], sizeof(order_ids[i]));
+    order_msgs[i].addr = sa;
+    order_msgs[i].bufs = &order_bufs[i];
+    order_msgs[i].nbufs = 1;
+  }
+
+  /* One datagram per 10 ms. */
+  ASSERT_OK(uv_udp_set_pacing(&client, 400, sizeof(order_ids[0])));
+
+  /* Datagram 0, then 1-4 in a batch, 5, 6-7 in a batch and 8. */
+  ASSERT_OK(uv_udp_send(&order_sends[0], &client, &order_bufs[0], 1, sa,
+                        order_send_cb));
+  ASSERT_OK(uv_udp_send_batch(&order_batches[0], &client, &order_msgs[1], 4,
+                              order_batch_cb));
+  ASSERT_OK(uv_udp_send(&order_sends[1], &client, &order_bufs[5], 1, sa,
+                        order_send_cb));
+  ASSERT_OK(uv_udp_send_batch(&order_batches[1], &client, &order_msgs[6], 2,
+                              order_batch_cb));
+  ASSERT_OK(uv_udp_send(&order_sends[2], &client, &order_bufs[8], 1, sa,
+                        order_send_cb));
+
+  ASSERT_OK(uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+
+  ASSERT_EQ(ORDER_DGRAMS, order_received);
+  ASSERT_EQ(ARRAY_SIZE(expected), order_ndone);
+  for (i = 0; i < ARRAY_SIZE(expected); i++)
+    ASSERT_EQ(expected[i], order_done[i]);
+  ASSERT_EQ(2, close_cb_called);
+
+  MAKE_VALGRIND_HAPPY(uv_default_loop());
+  return 0;
+#endif
+}